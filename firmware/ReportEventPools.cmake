@@ -0,0 +1,31 @@
+# Prints the bytes taken by each event pool slab in app_tasks.c, run after the
+# firmware links. The slab sizes depend on the event structures, which the
+# preprocessor can't see, so they're read back from the symbol table.
+#
+#   cmake -DNM=<nm> -DELF=<firmware.elf> -P ReportEventPools.cmake
+
+execute_process(COMMAND ${NM} --print-size --radix=d ${ELF}
+                OUTPUT_VARIABLE SYMBOLS
+                RESULT_VARIABLE NM_RESULT)
+
+if(NOT NM_RESULT EQUAL 0)
+    message(WARNING "Couldn't read the event pool sizes from ${ELF}")
+    return()
+endif()
+
+string(REGEX MATCHALL "[0-9]+ [0-9]+ [A-Za-z] events[A-Z][A-Za-z]*" SLABS "${SYMBOLS}")
+
+set(TOTAL 0)
+
+foreach(SLAB ${SLABS})
+    string(REGEX REPLACE "^[0-9]+ ([0-9]+) [A-Za-z] (events[A-Za-z]+)$" "\\1" BYTES "${SLAB}")
+    string(REGEX REPLACE "^[0-9]+ ([0-9]+) [A-Za-z] (events[A-Za-z]+)$" "\\2" NAME "${SLAB}")
+
+    # nm pads the sizes with zeros
+    math(EXPR BYTES "${BYTES} + 0")
+    math(EXPR TOTAL "${TOTAL} + ${BYTES}")
+
+    message("  event pool ${NAME}: ${BYTES} bytes")
+endforeach()
+
+message("  event pools total: ${TOTAL} bytes")
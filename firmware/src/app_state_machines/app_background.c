@@ -5,7 +5,6 @@
 #include "app_background.h"
 #include "app_times.h"
 #include "global.h"
-#include "timer_ms.h"
 
 #include "button.h"
 #include "buzzer.h"
@@ -13,8 +12,11 @@
 #include "fan.h"
 #include "hal_adc.h"
 #include "hal_system_speed.h"
+#include "job_scheduler.h"
 #include "led_interpolator.h"
+#include "loop_monitor.h"
 #include "path_interpolator.h"
+#include "resonance_test.h"
 #include "sensors.h"
 #include "shutter_release.h"
 #include "status.h"
@@ -23,20 +25,34 @@
 
 /* -------------------------------------------------------------------------- */
 
-PRIVATE timer_ms_t button_timer = 0;
-PRIVATE timer_ms_t buzzer_timer = 0;
-PRIVATE timer_ms_t fan_timer    = 0;
-PRIVATE timer_ms_t adc_timer    = 0;
+PRIVATE void app_background_motion( void );
+PRIVATE void app_background_servos( void );
+PRIVATE void app_background_button( void );
+PRIVATE void app_background_sensors( void );
 
 /* -------------------------------------------------------------------------- */
 
 PUBLIC void
 app_background_init( void )
 {
-    timer_ms_start( &button_timer, BACKGROUND_RATE_BUTTON_MS );
-    timer_ms_start( &buzzer_timer, BACKGROUND_RATE_BUZZER_MS );
-    timer_ms_start( &fan_timer, FAN_EVALUATE_TIME );
-    timer_ms_start( &adc_timer, BACKGROUND_ADC_AVG_POLL_MS );    //refresh ADC readings
+    loop_monitor_init();
+    job_scheduler_init();
+
+    //process any running movements and allow servo drivers to process commands
+    job_scheduler_add( "path", app_background_motion, JOB_PRIORITY_MOTION, BACKGROUND_RATE_MOTION_MS, 200 );
+    job_scheduler_add( "servos", app_background_servos, JOB_PRIORITY_MOTION, BACKGROUND_RATE_MOTION_MS, 700 );
+
+    job_scheduler_add( "shutter", shutter_process, JOB_PRIORITY_OUTPUT, BACKGROUND_RATE_MOTION_MS, 20 );
+    job_scheduler_add( "led", led_interpolator_process, JOB_PRIORITY_OUTPUT, BACKGROUND_RATE_MOTION_MS, 100 );
+    job_scheduler_add( "buzzer", buzzer_process, JOB_PRIORITY_OUTPUT, BACKGROUND_RATE_BUZZER_MS, 20 );
+
+    //inbound UI packets are parsed every pass up to a byte budget, then any telemetry that's due goes out
+    job_scheduler_add( "ui", user_interface_handle_data, JOB_PRIORITY_COMMS, 0, 300 );
+
+    //less important background processes only run in the slack left over
+    job_scheduler_add( "button", app_background_button, JOB_PRIORITY_HOUSEKEEPING, BACKGROUND_RATE_BUTTON_MS, 50 );
+    job_scheduler_add( "fan", fan_process, JOB_PRIORITY_HOUSEKEEPING, FAN_EVALUATE_TIME, 50 );
+    job_scheduler_add( "sensors", app_background_sensors, JOB_PRIORITY_HOUSEKEEPING, BACKGROUND_ADC_AVG_POLL_MS, 300 );
 }
 
 /* -------------------------------------------------------------------------- */
@@ -44,54 +60,56 @@ app_background_init( void )
 PUBLIC void
 app_background( void )
 {
-    //rate limit less important background processes
-    if( timer_ms_is_expired( &button_timer ) )
-    {
-        // Need to turn the E-Stop light on to power the pullup for the E-STOP button
-        status_external_override( true );
-        button_process();
-        status_external_resume();
+    loop_monitor_tick();
+    job_scheduler_run();
+}
 
-        timer_ms_start( &button_timer, BACKGROUND_RATE_BUTTON_MS );
-    }
+/* -------------------------------------------------------------------------- */
 
-    if( timer_ms_is_expired( &buzzer_timer ) )
-    {
-        buzzer_process();
-        timer_ms_start( &buzzer_timer, BACKGROUND_RATE_BUZZER_MS );
-    }
+PRIVATE void
+app_background_motion( void )
+{
+    path_interpolator_process();
+    resonance_test_process();
+}
 
-    if( timer_ms_is_expired( &fan_timer ) )
-    {
-        fan_process();
-        timer_ms_start( &fan_timer, FAN_EVALUATE_TIME );
-    }
+/* -------------------------------------------------------------------------- */
 
-    if( timer_ms_is_expired( &adc_timer ) )
+PRIVATE void
+app_background_servos( void )
+{
+    for( ClearpathServoInstance_t servo = _CLEARPATH_1; servo < _NUMBER_CLEARPATH_SERVOS; servo++ )
     {
-        sensors_12v_regulator_C();
-        sensors_ambient_C();
-        sensors_expansion_C();
-        sensors_microcontroller_C();
-        sensors_input_V();
-
-        user_interface_set_cpu_load( hal_system_speed_get_load() );
-        user_interface_set_cpu_clock( hal_system_speed_get_speed() );    // todo only update this value if it changes
-        user_interface_update_task_statistics();
-
-        timer_ms_start( &adc_timer, BACKGROUND_ADC_AVG_POLL_MS );
+        servo_process( servo );
     }
+}
 
-    shutter_process();
-    led_interpolator_process();
+/* -------------------------------------------------------------------------- */
 
-    //process any running movements and allow servo drivers to process commands
-    path_interpolator_process();
+PRIVATE void
+app_background_button( void )
+{
+    // Need to turn the E-Stop light on to power the pullup for the E-STOP button
+    status_external_override( true );
+    button_process();
+    status_external_resume();
+}
 
-    for( ClearpathServoInstance_t servo = _CLEARPATH_1; servo < _NUMBER_CLEARPATH_SERVOS; servo++ )
-    {
-        servo_process( servo );
-    }
+/* -------------------------------------------------------------------------- */
+
+PRIVATE void
+app_background_sensors( void )
+{
+    //refresh ADC readings
+    sensors_12v_regulator_C();
+    sensors_ambient_C();
+    sensors_expansion_C();
+    sensors_microcontroller_C();
+    sensors_input_V();
+
+    user_interface_set_cpu_load( hal_system_speed_get_load() );
+    user_interface_set_cpu_clock( hal_system_speed_get_speed() );    // todo only update this value if it changes
+    user_interface_update_task_statistics();
 }
 
 /* ----- End ---------------------------------------------------------------- */
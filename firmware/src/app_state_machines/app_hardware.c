@@ -6,6 +6,7 @@
 #include "hal_flashmem.h"
 #include "hal_gpio.h"
 #include "hal_hard_ic.h"
+#include "hal_isr_profile.h"
 #include "hal_reset.h"
 #include "hal_system_speed.h"
 #include "hal_systick.h"
@@ -34,6 +35,7 @@ app_hardware_init( void )
 
     // Initialise the CPU manager DWT
     hal_system_speed_init();
+    hal_isr_profile_init();
 
     // Continue basic I/O setup
     status_green( true );
@@ -33,6 +33,7 @@ enum AppSignals
     MODE_DEMO,
     MODE_EVENT,
     MODE_MANUAL,
+    MODE_RESONANCE,
 
 #ifdef EXPANSION_SERVO
     TRACKED_EXTERNAL_SERVO_REQUEST,
@@ -59,7 +60,7 @@ enum AppSignals
     MOTION_QUEUE_CLEAR,    // empty out pending movements
 
     PATHING_STARTED,     // started executing a move
-    PATHING_COMPLETE,    // finished moving along a provided profile path
+    PATHING_COMPLETE,    // finished moving along a provided profile path, the shaped setpoint may still be settling
 
     ANIMATION_COMPLETE,    // finished drawing out the led animated colour ramp
 
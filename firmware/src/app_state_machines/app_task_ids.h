@@ -39,6 +39,22 @@ enum AppTaskID
     TASK_MAX,    // Last entry used to define the size of task table
 };
 
+/* -------------------------------------------------------------------------- */
+
+/** The enum AppEventPoolID lists the dynamic event pools, in ascending order
+ *  of event size. Events are allocated from the smallest pool they fit in.
+ */
+
+enum AppEventPoolID
+{
+    POOL_SMALL = 0,    // Button and other small notifications
+    POOL_MEDIUM,       // Manual control requests
+    POOL_LIGHTING,     // Queued LED animations
+    POOL_MOTION,       // Queued movements
+
+    POOL_MAX,    // Last entry used to define the size of the pool table
+};
+
 /* ----- End ---------------------------------------------------------------- */
 
 #ifdef __cplusplus
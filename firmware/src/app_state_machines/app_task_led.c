@@ -36,9 +36,9 @@ PRIVATE void AppTaskLed_commit_queued_fade( AppTaskLed *me );
 PUBLIC StateTask *
 appTaskLedCreate( AppTaskLed *  me,
                   StateEvent *  eventQueueData[],
-                  const uint8_t eventQueueSize,
+                  const uint16_t eventQueueSize,
                   StateEvent *  lightingQueue[],
-                  const uint8_t lightingQueueSize )
+                  const uint16_t lightingQueueSize )
 {
     // Clear all task data
     memset( me, 0, sizeof( AppTaskLed ) );
@@ -315,7 +315,7 @@ PRIVATE void AppTaskLed_add_event_to_queue( AppTaskLed *me, const StateEvent *e
     LightingPlannerEvent *lpe = (LightingPlannerEvent *)e;
 
     // Add the LED animation request to the queue if we have room
-    uint8_t queue_usage = eventQueueUsed( &me->super.requestQueue );
+    uint16_t queue_usage = eventQueueUsed( &me->super.requestQueue );
     if( queue_usage <= LED_QUEUE_DEPTH_MAX )
     {
         if( lpe->animation.duration )
@@ -38,9 +38,9 @@ struct AppTaskLed
 PUBLIC StateTask *
 appTaskLedCreate( AppTaskLed *  me,
                   StateEvent *  eventQueueData[],
-                  const uint8_t eventQueueSize,
+                  const uint16_t eventQueueSize,
                   StateEvent *  lightingQueue[],
-                  const uint8_t lightingQueueSize );
+                  const uint16_t lightingQueueSize );
 
 /* ----- End ---------------------------------------------------------------- */
 
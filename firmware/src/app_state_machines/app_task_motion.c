@@ -35,6 +35,12 @@ PRIVATE STATE AppTaskMotion_recovery( AppTaskMotion *me, const StateEvent *e );
 PRIVATE void AppTaskMotion_commit_queued_move( AppTaskMotion *me );
 PRIVATE void AppTaskMotion_clear_queue( AppTaskMotion *me );
 PRIVATE void AppTaskMotion_add_event_to_queue( AppTaskMotion *me, const StateEvent *e );
+PRIVATE bool AppTaskMotion_resolve_move( AppTaskMotion *me, Movement_t *move, Movement_t *resolved );
+PRIVATE void AppTaskMotion_update_tail( AppTaskMotion *me, Movement_t *resolved, bool start_known );
+
+#ifdef EXPANSION_SERVO
+PRIVATE bool AppTaskMotion_rotary_is_feasible( AppTaskMotion *me, Movement_t *move );
+#endif
 
 typedef enum
 {
@@ -51,9 +57,9 @@ typedef enum
 PUBLIC StateTask *
 appTaskMotionCreate( AppTaskMotion *me,
                      StateEvent *   eventQueueData[],
-                     const uint8_t  eventQueueSize,
+                     const uint16_t eventQueueSize,
                      StateEvent *   movementQueue[],
-                     const uint8_t  movementQueueSize )
+                     const uint16_t movementQueueSize )
 {
     // Clear all task data
     memset( me, 0, sizeof( AppTaskMotion ) );
@@ -169,6 +175,11 @@ PRIVATE STATE AppTaskMotion_home( AppTaskMotion *me, const StateEvent *e )
             {
                 eventPublish( EVENT_NEW( StateEvent, MOTION_HOMED ) );
                 path_interpolator_set_home();
+                me->tail_position = path_interpolator_get_global_position();
+                me->tail_known    = true;
+#ifdef EXPANSION_SERVO
+                me->rotary_tail_angle = path_interpolator_get_expansion_angle();
+#endif
                 STATE_TRAN( AppTaskMotion_inactive );
             }
             else
@@ -467,6 +478,19 @@ PRIVATE void AppTaskMotion_clear_queue( AppTaskMotion *me )
         next = eventQueueGet( &me->super.requestQueue );
     }
 
+    // Nothing is queued, so the next move starts wherever the effector stops. Moves already
+    // handed to the path interpolator keep running, so that isn't known until they finish.
+    me->tail_known = path_interpolator_is_idle();
+    if( me->tail_known )
+    {
+        me->tail_position = path_interpolator_get_global_position();
+    }
+
+#ifdef EXPANSION_SERVO
+    // Nothing is queued, so the next rotary move starts from wherever the axis was last commanded
+    me->rotary_tail_angle = path_interpolator_get_expansion_angle();
+#endif
+
     //update UI with queue content count
     user_interface_set_motion_queue_depth( eventQueueUsed( &me->super.requestQueue ) );
 }
@@ -481,18 +505,26 @@ PRIVATE void AppTaskMotion_add_event_to_queue( AppTaskMotion *me, const StateEve
     ASSERT( mpe->move.duration != 0 );
 
     // Add the movement request to the queue if we have room
-    uint8_t queue_usage = eventQueueUsed( &me->super.requestQueue );
+    uint16_t queue_usage = eventQueueUsed( &me->super.requestQueue );
     if( queue_usage <= MOVEMENT_QUEUE_DEPTH_MAX )
     {
-        int32_t speed = cartesian_move_speed( &mpe->move );
+        Movement_t resolved    = { 0 };
+        bool       start_known = AppTaskMotion_resolve_move( me, &mpe->move, &resolved );
 
-        if( speed < EFFECTOR_SPEED_LIMIT )
+        if( !kinematics_move_is_feasible( &resolved, start_known ) )
         {
-            eventQueuePutFIFO( &me->super.requestQueue, (StateEvent *)e );
+            user_interface_report_error( "Requested illegal speed" );
+        }
+#ifdef EXPANSION_SERVO
+        else if( !AppTaskMotion_rotary_is_feasible( me, &mpe->move ) )
+        {
+            user_interface_report_error( "Requested illegal rotary speed" );
         }
+#endif
         else
         {
-            user_interface_report_error( "Requested illegal speed" );
+            eventQueuePutFIFO( &me->super.requestQueue, (StateEvent *)e );
+            AppTaskMotion_update_tail( me, &resolved, start_known );
         }
     }
     else
@@ -508,4 +540,101 @@ PRIVATE void AppTaskMotion_add_event_to_queue( AppTaskMotion *me, const StateEve
     user_interface_set_motion_queue_depth( eventQueueUsed( &me->super.requestQueue ) );
 }
 
+/* -------------------------------------------------------------------------- */
+
+// Place the move where it will run, the same way the path interpolator does when it starts it.
+// Returns false when the move depends on where the queue ends, and that isn't known.
+PRIVATE bool AppTaskMotion_resolve_move( AppTaskMotion *me, Movement_t *move, Movement_t *resolved )
+{
+    memcpy( resolved, move, sizeof( Movement_t ) );
+
+    // Once everything has run, the queue ends wherever the effector stopped
+    if( !me->tail_known && !eventQueueUsed( &me->super.requestQueue ) && path_interpolator_is_idle() )
+    {
+        me->tail_position = path_interpolator_get_global_position();
+        me->tail_known    = true;
+    }
+
+    // An unknown start leaves relative moves the right shape, just not in the right place
+    CartesianPoint_t start = { 0, 0, 0 };
+    if( me->tail_known )
+    {
+        start = me->tail_position;
+    }
+
+    if( resolved->ref == _POS_RELATIVE )
+    {
+        for( uint8_t i = 0; i < resolved->num_pts; i++ )
+        {
+            resolved->points[i].x += start.x;
+            resolved->points[i].y += start.y;
+            resolved->points[i].z += start.z;
+        }
+    }
+
+    if( resolved->type == _POINT_TRANSIT )
+    {
+        if( resolved->num_pts == 1 )
+        {
+            resolved->points[1] = resolved->points[0];
+            resolved->num_pts   = 2;
+        }
+
+        resolved->points[0] = start;
+    }
+
+    return me->tail_known || ( resolved->ref == _POS_ABSOLUTE && resolved->type != _POINT_TRANSIT );
+}
+
+/* -------------------------------------------------------------------------- */
+
+// Track where the queue will leave the effector, so later moves can be checked from there
+PRIVATE void AppTaskMotion_update_tail( AppTaskMotion *me, Movement_t *resolved, bool start_known )
+{
+    // Transits and absolute moves end in the same place wherever they start
+    if( start_known || resolved->ref == _POS_ABSOLUTE )
+    {
+        cartesian_point_on_movement( resolved, 1.0f, &me->tail_position );
+        me->tail_known = true;
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+
+#ifdef EXPANSION_SERVO
+
+// Check the expansion axis can keep up with the path, and track where the queue will leave it
+PRIVATE bool AppTaskMotion_rotary_is_feasible( AppTaskMotion *me, Movement_t *move )
+{
+    if( !move->rotary_enabled )
+    {
+        return true;
+    }
+
+    // Resolve the start and end angles the same way the path interpolator will when it runs the move
+    float start_angle = move->rotary[0];
+    float end_angle   = move->rotary[1];
+
+    if( move->ref == _POS_RELATIVE )
+    {
+        start_angle += me->rotary_tail_angle;
+        end_angle += me->rotary_tail_angle;
+    }
+
+    if( move->type == _POINT_TRANSIT )
+    {
+        start_angle = me->rotary_tail_angle;
+    }
+
+    if( rotary_move_speed( start_angle, end_angle, move->duration ) >= EXPANSION_SPEED_LIMIT )
+    {
+        return false;
+    }
+
+    me->rotary_tail_angle = end_angle;
+    return true;
+}
+
+#endif
+
 /* ----- End ---------------------------------------------------------------- */
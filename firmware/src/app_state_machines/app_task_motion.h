@@ -13,6 +13,7 @@ extern "C" {
 /* ----- Local Includes ----------------------------------------------------- */
 #include "event_timer.h"
 #include "global.h"
+#include "motion_types.h"
 #include "state_task.h"
 
 /* ----- State Task Control Block ------------------------------------------- */
@@ -32,6 +33,13 @@ struct AppTaskMotion
     // ~~~ Task Variables ~~~
     uint8_t counter;
     uint8_t retries;
+
+    CartesianPoint_t tail_position;    // effector position at the end of the last queued move
+    bool             tail_known;       // false while a cleared queue leaves moves running
+
+#ifdef EXPANSION_SERVO
+    float rotary_tail_angle;    // expansion axis angle at the end of the last queued move
+#endif
 };
 
 /* ----- Public Functions --------------------------------------------------- */
@@ -39,9 +47,9 @@ struct AppTaskMotion
 PUBLIC StateTask *
 appTaskMotionCreate( AppTaskMotion *me,
                      StateEvent *   eventQueueData[],
-                     const uint8_t  eventQueueSize,
+                     const uint16_t eventQueueSize,
                      StateEvent *   movementQueue[],
-                     const uint8_t  movementQueueSize );
+                     const uint16_t movementQueueSize );
 
 /* ----- End ---------------------------------------------------------------- */
 
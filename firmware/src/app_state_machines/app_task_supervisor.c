@@ -18,7 +18,9 @@
 #include "buzzer.h"
 #include "user_interface.h"
 #include "demonstration.h"
+#include "input_shaper.h"
 #include "path_interpolator.h"
+#include "resonance_test.h"
 #include "sensors.h"
 #include "shutter_release.h"
 #include "status.h"
@@ -33,7 +35,7 @@ DEFINE_THIS_FILE; /* Used for ASSERT checks to define __FILE__ only once */
 PUBLIC StateTask *
 appTaskSupervisorCreate( AppTaskSupervisor *me,
                          StateEvent *       eventQueueData[],
-                         const uint8_t      eventQueueSize )
+                         const uint16_t     eventQueueSize )
 {
     // Clear all task data
     memset( me, 0, sizeof( AppTaskSupervisor ) );
@@ -67,7 +69,11 @@ PRIVATE void AppTaskSupervisor_initial( AppTaskSupervisor *me,
 {
     button_init( BUTTON_0, AppTaskSupervisorButtonEvent );
     button_init( BUTTON_1, AppTaskSupervisorButtonEvent );
+#ifndef EXTERNAL_UI_LINK
     button_init( BUTTON_EXTERNAL, AppTaskSupervisorButtonEvent );
+#endif
+
+    resonance_test_init();
 
     // Detect user activities
     eventSubscribe( (StateTask *)me, BUTTON_NORMAL_SIGNAL );
@@ -93,6 +99,7 @@ PRIVATE void AppTaskSupervisor_initial( AppTaskSupervisor *me,
     eventSubscribe( (StateTask *)me, MODE_DEMO );
     eventSubscribe( (StateTask *)me, MODE_EVENT );
     eventSubscribe( (StateTask *)me, MODE_MANUAL );
+    eventSubscribe( (StateTask *)me, MODE_RESONANCE );
 
     eventSubscribe( (StateTask *)me, START_QUEUE_SYNC );
 
@@ -202,6 +209,11 @@ PRIVATE STATE AppTaskSupervisor_disarmed( AppTaskSupervisor *me,
             user_interface_set_control_mode( me->selected_control_mode );
             return 0;
 
+        case MODE_RESONANCE:
+            me->selected_control_mode = CONTROL_RESONANCE;
+            user_interface_set_control_mode( me->selected_control_mode );
+            return 0;
+
         case STATE_EXIT_SIGNAL:
             user_interface_set_control_mode( me->selected_control_mode );
             return 0;
@@ -267,6 +279,11 @@ PRIVATE STATE AppTaskSupervisor_arm_start( AppTaskSupervisor *me,
             user_interface_set_control_mode( me->selected_control_mode );
             return 0;
 
+        case MODE_RESONANCE:
+            me->selected_control_mode = CONTROL_RESONANCE;
+            user_interface_set_control_mode( me->selected_control_mode );
+            return 0;
+
         case MOTION_DISABLED:
             STATE_TRAN( AppTaskSupervisor_disarmed );
             return 0;
@@ -356,6 +373,10 @@ PRIVATE STATE AppTaskSupervisor_arm_success( AppTaskSupervisor *me,
                     STATE_TRAN( AppTaskSupervisor_armed_manual );
                     break;
 
+                case CONTROL_RESONANCE:
+                    STATE_TRAN( AppTaskSupervisor_armed_resonance );
+                    break;
+
                 default:
                     STATE_TRAN( AppTaskSupervisor_disarm_graceful );
                     break;
@@ -433,21 +454,10 @@ PRIVATE STATE AppTaskSupervisor_armed_event( AppTaskSupervisor *me,
             return 0;
         }
 
-        case MOVEMENT_REQUEST: {
-            //catch the inbound movement event
-            MotionPlannerEvent *mpe = (MotionPlannerEvent *)e;
-
-            // Create event to pass event for motion handler
-            MotionPlannerEvent *motion_request = EVENT_NEW( MotionPlannerEvent, MOTION_QUEUE_ADD );
-
-            if( motion_request )
-            {
-                // copy the movement into the new event for the motion handler.
-                memcpy( &motion_request->move, &mpe->move, sizeof( Movement_t ) );
-                eventPublish( (StateEvent *)motion_request );
-            }
+        case MOVEMENT_REQUEST:
+            // Pass the inbound movement to the motion handler by reference
+            eventForward( e, MOTION_QUEUE_ADD );
             return 0;
-        }
 
         case CAMERA_CAPTURE: {
             CameraShutterEvent *trigger = (CameraShutterEvent *)e;
@@ -489,6 +499,11 @@ PRIVATE STATE AppTaskSupervisor_armed_event( AppTaskSupervisor *me,
             STATE_TRAN( AppTaskSupervisor_armed_change_mode );
             return 0;
 
+        case MODE_RESONANCE:
+            me->selected_control_mode = CONTROL_RESONANCE;
+            STATE_TRAN( AppTaskSupervisor_armed_change_mode );
+            return 0;
+
         case MOTION_DISABLED:
             STATE_TRAN( AppTaskSupervisor_disarmed );
             return 0;
@@ -524,24 +539,13 @@ PRIVATE STATE AppTaskSupervisor_armed_manual( AppTaskSupervisor *me,
             AppTaskSupervisorPublishRehomeEvent();
             return 0;
 
-        case MOVEMENT_REQUEST: {
-            //catch the inbound movement event
-            MotionPlannerEvent *mpe = (MotionPlannerEvent *)e;
-
-            // Create event to pass event for motion handler
-            MotionPlannerEvent *motion_request = EVENT_NEW( MotionPlannerEvent, MOTION_QUEUE_ADD );
-
-            if( motion_request )
+        case MOVEMENT_REQUEST:
+            // Pass the inbound movement to the motion handler by reference
+            if( eventForward( e, MOTION_QUEUE_ADD ) )
             {
-                // copy the movement into the new event for the motion handler.
-                memcpy( &motion_request->move, &mpe->move, sizeof( Movement_t ) );
-                eventPublish( (StateEvent *)motion_request );
-
                 eventPublish( EVENT_NEW( StateEvent, MOTION_QUEUE_START ) );
             }
-
             return 0;
-        }
 
         case MODE_TRACK:
             me->selected_control_mode = CONTROL_TRACK;
@@ -558,6 +562,11 @@ PRIVATE STATE AppTaskSupervisor_armed_manual( AppTaskSupervisor *me,
             STATE_TRAN( AppTaskSupervisor_armed_change_mode );
             return 0;
 
+        case MODE_RESONANCE:
+            me->selected_control_mode = CONTROL_RESONANCE;
+            STATE_TRAN( AppTaskSupervisor_armed_change_mode );
+            return 0;
+
         case MOTION_DISABLED:
             STATE_TRAN( AppTaskSupervisor_disarmed );
             return 0;
@@ -614,7 +623,7 @@ PRIVATE STATE AppTaskSupervisor_armed_track( AppTaskSupervisor *me,
                     }
 
                     // Create the line which will get us to the target
-                    MotionPlannerEvent *motev = EVENT_NEW( MotionPlannerEvent, MOTION_QUEUE_ADD );
+                    MotionPlannerEvent *motev = AppTaskSupervisorNewMoveEvent();
                     motev->move.type          = _LINE;
                     motev->move.ref           = _POS_ABSOLUTE;
                     motev->move.duration      = required_duration;
@@ -672,6 +681,9 @@ PRIVATE STATE AppTaskSupervisor_armed_track( AppTaskSupervisor *me,
 
                 // Set the target angle of the expansion clearpath servo
                 servo_set_target_angle_raw( _CLEARPATH_4, target_deg );
+
+                // Queued rotary moves referenced to the current angle start from here
+                path_interpolator_set_expansion_angle( target_deg );
             }
         }
             return 0;
@@ -705,6 +717,11 @@ PRIVATE STATE AppTaskSupervisor_armed_track( AppTaskSupervisor *me,
             STATE_TRAN( AppTaskSupervisor_armed_change_mode );
             return 0;
 
+        case MODE_RESONANCE:
+            me->selected_control_mode = CONTROL_RESONANCE;
+            STATE_TRAN( AppTaskSupervisor_armed_change_mode );
+            return 0;
+
         case MOTION_DISABLED:
             STATE_TRAN( AppTaskSupervisor_disarmed );
             return 0;
@@ -769,6 +786,11 @@ PRIVATE STATE AppTaskSupervisor_armed_demo( AppTaskSupervisor *me,
             STATE_TRAN( AppTaskSupervisor_armed_change_mode );
             return 0;
 
+        case MODE_RESONANCE:
+            me->selected_control_mode = CONTROL_RESONANCE;
+            STATE_TRAN( AppTaskSupervisor_armed_change_mode );
+            return 0;
+
         case MOTION_DISABLED:
             STATE_TRAN( AppTaskSupervisor_disarmed );
             return 0;
@@ -780,6 +802,116 @@ PRIVATE STATE AppTaskSupervisor_armed_demo( AppTaskSupervisor *me,
     return (STATE)AppTaskSupervisor_main;
 }
 
+PRIVATE STATE AppTaskSupervisor_armed_resonance( AppTaskSupervisor *me,
+                                                 const StateEvent * e )
+{
+    switch( e->signal )
+    {
+        case STATE_ENTRY_SIGNAL: {
+            user_interface_set_main_state( SUPERVISOR_ARMED );
+            user_interface_set_control_mode( CONTROL_RESONANCE );
+
+            me->resonance_axis = RESONANCE_AXIS_X;
+
+            // Move to the middle of the working volume so the arms have room to oscillate
+            MotionPlannerEvent *motev = AppTaskSupervisorNewMoveEvent();
+            motev->move.type          = _POINT_TRANSIT;
+            motev->move.ref           = _POS_ABSOLUTE;
+            motev->move.identifier    = 0;
+            motev->move.duration      = RESONANCE_CENTRE_MOVE_MS;
+            motev->move.num_pts       = 1;
+            motev->move.points[0].x   = 0;
+            motev->move.points[0].y   = 0;
+            motev->move.points[0].z   = MM_TO_MICRONS( RESONANCE_CENTRE_Z_MM );
+
+            eventPublish( (StateEvent *)motev );
+            eventPublish( EVENT_NEW( StateEvent, MOTION_QUEUE_START ) );
+
+            eventTimerStartEvery( &me->timer1,
+                                  (StateTask *)me,
+                                  (StateEvent *)&stateEventReserved[STATE_TIMEOUT1_SIGNAL],
+                                  MS_TO_TICKS( RESONANCE_POLL_MS ) );
+            return 0;
+        }
+
+        case STATE_TIMEOUT1_SIGNAL: {
+            if( resonance_test_is_running() )
+            {
+                return 0;
+            }
+
+            if( me->resonance_axis < RESONANCE_AXIS_COUNT )
+            {
+                CartesianPoint_t position = path_interpolator_get_global_position();
+
+                // The sweep drives the servos directly, so wait until the planner has finished with them
+                bool at_centre = IS_IN_DEADBAND( position.x, 0, 10 )
+                                 && IS_IN_DEADBAND( position.y, 0, 10 )
+                                 && IS_IN_DEADBAND( position.z, (int32_t)MM_TO_MICRONS( RESONANCE_CENTRE_Z_MM ), 10 );
+
+                if( at_centre && path_interpolator_get_move_done() && input_shaper_is_settled() )
+                {
+                    resonance_test_start( me->resonance_axis, &position );
+                    me->resonance_axis++;
+                }
+            }
+            else
+            {
+                // All axes have been swept, results are with the UI so head home
+                eventTimerStopIfActive( &me->timer1 );
+                AppTaskSupervisorPublishRehomeEvent();
+                buzzer_sound( BUZZER_MODE_CHANGED_NUM, BUZZER_MODE_CHANGED_TONE, BUZZER_MODE_CHANGED_DURATION );
+            }
+
+            return 0;
+        }
+
+        case MECHANISM_STOP:
+            STATE_TRAN( AppTaskSupervisor_disarm_graceful );
+            return 0;
+
+        case MOTION_ERROR:
+            STATE_TRAN( AppTaskSupervisor_arm_error );
+            return 0;
+
+        case MODE_TRACK:
+            me->selected_control_mode = CONTROL_TRACK;
+            STATE_TRAN( AppTaskSupervisor_armed_change_mode );
+            return 0;
+
+        case MODE_MANUAL:
+            me->selected_control_mode = CONTROL_MANUAL;
+            STATE_TRAN( AppTaskSupervisor_armed_change_mode );
+            return 0;
+
+        case MODE_EVENT:
+            me->selected_control_mode = CONTROL_EVENT;
+            STATE_TRAN( AppTaskSupervisor_armed_change_mode );
+            return 0;
+
+        case MODE_DEMO:
+            me->selected_control_mode = CONTROL_DEMO;
+            STATE_TRAN( AppTaskSupervisor_armed_change_mode );
+            return 0;
+
+        case MODE_RESONANCE:
+            // Re-requesting the mode runs the sweep again once the effector is back home
+            me->selected_control_mode = CONTROL_RESONANCE;
+            STATE_TRAN( AppTaskSupervisor_armed_change_mode );
+            return 0;
+
+        case MOTION_DISABLED:
+            STATE_TRAN( AppTaskSupervisor_disarmed );
+            return 0;
+
+        case STATE_EXIT_SIGNAL:
+            eventTimerStopIfActive( &me->timer1 );
+            resonance_test_stop();
+            return 0;
+    }
+    return (STATE)AppTaskSupervisor_main;
+}
+
 PRIVATE STATE AppTaskSupervisor_armed_change_mode( AppTaskSupervisor *me,
                                                    const StateEvent * e )
 {
@@ -829,6 +961,10 @@ PRIVATE STATE AppTaskSupervisor_armed_change_mode( AppTaskSupervisor *me,
                         STATE_TRAN( AppTaskSupervisor_armed_manual );
                         break;
 
+                    case CONTROL_RESONANCE:
+                        STATE_TRAN( AppTaskSupervisor_armed_resonance );
+                        break;
+
                     default:
                         STATE_TRAN( AppTaskSupervisor_disarm_graceful );
                         break;
@@ -837,7 +973,7 @@ PRIVATE STATE AppTaskSupervisor_armed_change_mode( AppTaskSupervisor *me,
             else
             {
                 //request a move to 0,0,0
-                MotionPlannerEvent *motev = EVENT_NEW( MotionPlannerEvent, MOTION_QUEUE_ADD );
+                MotionPlannerEvent *motev = AppTaskSupervisorNewMoveEvent();
                 motev->move.type          = _POINT_TRANSIT;
                 motev->move.ref           = _POS_ABSOLUTE;
                 motev->move.identifier    = 0;
@@ -880,6 +1016,10 @@ PRIVATE STATE AppTaskSupervisor_armed_change_mode( AppTaskSupervisor *me,
                         STATE_TRAN( AppTaskSupervisor_armed_manual );
                         break;
 
+                    case CONTROL_RESONANCE:
+                        STATE_TRAN( AppTaskSupervisor_armed_resonance );
+                        break;
+
                     default:
                         STATE_TRAN( AppTaskSupervisor_disarm_graceful );
                         break;
@@ -891,7 +1031,7 @@ PRIVATE STATE AppTaskSupervisor_armed_change_mode( AppTaskSupervisor *me,
                 if( path_interpolator_get_move_done() )
                 {
                     //request a move to 0,0,0
-                    MotionPlannerEvent *motev = EVENT_NEW( MotionPlannerEvent, MOTION_QUEUE_ADD );
+                    MotionPlannerEvent *motev = AppTaskSupervisorNewMoveEvent();
                     motev->move.type          = _POINT_TRANSIT;
                     motev->move.ref           = _POS_ABSOLUTE;
                     motev->move.identifier    = 0;
@@ -924,6 +1064,10 @@ PRIVATE STATE AppTaskSupervisor_armed_change_mode( AppTaskSupervisor *me,
             me->selected_control_mode = CONTROL_DEMO;
             return 0;
 
+        case MODE_RESONANCE:
+            me->selected_control_mode = CONTROL_RESONANCE;
+            return 0;
+
         case MECHANISM_STOP:
             STATE_TRAN( AppTaskSupervisor_disarm_graceful );
             return 0;
@@ -979,7 +1123,7 @@ PRIVATE STATE AppTaskSupervisor_disarm_graceful( AppTaskSupervisor *me,
 
         case STATE_STEP1_SIGNAL: {
             //request a move to 0,0,0
-            MotionPlannerEvent *motev = EVENT_NEW( MotionPlannerEvent, MOTION_QUEUE_ADD );
+            MotionPlannerEvent *motev = AppTaskSupervisorNewMoveEvent();
 
             //transit to starting position
             motev->move.type       = _POINT_TRANSIT;
@@ -1035,13 +1179,32 @@ PRIVATE STATE AppTaskSupervisor_disarm_graceful( AppTaskSupervisor *me,
 
 /* -------------------------------------------------------------------------- */
 
+// Pool events aren't cleared, so start each move from nothing rather than whatever the
+// last user of the block left behind. The expansion axis stays where it is.
+PRIVATE MotionPlannerEvent *AppTaskSupervisorNewMoveEvent( void )
+{
+    MotionPlannerEvent *motev = EVENT_NEW( MotionPlannerEvent, MOTION_QUEUE_ADD );
+
+    if( motev )
+    {
+        memset( &motev->move, 0, sizeof( Movement_t ) );
+#ifdef EXPANSION_SERVO
+        motev->move.rotary_enabled = false;
+#endif
+    }
+
+    return motev;
+}
+
+/* -------------------------------------------------------------------------- */
+
 // Tell the motion handler to clear queue, queue a new move to home, and start the move
 PRIVATE void AppTaskSupervisorPublishRehomeEvent( void )
 {
     eventPublish( EVENT_NEW( StateEvent, MOTION_QUEUE_CLEAR ) );
 
     //request a move to 0,0,0
-    MotionPlannerEvent *motev = EVENT_NEW( MotionPlannerEvent, MOTION_QUEUE_ADD );
+    MotionPlannerEvent *motev = AppTaskSupervisorNewMoveEvent();
     motev->move.type          = _POINT_TRANSIT;
     motev->move.ref           = _POS_ABSOLUTE;
     motev->move.duration      = 1500;
@@ -43,6 +43,7 @@ struct AppTaskSupervisor
 
     // ~~~ Task Variables ~~~
     uint8_t selected_control_mode;    // mode of end effector control
+    uint8_t resonance_axis;           // next axis to sweep during resonance identification
 };
 
 /* ----- Public Functions --------------------------------------------------- */
@@ -59,7 +60,7 @@ struct AppTaskSupervisor
 PUBLIC StateTask *
 appTaskSupervisorCreate( AppTaskSupervisor *me,
                          StateEvent *       eventQueueData[],
-                         const uint8_t      eventQueueSize );
+                         const uint16_t     eventQueueSize );
 
 /* ----- End ---------------------------------------------------------------- */
 
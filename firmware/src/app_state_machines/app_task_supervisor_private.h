@@ -29,10 +29,13 @@ PRIVATE STATE AppTaskSupervisor_armed_track( AppTaskSupervisor *me, const StateE
 
 PRIVATE STATE AppTaskSupervisor_armed_demo( AppTaskSupervisor *me, const StateEvent *e );
 
+PRIVATE STATE AppTaskSupervisor_armed_resonance( AppTaskSupervisor *me, const StateEvent *e );
+
 PRIVATE STATE AppTaskSupervisor_armed_change_mode( AppTaskSupervisor *me, const StateEvent *e );
 
 PRIVATE STATE AppTaskSupervisor_disarm_graceful( AppTaskSupervisor *me, const StateEvent *e );
 
+PRIVATE MotionPlannerEvent *AppTaskSupervisorNewMoveEvent( void );
 PRIVATE void AppTaskSupervisorPublishRehomeEvent( void );
 PRIVATE void AppTaskSupervisorButtonEvent( ButtonId_t button, ButtonPressType_t press_type );
 
@@ -11,10 +11,14 @@
 #include "app_task_ids.h"
 #include "app_times.h"
 #include "event_subscribe.h"
+#include "event_timer.h"
+#include "event_trace.h"
 #include "global.h"
 #include "qassert.h"
+#include "state_profile.h"
 #include "state_task.h"
 #include "state_tasker.h"
+#include "tick_timer.h"
 
 /* Application Tasks */
 #include "app_task_led.h"
@@ -35,22 +39,36 @@ DEFINE_THIS_FILE; /* Used for ASSERT checks to define __FILE__ only once */
 
 // ~~~ Event Pool Types ~~~
 
-/** Up to three distinct storage pools. */
-EventPool eventPool[3];
+/** One pool per group of event sizes, see AppEventPoolID. */
+EventPool eventPool[POOL_MAX];
 
-/** @note: Select the following typedefs as approximately the largest
- *         within their group of small, medium and large structures.
- *         You need to make sure that EventsLargeType corresponds to the
- *         biggest event that can be allocated.
+/** @note: Select the following typedefs as the largest within their group
+ *         of small and medium structures. Movements and lighting fades are
+ *         the bulk of the traffic, so each gets a slab sized to its type.
+ *         Pools need to be added in ascending order of size, so an event
+ *         is allocated from the pool it was sized for.
  */
-typedef ButtonPressedEvent EventsSmallType;
-typedef ButtonEvent        EventsMediumType;
-typedef MotionPlannerEvent EventsLargeType;
+typedef ButtonPressedEvent   EventsSmallType;
+typedef LightingManualEvent  EventsMediumType;
+typedef LightingPlannerEvent EventsLightingType;
+typedef MotionPlannerEvent   EventsMotionType;
+
+_Static_assert( sizeof( ButtonEvent ) <= sizeof( EventsMediumType ), "Medium events don't fit" );
+_Static_assert( sizeof( TrackedPositionRequestEvent ) <= sizeof( EventsMediumType ), "Medium events don't fit" );
+_Static_assert( sizeof( EventsMediumType ) < sizeof( EventsLightingType ), "Lighting pool would take medium events" );
+_Static_assert( sizeof( EventsLightingType ) < sizeof( EventsMotionType ), "Motion pool would take lighting events" );
 
 // ~~~ Event Pool Storage ~~~
+// The bytes each slab takes are printed after every build, see ReportEventPools.cmake
 EventsSmallType  eventsSmall[10];     //  __attribute__ ((section (".ccmram")))
-EventsMediumType eventsMedium[15];    //  __attribute__ ((section (".ccmram")))
-EventsLargeType __attribute__( ( section( ".ccmram" ) ) ) eventsLarge[400];
+EventsMediumType eventsMedium[20];    //  __attribute__ ((section (".ccmram")))
+
+// Enough for a full request queue, plus events still waiting to be queued
+EventsLightingType __attribute__( ( section( ".ccmram" ) ) ) eventsLighting[LED_QUEUE_DEPTH_MAX + 50];
+EventsMotionType __attribute__( ( section( ".ccmram" ) ) ) eventsMotion[MOVEMENT_QUEUE_DEPTH_MAX + 50];
+
+// The slabs are the only user of the 64K core coupled memory
+_Static_assert( sizeof( eventsLighting ) + sizeof( eventsMotion ) <= ( 64U * 1024U ), "Event slabs exceed CCM" );
 
 // ~~~ Event Subscription Data ~~~
 EventSubscribers eventSubscriberList[STATE_MAX_SIGNAL];
@@ -88,17 +106,22 @@ void app_tasks_init( void )
     ALLEGE( eventPoolAddStorage( (StateEvent *)&eventsSmall,
                                  DIM( eventsSmall ),
                                  sizeof( EventsSmallType ) )
-            != 0 );
+            == POOL_SMALL + 1 );
 
     ALLEGE( eventPoolAddStorage( (StateEvent *)&eventsMedium,
                                  DIM( eventsMedium ),
                                  sizeof( EventsMediumType ) )
-            != 0 );
+            == POOL_MEDIUM + 1 );
 
-    ALLEGE( eventPoolAddStorage( (StateEvent *)&eventsLarge,
-                                 DIM( eventsLarge ),
-                                 sizeof( EventsLargeType ) )
-            != 0 );
+    ALLEGE( eventPoolAddStorage( (StateEvent *)&eventsLighting,
+                                 DIM( eventsLighting ),
+                                 sizeof( EventsLightingType ) )
+            == POOL_LIGHTING + 1 );
+
+    ALLEGE( eventPoolAddStorage( (StateEvent *)&eventsMotion,
+                                 DIM( eventsMotion ),
+                                 sizeof( EventsMotionType ) )
+            == POOL_MOTION + 1 );
 
     /* ~~~ Event Subscription Tables Initialisation ~~~ */
     eventSubscribeInit( mainTaskTable, eventSubscriberList, STATE_MAX_SIGNAL );
@@ -106,6 +129,17 @@ void app_tasks_init( void )
     /* ~~~ Event Timers Initialisation ~~~ */
     eventTimerInit();
 
+    /* ~~~ Callback Timers Initialisation ~~~ */
+    tick_timer_init();
+
+    /* ~~~ Handler Profiling Initialisation ~~~ */
+    stateProfileInit();
+
+#ifdef EVENT_TRACE
+    /* ~~~ Event Trace Initialisation ~~~ */
+    eventTraceInit();
+#endif
+
     /* ~~~ Init background processes ~~~ */
     app_background_init();
 
@@ -141,7 +175,7 @@ void app_tasks_init( void )
     stateTaskerStartTask( &mainTasker, t );
 
     hal_systick_hook( 1, eventTimerTick );
-    hal_systick_hook( 1, user_interface_handle_data );
+    hal_systick_hook( 1, tick_timer_tick );
     hal_systick_hook( 1, hal_adc_tick );
 }
 
@@ -158,6 +192,15 @@ app_tasks_run( void )
     /* Run the background processes. */
     app_background();
 
+    /* Publish events raised from interrupt handlers since the last cycle. */
+    eventPublishDeferred();
+
+    /* Post the events for timers which expired since the last cycle. */
+    eventTimerProcess();
+
+    /* Run the callbacks of tick timers which expired since the last cycle. */
+    tick_timer_process();
+
     /* Run a single task event. */
     return stateTaskerRunEvent( &mainTasker );
 }
@@ -174,6 +217,16 @@ app_task_by_id( uint8_t id )
 
 /* -------------------------------------------------------------------------- */
 
+/** Update the task handling statistics before they are reported */
+
+PUBLIC void
+app_task_update_statistics( void )
+{
+    stateTaskerUpdateStatistics( &mainTasker );
+}
+
+/* -------------------------------------------------------------------------- */
+
 /** Clear the task handling statistics */
 
 PUBLIC void
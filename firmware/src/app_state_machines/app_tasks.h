@@ -36,6 +36,13 @@ app_task_by_id( uint8_t id );
 
 /* -------------------------------------------------------------------------- */
 
+/** Update the task handling statistics before they are reported */
+
+PUBLIC void
+app_task_update_statistics( void );
+
+/* -------------------------------------------------------------------------- */
+
 /** Clear the task handling statistics */
 
 PUBLIC void
@@ -27,15 +27,49 @@ enum SystemDefines
     ADC_SAMPLE_RATE_MS         = 20U,    // 50Hz
     BACKGROUND_RATE_HARD_IC_MS = 5U,     //  100Hz
 
+    BACKGROUND_RATE_MOTION_MS  = 1U,      //   1kHz
     BACKGROUND_RATE_BUTTON_MS  = 20U,     //  50Hz
     BACKGROUND_RATE_BUZZER_MS  = 10U,     // 100Hz
     BACKGROUND_ADC_AVG_POLL_MS = 100U,    //  10Hz
 
+    JOB_SLACK_BUDGET_US = 500U,    // housekeeping jobs only start if they fit within this much of the pass
+
+    LOOP_BUDGET_WARNING_US = 1200U,    // superloop pass missed a 1ms tick
+    LOOP_BUDGET_LIMIT_US   = 5000U,    // superloop pass long enough to disturb motion
+
     MOVEMENT_QUEUE_DEPTH_MAX = 150U,    // movement events in the queue
     LED_QUEUE_DEPTH_MAX      = 250U,    // LED animations in the queue
 
-    EFFECTOR_SPEED_LIMIT    = 350U,    // mm/second
+    // Slots granted to the host, the rest of each queue covers events still on their way to the task
+    MOVEMENT_CREDIT_WINDOW = 120U,
+    LED_CREDIT_WINDOW      = 200U,
+    QUEUE_CREDIT_BATCH     = 8U,    // retired slots are returned to the host in groups
+
+    EFFECTOR_SPEED_LIMIT    = 600U,    // mm/second, ceiling regardless of position in the workspace
+    SERVO_SPEED_LIMIT       = 270U,    // degrees/second at the shoulder, ~350mm/s in the worst part of the workspace
     SPEED_SAMPLE_RESOLUTION = 15U,     // number of samples to sum across line
+
+#ifdef EXPANSION_SERVO
+    EXPANSION_SPEED_LIMIT = 360U,    // degrees/second
+#endif
+};
+
+/* -------------------------------------------------------------------------- */
+
+enum ResonanceDefines
+{
+    RESONANCE_START_HZ  = 2U,
+    RESONANCE_END_HZ    = 20U,    // HLFB is a ~45Hz PWM signal, so torque can't be resolved much higher
+    RESONANCE_STEP_HZ   = 1U,
+    RESONANCE_NUM_STEPS = ( ( RESONANCE_END_HZ - RESONANCE_START_HZ ) / RESONANCE_STEP_HZ ) + 1,
+
+    RESONANCE_AMPLITUDE_UM   = 500U,    // peak excursion from the centre point
+    RESONANCE_SETTLE_CYCLES  = 2U,      // cycles discarded while the response reaches steady state
+    RESONANCE_MEASURE_CYCLES = 6U,      // cycles correlated against the drive signal
+
+    RESONANCE_CENTRE_Z_MM    = 50U,
+    RESONANCE_CENTRE_MOVE_MS = 800U,
+    RESONANCE_POLL_MS        = 50U,
 };
 
 /* -------------------------------------------------------------------------- */
@@ -45,6 +79,11 @@ enum CommunicationDefines
     MODULE_BAUD   = 500000,
     INTERNAL_BAUD = 115200,
     EXTERNAL_BAUD = 115200,
+
+    UI_RX_BUDGET_BYTES = 128,    // parsed per link each superloop pass, the module link delivers ~50 bytes/ms
+
+    UI_TELEMETRY_PERCENT  = 25,     // share of each link's bandwidth pushed telemetry may use
+    UI_TELEMETRY_BURST_MS = 100,    // unused budget builds up for at most this long
 };
 
 /* -------------------------------------------------------------------------- */
@@ -30,6 +30,14 @@ typedef union    ///< Allow mapping int16 to uint16
 
 //#define EXPANSION_SERVO
 
+// Record task event posts and dispatches into a RAM ring for timeline
+// analysis. Cheap enough to leave on, comment out to reclaim the RAM.
+#define EVENT_TRACE
+
+// Run a third UI link on the expansion IO header. Its pins are shared with the
+// external e-stop input and status output, which can't be used alongside it.
+//#define EXTERNAL_UI_LINK
+
 
 //! \def PRIVATE
 /// Makes it more clear that static functions/data are really private.
@@ -121,10 +129,11 @@ typedef union    ///< Allow mapping int16 to uint16
 
 //! \def CRITICAL_SECTION_START()
 /// Save the current interrupt state and then disable interrupts to
-/// enter a critical region of code.
+/// enter a critical region of code. Host builds can supply their own
+/// versions of the interrupt macros, see firmware/test.
 #ifdef STM32F429xx
 #define CRITICAL_SECTION_VAR() uint8_t cpuSR
-#else
+#elif !defined( CRITICAL_SECTION_VAR )
 #define CRITICAL_SECTION_VAR()
 #endif
 
@@ -140,7 +149,7 @@ typedef union    ///< Allow mapping int16 to uint16
           "STRB R0, %[output]"                \
           : [output] "=m" (cpuSR) :: "r0");   \
         } while(0)
-#else
+#elif !defined( CRITICAL_SECTION_START )
 #define CRITICAL_SECTION_START()
 #endif
 
@@ -155,7 +164,7 @@ typedef union    ///< Allow mapping int16 to uint16
           "msr PRIMASK,r0;\n\t"               \
           ::[input] "m" (cpuSR) : "r0");      \
         } while(0)
-#else
+#elif !defined( CRITICAL_SECTION_END )
 #define CRITICAL_SECTION_END()
 #endif
 
@@ -172,6 +181,48 @@ typedef union    ///< Allow mapping int16 to uint16
                                      CRITICAL_SECTION_END();    \
                                  } while(0)
 
+//! \def IN_INTERRUPT()
+/// True when called from an exception or interrupt handler.
+#ifdef STM32F429xx
+#define IN_INTERRUPT()                        \
+        ( {                                   \
+          uint32_t ipsr;                      \
+          asm volatile ( "MRS %0, IPSR"       \
+                         : "=r" (ipsr) );     \
+          ipsr != 0;                          \
+        } )
+#elif !defined( IN_INTERRUPT )
+#define IN_INTERRUPT() false
+#endif
+
+//! \def MEMORY_BARRIER()
+/// Complete outstanding memory accesses before continuing, and stop the
+/// compiler from reordering accesses across it. Used when handing data
+/// between interrupt handlers and the main loop without locking.
+#ifdef STM32F429xx
+#define MEMORY_BARRIER() asm volatile ( "DMB" ::: "memory" )
+#elif !defined( MEMORY_BARRIER )
+#define MEMORY_BARRIER() __sync_synchronize()
+#endif
+
+//! \def COMPARE_AND_SWAP()
+/// Store desired if the location still holds expected, true when it did.
+/// Built on the exclusive load/store (LDREX/STREX) on the target, so an
+/// interrupt touching the location in between makes it fail rather than
+/// having to be masked.
+#ifndef COMPARE_AND_SWAP
+#define COMPARE_AND_SWAP( ptr, expected, desired ) __sync_bool_compare_and_swap( ptr, expected, desired )
+#endif
+
+//! \def CYCLE_COUNT()
+/// Free-running CPU cycle count from the DWT, enabled at startup by
+/// hal_system_speed_init. Wraps every ~24s at 180MHz.
+#ifdef STM32F429xx
+#define CYCLE_COUNT() ( *(volatile uint32_t *)0xE0001004UL )
+#else
+#define CYCLE_COUNT() 0U
+#endif
+
 /* ----- End ------------~--------------------------------------------------- */
 #ifdef    __cplusplus
 }
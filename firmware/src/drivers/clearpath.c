@@ -220,6 +220,13 @@ servo_get_servo_did_error( ClearpathServoInstance_t servo )
     return ( me->currentState == SERVO_STATE_ERROR_RECOVERY || me->previousState == SERVO_STATE_ERROR_RECOVERY || me->nextState == SERVO_STATE_ERROR_RECOVERY );
 }
 
+// Trimmed HLFB torque feedback, -100% to 100% of rated capability
+PUBLIC float
+servo_get_feedback_torque( ClearpathServoInstance_t servo )
+{
+    return servo_get_hlfb_percent_corrected( servo );
+}
+
 /* -------------------------------------------------------------------------- */
 
 // Returns uncorrected servo feedback torque as a percentage from -100% to 100% of rated capability
@@ -254,6 +261,8 @@ servo_process( ClearpathServoInstance_t servo )
 {
     Servo_t *me = &clearpath[servo];
 
+    STATE_PROFILE_BEGIN;
+
     float servo_power    = sensors_servo_W( ServoHardwareMap[servo].adc_current );
     float servo_feedback = servo_get_hlfb_percent_corrected( servo );
 
@@ -602,6 +611,8 @@ servo_process( ClearpathServoInstance_t servo )
     user_interface_motor_enable( servo, me->enabled );
     user_interface_motor_feedback( servo, servo_feedback );
     user_interface_motor_power( servo, servo_power );
+
+    STATE_PROFILE_END( servo_process, "servo", servo );
 }
 
 /* -------------------------------------------------------------------------- */
@@ -57,6 +57,9 @@ servo_get_servo_ok( ClearpathServoInstance_t servo );
 PUBLIC bool
 servo_get_servo_did_error( ClearpathServoInstance_t servo );
 
+PUBLIC float
+servo_get_feedback_torque( ClearpathServoInstance_t servo );
+
 /* -------------------------------------------------------------------------- */
 
 PUBLIC void
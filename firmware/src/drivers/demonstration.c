@@ -49,7 +49,7 @@ static const Movement_t demo_one[] = {
     MOVE_BETWEEN_SMOOTH( 1000, 0.05f, 60, 0, 50, 0, 0, 50 ),
     DELAY_MOVEMENT( 100 ),
     MOVE_BETWEEN_SMOOTH( 500, 0.05f, 0, 0, 50, 0, 60, 50 ),
-    MOVE_BETWEEN_SMOOTH( 250, 0.01f, 0, 60, 50, 0, -60, 50 ),
+    MOVE_BETWEEN_SMOOTH( 400, 0.01f, 0, 60, 50, 0, -60, 50 ),
     MOVE_BETWEEN_SMOOTH( 500, 0.05f, 0, -60, 50, 0, 0, 50 ),
     DELAY_MOVEMENT( 100 ),
     MOVE_BETWEEN_SMOOTH( 500, 0.05f, 0, 0, 50, 0, 0, 30 ),
@@ -60,10 +60,10 @@ static const Movement_t demo_one[] = {
     // rectangle on xy plane
     MOVE_BETWEEN_SMOOTH( 800, 0.001f, 0, 0, 50, 45, 45, 50 ),
     DELAY_MOVEMENT( 100 ),
-    MOVE_BETWEEN_SMOOTH( 200, 0.01f, 45, 45, 50, -45, 45, 50 ),
-    MOVE_BETWEEN_SMOOTH( 200, 0.01f, -45, 45, 50, -45, -45, 50 ),
-    MOVE_BETWEEN_SMOOTH( 200, 0.01f, -45, -45, 50, 45, -45, 50 ),
-    MOVE_BETWEEN_SMOOTH( 200, 0.01f, 45, -45, 50, 45, 45, 50 ),
+    MOVE_BETWEEN_SMOOTH( 300, 0.01f, 45, 45, 50, -45, 45, 50 ),
+    MOVE_BETWEEN_SMOOTH( 300, 0.01f, -45, 45, 50, -45, -45, 50 ),
+    MOVE_BETWEEN_SMOOTH( 300, 0.01f, -45, -45, 50, 45, -45, 50 ),
+    MOVE_BETWEEN_SMOOTH( 300, 0.01f, 45, -45, 50, 45, 45, 50 ),
 
     // Move straight to circle location
     DELAY_MOVEMENT( 100 ),
@@ -158,42 +158,42 @@ static const Movement_t demo_one[] = {
                   POINT_MM( 49, -90, 51 ),
                   POINT_MM( 0, -90, 50 ) ),
 
-    CUBIC_BEZIER( 300,
+    CUBIC_BEZIER( 325,
                   POINT_MM( 0, -90, 50 ),
                   POINT_MM( -49, -90, 50 ),
                   POINT_MM( -90, -49, 50 ),
                   POINT_MM( -90, 0, 49 ) ),
 
-    CUBIC_BEZIER( 250,
+    CUBIC_BEZIER( 325,
                   POINT_MM( -90, 0, 49 ),
                   POINT_MM( -90, 49, 49 ),
                   POINT_MM( -49, 90, 49 ),
                   POINT_MM( 0, 90, 48 ) ),
 
-    // Fast circle
-    CUBIC_BEZIER( 250,
+    // Fast circle, as fast as the middle of the volume allows
+    CUBIC_BEZIER( 325,
                   POINT_MM( 0, 90, 48 ),
                   POINT_MM( 49, 90, 47 ),
                   POINT_MM( 90, 49, 47 ),
                   POINT_MM( 90, 0, 46 ) ),
-    CUBIC_BEZIER( 250,
+    CUBIC_BEZIER( 325,
                   POINT_MM( 90, 0, 46 ),
                   POINT_MM( 90, -49, 45 ),
                   POINT_MM( 49, -90, 45 ),
                   POINT_MM( 0, -90, 44 ) ),
-    CUBIC_BEZIER( 250,
+    CUBIC_BEZIER( 325,
                   POINT_MM( 0, -90, 44 ),
                   POINT_MM( -49, -90, 43 ),
                   POINT_MM( -90, -49, 43 ),
                   POINT_MM( -90, 0, 42 ) ),
-    CUBIC_BEZIER( 250,
+    CUBIC_BEZIER( 325,
                   POINT_MM( -90, 0, 42 ),
                   POINT_MM( -90, 49, 41 ),
                   POINT_MM( -49, 90, 41 ),
                   POINT_MM( 0, 90, 40 ) ),
 
     // Shrinking circle
-    CUBIC_BEZIER( 275,
+    CUBIC_BEZIER( 325,
                   POINT_MM( 0, 90, 40 ),
                   POINT_MM( 46, 84, 40 ),
                   POINT_MM( 78, 43, 40 ),
@@ -0,0 +1,240 @@
+/* ----- System Includes ---------------------------------------------------- */
+
+#include <math.h>
+#include <string.h>
+
+/* ----- Local Includes ----------------------------------------------------- */
+
+#include "input_shaper.h"
+
+#include "app_times.h"
+#include "hal_systick.h"
+
+/* ----- Defines ------------------------------------------------------------ */
+
+// Setpoint history is sampled at 1ms, so this bounds the longest shaper duration.
+// ZVD/EI shapers span one damped period, so 256ms supports resonances down to ~4Hz
+#define INPUT_SHAPER_HISTORY_MS 256U
+#define INPUT_SHAPER_IMPULSES   3U
+
+// Residual vibration tolerated by the EI shaper (5%)
+#define INPUT_SHAPER_EI_TOLERANCE 0.05f
+
+typedef struct
+{
+    InputShaperType_t type;
+    float             frequency;
+    float             damping;
+
+    uint8_t  num_impulses;
+    float    amplitude[INPUT_SHAPER_IMPULSES];    // normalised impulse weights, sum to 1.0
+    uint16_t delay_ms[INPUT_SHAPER_IMPULSES];     // impulse offset from the current time
+
+    bool     primed;           // history holds valid samples
+    uint32_t last_sample;      // timestamp of the newest history entry
+    uint32_t target_changed;   // timestamp the raw target last moved
+
+    CartesianPoint_t output;   // last shaped setpoint sent to the servos
+
+    CartesianPoint_t history[INPUT_SHAPER_HISTORY_MS];
+} InputShaper_t;
+
+/* ----- Private Variables -------------------------------------------------- */
+
+PRIVATE InputShaper_t shaper;
+
+PRIVATE void input_shaper_set_passthrough( void );
+
+/* ----- Public Functions --------------------------------------------------- */
+
+PUBLIC void
+input_shaper_init( void )
+{
+    memset( &shaper, 0, sizeof( shaper ) );
+    input_shaper_set_passthrough();
+}
+
+/* -------------------------------------------------------------------------- */
+
+PUBLIC void
+input_shaper_configure( InputShaperType_t type, float frequency_hz, float damping_ratio )
+{
+    InputShaper_t *me = &shaper;
+
+    if( type == me->type && frequency_hz == me->frequency && damping_ratio == me->damping )
+    {
+        return;
+    }
+
+    me->type      = type;
+    me->frequency = frequency_hz;
+    me->damping   = damping_ratio;
+
+    // The longest impulse delay is one damped period, which needs to fit in the history buffer
+    float min_frequency = 1000.0f / ( INPUT_SHAPER_HISTORY_MS - 1 );
+
+    if( type == SHAPER_NONE || frequency_hz < min_frequency || damping_ratio < 0.0f || damping_ratio >= 1.0f )
+    {
+        input_shaper_set_passthrough();
+        return;
+    }
+
+    float damped_scale  = sqrtf( 1.0f - ( damping_ratio * damping_ratio ) );
+    float k             = expf( -damping_ratio * M_PI / damped_scale );
+    float damped_period = 1000.0f / ( frequency_hz * damped_scale );    // in milliseconds
+
+    me->delay_ms[0] = 0;
+    me->delay_ms[1] = ( uint16_t )( ( damped_period * 0.5f ) + 0.5f );
+    me->delay_ms[2] = ( uint16_t )( damped_period + 0.5f );
+
+    switch( type )
+    {
+        case SHAPER_ZV:
+            me->num_impulses = 2;
+            me->amplitude[0] = 1.0f;
+            me->amplitude[1] = k;
+            break;
+
+        case SHAPER_ZVD:
+            me->num_impulses = 3;
+            me->amplitude[0] = 1.0f;
+            me->amplitude[1] = 2.0f * k;
+            me->amplitude[2] = k * k;
+            break;
+
+        case SHAPER_EI:
+            me->num_impulses = 3;
+            me->amplitude[0] = 0.25f * ( 1.0f + INPUT_SHAPER_EI_TOLERANCE );
+            me->amplitude[1] = 0.5f * ( 1.0f - INPUT_SHAPER_EI_TOLERANCE ) * k;
+            me->amplitude[2] = me->amplitude[0] * k * k;
+            break;
+
+        default:
+            input_shaper_set_passthrough();
+            return;
+    }
+
+    // Normalise so the shaped output reaches the same final position as the input
+    float sum = 0.0f;
+    for( uint8_t i = 0; i < me->num_impulses; i++ )
+    {
+        sum += me->amplitude[i];
+    }
+
+    for( uint8_t i = 0; i < me->num_impulses; i++ )
+    {
+        me->amplitude[i] /= sum;
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+
+PUBLIC void
+input_shaper_reset( CartesianPoint_t *position )
+{
+    InputShaper_t *me = &shaper;
+
+    for( uint16_t i = 0; i < INPUT_SHAPER_HISTORY_MS; i++ )
+    {
+        memcpy( &me->history[i], position, sizeof( CartesianPoint_t ) );
+    }
+
+    me->output         = *position;
+    me->last_sample    = hal_systick_get_ms();
+    me->target_changed = me->last_sample - INPUT_SHAPER_HISTORY_MS;
+    me->primed         = true;
+}
+
+/* -------------------------------------------------------------------------- */
+
+PUBLIC void
+input_shaper_hold( CartesianPoint_t *position )
+{
+    InputShaper_t *me = &shaper;
+
+    // The servos are part way along the shaped path, resetting to the raw target would step them
+    if( me->primed )
+    {
+        *position = me->output;
+    }
+
+    input_shaper_reset( position );
+}
+
+/* -------------------------------------------------------------------------- */
+
+PUBLIC void
+input_shaper_process( CartesianPoint_t *target, CartesianPoint_t *shaped )
+{
+    InputShaper_t *me  = &shaper;
+    uint32_t       now = hal_systick_get_ms();
+
+    if( !me->primed )
+    {
+        input_shaper_reset( target );
+    }
+
+    CartesianPoint_t *newest = &me->history[me->last_sample % INPUT_SHAPER_HISTORY_MS];
+
+    if( newest->x != target->x || newest->y != target->y || newest->z != target->z )
+    {
+        me->target_changed = now;
+    }
+
+    // Fill any milliseconds skipped since the last call by holding the previous sample,
+    // the target only applies from now so a gap doesn't turn into an early step
+    CartesianPoint_t held    = *newest;
+    uint32_t         elapsed = MIN( now - me->last_sample, INPUT_SHAPER_HISTORY_MS );
+    for( uint32_t i = 1; i < elapsed; i++ )
+    {
+        memcpy( &me->history[( me->last_sample + i ) % INPUT_SHAPER_HISTORY_MS], &held, sizeof( CartesianPoint_t ) );
+    }
+
+    // Multiple calls in the same millisecond just update the current sample
+    memcpy( &me->history[now % INPUT_SHAPER_HISTORY_MS], target, sizeof( CartesianPoint_t ) );
+    me->last_sample = now;
+
+    // Convolve the delayed history with the impulse sequence
+    float x = 0.0f;
+    float y = 0.0f;
+    float z = 0.0f;
+
+    for( uint8_t i = 0; i < me->num_impulses; i++ )
+    {
+        CartesianPoint_t *sample = &me->history[( now - me->delay_ms[i] ) % INPUT_SHAPER_HISTORY_MS];
+
+        x += me->amplitude[i] * sample->x;
+        y += me->amplitude[i] * sample->y;
+        z += me->amplitude[i] * sample->z;
+    }
+
+    shaped->x = lroundf( x );
+    shaped->y = lroundf( y );
+    shaped->z = lroundf( z );
+
+    me->output = *shaped;
+}
+
+/* -------------------------------------------------------------------------- */
+
+PUBLIC bool
+input_shaper_is_settled( void )
+{
+    InputShaper_t *me = &shaper;
+
+    return !me->primed || ( hal_systick_get_ms() - me->target_changed ) > me->delay_ms[me->num_impulses - 1];
+}
+
+/* ----- Private Functions -------------------------------------------------- */
+
+PRIVATE void
+input_shaper_set_passthrough( void )
+{
+    InputShaper_t *me = &shaper;
+
+    me->num_impulses = 1;
+    me->amplitude[0] = 1.0f;
+    me->delay_ms[0]  = 0;
+}
+
+/* ----- End ---------------------------------------------------------------- */
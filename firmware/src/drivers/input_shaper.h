@@ -0,0 +1,56 @@
+#ifndef INPUT_SHAPER_H
+#define INPUT_SHAPER_H
+
+/* ----- Local Includes ----------------------------------------------------- */
+
+#include "global.h"
+#include <motion_types.h>
+
+/* ----- Types ------------------------------------------------------------- */
+
+typedef enum
+{
+    SHAPER_NONE = 0,
+    SHAPER_ZV,     // two impulses, sensitive to frequency error
+    SHAPER_ZVD,    // three impulses, robust to frequency error
+    SHAPER_EI,     // three impulses, tolerates 5% residual vibration for wider robustness
+} InputShaperType_t;
+
+/* ----- Public Functions --------------------------------------------------- */
+
+PUBLIC void
+input_shaper_init( void );
+
+/* -------------------------------------------------------------------------- */
+
+// Recalculates the impulse sequence if the settings differ from the current ones
+PUBLIC void
+input_shaper_configure( InputShaperType_t type, float frequency_hz, float damping_ratio );
+
+/* -------------------------------------------------------------------------- */
+
+// Flush the setpoint history so the shaped output sits at the given position
+PUBLIC void
+input_shaper_reset( CartesianPoint_t *position );
+
+/* -------------------------------------------------------------------------- */
+
+// Flush the setpoint history at the last shaped output, and return that position
+PUBLIC void
+input_shaper_hold( CartesianPoint_t *position );
+
+/* -------------------------------------------------------------------------- */
+
+// Add the raw target to the history and calculate the shaped setpoint for this instant
+PUBLIC void
+input_shaper_process( CartesianPoint_t *target, CartesianPoint_t *shaped );
+
+/* -------------------------------------------------------------------------- */
+
+// True once the shaped output has caught up with a stationary target
+PUBLIC bool
+input_shaper_is_settled( void );
+
+/* -------------------------------------------------------------------------- */
+
+#endif /* INPUT_SHAPER_H */
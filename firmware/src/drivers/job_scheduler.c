@@ -0,0 +1,232 @@
+/* ----- System Includes ---------------------------------------------------- */
+
+#include <string.h>
+
+/* ----- Local Includes ----------------------------------------------------- */
+
+#include "job_scheduler.h"
+
+#include "app_times.h"
+#include "hal_system_speed.h"
+#include "hal_systick.h"
+
+/* ----- Defines ------------------------------------------------------------ */
+
+typedef struct
+{
+    const char   *name;
+    JobFunction_t function;
+    JobPriority_t priority;
+    uint16_t      period_ms;
+    uint16_t      budget_us;
+    uint32_t      budget_cycles;
+    uint32_t      next_due;
+
+    uint32_t runs;
+    uint32_t max_cycles;
+    uint32_t overruns;
+    uint32_t deferred;
+    uint32_t late;
+} Job_t;
+
+typedef struct
+{
+    Job_t    jobs[JOB_SCHEDULER_MAX_JOBS];
+    uint8_t  count;
+    uint32_t cycles_per_us;
+    uint32_t slack_cycles;
+
+    volatile bool reset_pending;
+} JobScheduler_t;
+
+/* ----- Private Variables -------------------------------------------------- */
+
+PRIVATE JobScheduler_t job_scheduler;
+
+PRIVATE void job_scheduler_clear( JobScheduler_t *me );
+
+/* ----- Public Functions --------------------------------------------------- */
+
+PUBLIC void
+job_scheduler_init( void )
+{
+    JobScheduler_t *me = &job_scheduler;
+
+    memset( me, 0, sizeof( JobScheduler_t ) );
+    me->cycles_per_us = hal_system_speed_get_speed() / 1000000U;
+    me->slack_cycles  = JOB_SLACK_BUDGET_US * me->cycles_per_us;
+}
+
+/* -------------------------------------------------------------------------- */
+
+PUBLIC bool
+job_scheduler_add( const char   *name,
+                   JobFunction_t function,
+                   JobPriority_t priority,
+                   uint16_t      period_ms,
+                   uint16_t      budget_us )
+{
+    JobScheduler_t *me = &job_scheduler;
+
+    if( me->count >= JOB_SCHEDULER_MAX_JOBS )
+    {
+        return false;
+    }
+
+    // Keep the table sorted by priority, jobs of equal priority run in the order they were added
+    uint8_t slot = me->count;
+    while( slot > 0 && me->jobs[slot - 1].priority > priority )
+    {
+        me->jobs[slot] = me->jobs[slot - 1];
+        slot--;
+    }
+
+    Job_t *job = &me->jobs[slot];
+    memset( job, 0, sizeof( Job_t ) );
+
+    job->name          = name;
+    job->function      = function;
+    job->priority      = priority;
+    job->period_ms     = period_ms;
+    job->budget_us     = budget_us;
+    job->budget_cycles = budget_us * me->cycles_per_us;
+    job->next_due      = hal_systick_get_ms() + period_ms;
+
+    me->count++;
+    return true;
+}
+
+/* -------------------------------------------------------------------------- */
+
+PUBLIC void
+job_scheduler_run( void )
+{
+    JobScheduler_t *me = &job_scheduler;
+
+    if( me->reset_pending )
+    {
+        job_scheduler_clear( me );
+    }
+
+    uint32_t pass_start = CYCLE_COUNT();
+    uint32_t now_ms     = hal_systick_get_ms();
+
+    for( uint8_t i = 0; i < me->count; i++ )
+    {
+        Job_t   *job     = &me->jobs[i];
+        uint32_t overdue = 0;
+
+        if( job->period_ms )
+        {
+            if( (int32_t)( now_ms - job->next_due ) < 0 )
+            {
+                continue;
+            }
+
+            overdue = now_ms - job->next_due;
+        }
+
+        bool starved = job->period_ms && overdue >= job->period_ms;
+
+        // Housekeeping waits for a pass with room for it, but never longer than one period
+        if( job->priority >= JOB_PRIORITY_HOUSEKEEPING && !starved )
+        {
+            uint32_t elapsed = CYCLE_COUNT() - pass_start;
+
+            if( elapsed + job->budget_cycles > me->slack_cycles )
+            {
+                job->deferred++;
+                continue;
+            }
+        }
+
+        uint32_t job_start = CYCLE_COUNT();
+        job->function();
+        uint32_t duration = CYCLE_COUNT() - job_start;
+
+        job->runs++;
+
+        if( duration > job->max_cycles )
+        {
+            job->max_cycles = duration;
+        }
+
+        if( duration > job->budget_cycles )
+        {
+            job->overruns++;
+        }
+
+        if( starved )
+        {
+            job->late++;
+        }
+
+        if( job->period_ms )
+        {
+            // Step from the previous deadline so the period doesn't drift, dropping any periods missed entirely
+            job->next_due += job->period_ms;
+
+            if( (int32_t)( now_ms - job->next_due ) >= 0 )
+            {
+                job->next_due = now_ms + job->period_ms;
+            }
+        }
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+
+PUBLIC void
+job_scheduler_reset( void )
+{
+    JobScheduler_t *me = &job_scheduler;
+
+    me->reset_pending = true;
+}
+
+/* -------------------------------------------------------------------------- */
+
+PUBLIC uint8_t
+job_scheduler_get_stats( JobStats_t stats[JOB_SCHEDULER_MAX_JOBS] )
+{
+    JobScheduler_t *me = &job_scheduler;
+
+    memset( stats, 0, sizeof( JobStats_t ) * JOB_SCHEDULER_MAX_JOBS );
+
+    for( uint8_t i = 0; i < me->count; i++ )
+    {
+        Job_t *job = &me->jobs[i];
+
+        strncpy( stats[i].name, job->name, JOB_NAME_LENGTH - 1U );
+        stats[i].runs      = job->runs;
+        stats[i].period_ms = job->period_ms;
+        stats[i].budget_us = job->budget_us;
+        stats[i].max_us    = me->cycles_per_us ? MIN( job->max_cycles / me->cycles_per_us, UINT16_MAX ) : 0;
+        stats[i].overruns  = MIN( job->overruns, UINT16_MAX );
+        stats[i].deferred  = MIN( job->deferred, UINT16_MAX );
+        stats[i].late      = MIN( job->late, UINT16_MAX );
+    }
+
+    return me->count;
+}
+
+/* ----- Private Functions -------------------------------------------------- */
+
+PRIVATE void
+job_scheduler_clear( JobScheduler_t *me )
+{
+    for( uint8_t i = 0; i < me->count; i++ )
+    {
+        Job_t *job = &me->jobs[i];
+
+        job->runs       = 0;
+        job->max_cycles = 0;
+        job->overruns   = 0;
+        job->deferred   = 0;
+        job->late       = 0;
+    }
+
+    me->reset_pending = false;
+}
+
+/* ----- End ---------------------------------------------------------------- */
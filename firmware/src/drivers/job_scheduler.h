@@ -0,0 +1,85 @@
+#ifndef JOB_SCHEDULER_H
+#define JOB_SCHEDULER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ----- System Includes ---------------------------------------------------- */
+
+/* ----- Local Includes ----------------------------------------------------- */
+
+#include "global.h"
+
+/* ----- Defines ------------------------------------------------------------ */
+
+#define JOB_SCHEDULER_MAX_JOBS 9U    // the statistics table has to fit in one UI packet
+#define JOB_NAME_LENGTH        8U
+
+typedef void ( *JobFunction_t )( void );
+
+// Jobs run in priority order, lowest value first
+typedef enum
+{
+    JOB_PRIORITY_MOTION = 0,       // always run as soon as they are due
+    JOB_PRIORITY_OUTPUT,
+    JOB_PRIORITY_COMMS,
+    JOB_PRIORITY_HOUSEKEEPING,     // only run when the pass has slack for them
+} JobPriority_t;
+
+typedef struct
+{
+    char     name[JOB_NAME_LENGTH];
+    uint32_t runs;
+    uint16_t period_ms;
+    uint16_t budget_us;
+    uint16_t max_us;
+    uint16_t overruns;    // runs longer than the budget
+    uint16_t deferred;    // passes where a due housekeeping job had no slack
+    uint16_t late;        // runs starting a full period or more after they were due
+} JobStats_t;
+
+/* ----- Public Functions --------------------------------------------------- */
+
+PUBLIC void
+job_scheduler_init( void );
+
+/* -------------------------------------------------------------------------- */
+
+/** Add a job which runs every period_ms, or on every pass when the period is
+ *  zero. Housekeeping jobs are only started when their budget fits in the
+ *  slack left in the pass, unless they have been waiting a full period.
+ *  Returns false when the table is full. */
+
+PUBLIC bool
+job_scheduler_add( const char   *name,
+                   JobFunction_t function,
+                   JobPriority_t priority,
+                   uint16_t      period_ms,
+                   uint16_t      budget_us );
+
+/* -------------------------------------------------------------------------- */
+
+// Run the jobs which are due, call once per superloop pass
+PUBLIC void
+job_scheduler_run( void );
+
+/* -------------------------------------------------------------------------- */
+
+// Safe to call from interrupts, the statistics are cleared on the next pass
+PUBLIC void
+job_scheduler_reset( void );
+
+/* -------------------------------------------------------------------------- */
+
+// Copy out the statistics in priority order, returns the number of jobs
+PUBLIC uint8_t
+job_scheduler_get_stats( JobStats_t stats[JOB_SCHEDULER_MAX_JOBS] );
+
+/* ----- End ---------------------------------------------------------------- */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* JOB_SCHEDULER_H */
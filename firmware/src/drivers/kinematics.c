@@ -1,11 +1,13 @@
 /* ----- System Includes ---------------------------------------------------- */
 #define _USE_MATH_DEFINES
 #include <math.h>
+#include <string.h>
 
 /* ----- Local Includes ----------------------------------------------------- */
 #include "kinematics.h"
 #include "global.h"
 
+#include "app_times.h"
 #include "configuration.h"
 #include "user_interface.h"
 #include "motion_types.h"
@@ -20,10 +22,13 @@ CartesianPoint_t offset_position = {
 };
 
 // Constrain motion to the practical parts of the movement volume
-int32_t z_max = MM_TO_MICRONS( 200 );
-int32_t z_min = MM_TO_MICRONS( 0 );
+#define VOLUME_Z_MAX  MM_TO_MICRONS( 200 )
+#define VOLUME_Z_MIN  MM_TO_MICRONS( 0 )
+#define VOLUME_RADIUS MM_TO_MICRONS( 225 )
 
-int32_t radius = MM_TO_MICRONS( 225 );
+PRIVATE const int32_t z_max  = VOLUME_Z_MAX;
+PRIVATE const int32_t z_min  = VOLUME_Z_MIN;
+PRIVATE const int32_t radius = VOLUME_RADIUS;
 
 // Rotate the cartesian co-ordinate space
 int8_t flip_x = 1;
@@ -49,6 +54,21 @@ float deg_to_rad;
 // Cache common calculations
 float t;
 
+// Coarse grid of the local effector speed limit, from the worst-case joint rate per mm of travel.
+// Spans the square around the cylindrical work volume, z is sampled more finely as the gain changes fastest near the top
+#define SPEED_GRID_XY_STEP   MM_TO_MICRONS( 50 )
+#define SPEED_GRID_Z_STEP    MM_TO_MICRONS( 25 )
+#define SPEED_GRID_XY_POINTS ( ( ( 2 * VOLUME_RADIUS ) + SPEED_GRID_XY_STEP - 1 ) / SPEED_GRID_XY_STEP + 1 )
+#define SPEED_GRID_Z_POINTS  ( ( ( VOLUME_Z_MAX - VOLUME_Z_MIN ) + SPEED_GRID_Z_STEP - 1 ) / SPEED_GRID_Z_STEP + 1 )
+#define SPEED_GRID_PROBE     MM_TO_MICRONS( 1 )
+
+// Cells are looked up from the corner below the point, so each axis needs at least two points
+_Static_assert( SPEED_GRID_XY_POINTS >= 2 && SPEED_GRID_XY_POINTS <= UINT8_MAX, "Speed grid XY size out of range" );
+_Static_assert( SPEED_GRID_Z_POINTS >= 2 && SPEED_GRID_Z_POINTS <= UINT8_MAX, "Speed grid Z size out of range" );
+
+PRIVATE uint16_t speed_limit_grid[SPEED_GRID_Z_POINTS][SPEED_GRID_XY_POINTS][SPEED_GRID_XY_POINTS];    // mm/second
+PRIVATE uint16_t speed_limit_minimum;                                                                     // slowest point in the grid
+
 /* ----- Private Variables -------------------------------------------------- */
 
 PRIVATE KinematicsSolution_t
@@ -57,6 +77,15 @@ delta_angle_plane_calc( float x0, float y0, float z0, float *theta );
 PRIVATE void
 kinematics_clamp_volume( CartesianPoint_t *point );
 
+PRIVATE KinematicsSolution_t
+kinematics_solve( CartesianPoint_t input, JointAngles_t *output );
+
+PRIVATE mm_per_second_t
+kinematics_calculate_speed_limit( CartesianPoint_t point );
+
+PRIVATE void
+kinematics_build_speed_grid( void );
+
 /* ----- Public Functions --------------------------------------------------- */
 
 PUBLIC void
@@ -77,6 +106,8 @@ kinematics_init( void )
     user_interface_set_kinematics_mechanism_info( f, rf, re, e );
     user_interface_set_kinematics_limits( radius, z_min, z_max );
     user_interface_set_kinematics_flips( flip_x, flip_y, flip_z );
+
+    kinematics_build_speed_grid();
 }
 
 /* -------------------------------------------------------------------------- */
@@ -140,6 +171,128 @@ kinematics_point_to_angle( CartesianPoint_t input, JointAngles_t *output )
     // Apply an optional rotation around the Z axis
     cartesian_point_rotate_around_z( &input, configuration_get_rotation_z() );
 
+    return kinematics_solve( input, output );
+}
+
+/* -------------------------------------------------------------------------- */
+
+/*
+ * Returns the fastest the effector can travel through a point without exceeding the servo speed limit
+ *
+ * Uses the most restrictive corner of the speed grid cell containing the point,
+ * so the limit is conservative between grid points.
+ */
+
+PUBLIC mm_per_second_t
+kinematics_speed_limit( CartesianPoint_t *point )
+{
+    // The grid is built in the mechanism's frame, so apply the same rotation as the IK
+    CartesianPoint_t rotated = *point;
+    cartesian_point_rotate_around_z( &rotated, configuration_get_rotation_z() );
+    kinematics_clamp_volume( &rotated );
+
+    uint8_t x = CLAMP( ( rotated.x + radius ) / SPEED_GRID_XY_STEP, 0, SPEED_GRID_XY_POINTS - 2 );
+    uint8_t y = CLAMP( ( rotated.y + radius ) / SPEED_GRID_XY_STEP, 0, SPEED_GRID_XY_POINTS - 2 );
+    uint8_t z = CLAMP( ( rotated.z - z_min ) / SPEED_GRID_Z_STEP, 0, SPEED_GRID_Z_POINTS - 2 );
+
+    mm_per_second_t limit = EFFECTOR_SPEED_LIMIT;
+
+    for( uint8_t i = 0; i < 8; i++ )
+    {
+        uint16_t corner = speed_limit_grid[z + ( ( i >> 2 ) & 1 )][y + ( ( i >> 1 ) & 1 )][x + ( i & 1 )];
+        limit           = MIN( limit, corner );
+    }
+
+    return limit;
+}
+
+/* -------------------------------------------------------------------------- */
+
+PUBLIC mm_per_second_t
+kinematics_speed_limit_minimum( void )
+{
+    return speed_limit_minimum;
+}
+
+/* -------------------------------------------------------------------------- */
+
+PUBLIC float
+kinematics_volume_reach( CartesianPoint_t *point )
+{
+    // The effector can't be outside the volume, and the rotation around z doesn't change distances
+    CartesianPoint_t clamped = *point;
+    kinematics_clamp_volume( &clamped );
+
+    // The furthest point is on the far side of the rim, at whichever end of the cylinder is further away
+    float horizontal = radius + sqrtf( ( (float)clamped.x * clamped.x ) + ( (float)clamped.y * clamped.y ) );
+    float vertical   = MAX( clamped.z - z_min, z_max - clamped.z );
+
+    return sqrtf( ( horizontal * horizontal ) + ( vertical * vertical ) );
+}
+
+/* -------------------------------------------------------------------------- */
+
+/*
+ * Check each slice of a move against the speed limit where it runs, as the servos need
+ * to turn much faster near the edges of the workspace than in the middle.
+ *
+ * The move has to be resolved to where it will run. When its start isn't known, it is
+ * held to the slowest limit anywhere in the workspace.
+ */
+
+PUBLIC bool
+kinematics_move_is_feasible( Movement_t *move, bool start_known )
+{
+    mm_per_second_t limit_minimum = speed_limit_minimum;
+
+    // A transit from an unknown start has to be slow enough from the furthest point in the workspace
+    if( !start_known && move->type == _POINT_TRANSIT && move->ref == _POS_ABSOLUTE )
+    {
+        float reach = kinematics_volume_reach( &move->points[move->num_pts - 1] );
+
+        // microns-per-millisecond is millimeters-per-second
+        return ( reach / move->duration ) < limit_minimum;
+    }
+
+    // Moves which could end up anywhere are held to the slowest limit in the workspace
+    bool  unplaced = !start_known;
+    float slice_ms = (float)move->duration / SPEED_SAMPLE_RESOLUTION;
+
+    CartesianPoint_t previous       = { 0, 0, 0 };
+    mm_per_second_t  previous_limit = 0;
+
+    cartesian_point_on_movement( move, 0.0f, &previous );
+    previous_limit = ( unplaced ) ? limit_minimum : kinematics_speed_limit( &previous );
+
+    for( uint8_t i = 1; i <= SPEED_SAMPLE_RESOLUTION; i++ )
+    {
+        CartesianPoint_t sample = { 0, 0, 0 };
+
+        cartesian_point_on_movement( move, (float)i / SPEED_SAMPLE_RESOLUTION, &sample );
+
+        mm_per_second_t limit = ( unplaced ) ? limit_minimum : kinematics_speed_limit( &sample );
+
+        // microns-per-millisecond is millimeters-per-second
+        float speed = cartesian_distance_between( &previous, &sample ) / slice_ms;
+
+        if( speed >= MIN( limit, previous_limit ) )
+        {
+            return false;
+        }
+
+        memcpy( &previous, &sample, sizeof( CartesianPoint_t ) );
+        previous_limit = limit;
+    }
+
+    return true;
+}
+
+/* -------------------------------------------------------------------------- */
+
+// Solve the IK for a point which is already in the mechanism's rotated frame
+PRIVATE KinematicsSolution_t
+kinematics_solve( CartesianPoint_t input, JointAngles_t *output )
+{
     // Limit attempts at out-of-bounds positions
     kinematics_clamp_volume( &input );
 
@@ -238,6 +391,89 @@ kinematics_angle_to_point( JointAngles_t input, CartesianPoint_t *output )
 
 /* -------------------------------------------------------------------------- */
 
+/*
+ * The largest joint rate per unit effector speed at a point is the largest row norm of the Jacobian.
+ * Estimate it by finite differences, probing towards the middle of the volume so the probes aren't clamped.
+ */
+
+PRIVATE mm_per_second_t
+kinematics_calculate_speed_limit( CartesianPoint_t point )
+{
+    JointAngles_t base = { 0 };
+
+    if( kinematics_solve( point, &base ) != SOLUTION_VALID )
+    {
+        return 0;
+    }
+
+    int32_t probe_x = ( point.x > 0 ) ? -SPEED_GRID_PROBE : SPEED_GRID_PROBE;
+    int32_t probe_y = ( point.y > 0 ) ? -SPEED_GRID_PROBE : SPEED_GRID_PROBE;
+    int32_t probe_z = ( point.z > ( z_min + z_max ) / 2 ) ? -SPEED_GRID_PROBE : SPEED_GRID_PROBE;
+
+    CartesianPoint_t probes[3] = {
+        { point.x + probe_x, point.y, point.z },
+        { point.x, point.y + probe_y, point.z },
+        { point.x, point.y, point.z + probe_z },
+    };
+
+    // Sum of squared joint deltas for each servo, in degrees per mm of travel
+    float gain_squared[3] = { 0.0f, 0.0f, 0.0f };
+
+    for( uint8_t i = 0; i < 3; i++ )
+    {
+        JointAngles_t probed = { 0 };
+
+        if( kinematics_solve( probes[i], &probed ) != SOLUTION_VALID )
+        {
+            return 0;
+        }
+
+        gain_squared[0] += ( probed.a1 - base.a1 ) * ( probed.a1 - base.a1 );
+        gain_squared[1] += ( probed.a2 - base.a2 ) * ( probed.a2 - base.a2 );
+        gain_squared[2] += ( probed.a3 - base.a3 ) * ( probed.a3 - base.a3 );
+    }
+
+    float gain = sqrtf( MAX( gain_squared[0], MAX( gain_squared[1], gain_squared[2] ) ) ) / MICRONS_TO_MM( (float)SPEED_GRID_PROBE );
+
+    if( gain <= 0.0f )
+    {
+        return EFFECTOR_SPEED_LIMIT;
+    }
+
+    return MIN( ( mm_per_second_t )( SERVO_SPEED_LIMIT / gain ), EFFECTOR_SPEED_LIMIT );
+}
+
+/* -------------------------------------------------------------------------- */
+
+PRIVATE void
+kinematics_build_speed_grid( void )
+{
+    speed_limit_minimum = EFFECTOR_SPEED_LIMIT;
+
+    for( uint8_t z = 0; z < SPEED_GRID_Z_POINTS; z++ )
+    {
+        for( uint8_t y = 0; y < SPEED_GRID_XY_POINTS; y++ )
+        {
+            for( uint8_t x = 0; x < SPEED_GRID_XY_POINTS; x++ )
+            {
+                CartesianPoint_t point = {
+                    .x = ( x * SPEED_GRID_XY_STEP ) - radius,
+                    .y = ( y * SPEED_GRID_XY_STEP ) - radius,
+                    .z = ( z * SPEED_GRID_Z_STEP ) + z_min,
+                };
+
+                // Corners of the square fall outside the cylinder, and are evaluated at the clamped position
+                kinematics_clamp_volume( &point );
+
+                speed_limit_grid[z][y][x] = kinematics_calculate_speed_limit( point );
+                speed_limit_minimum       = MIN( speed_limit_minimum, speed_limit_grid[z][y][x] );
+            }
+        }
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+
 // helper functions, calculates angle theta1 (for YZ-pane)
 PRIVATE KinematicsSolution_t
 delta_angle_plane_calc( float x0, float y0, float z0, float *theta )
@@ -27,4 +27,22 @@ kinematics_angle_to_point( JointAngles_t input, CartesianPoint_t *output );
 
 /* -------------------------------------------------------------------------- */
 
+// Local effector speed limit at a point, derived from the delta Jacobian
+PUBLIC mm_per_second_t
+kinematics_speed_limit( CartesianPoint_t *point );
+
+// Slowest speed limit anywhere in the work volume
+PUBLIC mm_per_second_t
+kinematics_speed_limit_minimum( void );
+
+// True when every part of a resolved move is under the local speed limit
+PUBLIC bool
+kinematics_move_is_feasible( Movement_t *move, bool start_known );
+
+// Longest straight line from a point to anywhere in the work volume, in microns
+PUBLIC float
+kinematics_volume_reach( CartesianPoint_t *point );
+
+/* -------------------------------------------------------------------------- */
+
 #endif /* KINEMATICS_H */
@@ -205,6 +205,8 @@ led_interpolator_process( void )
 {
     LEDPlanner_t *me = &planner;
 
+    STATE_PROFILE_BEGIN;
+
     switch( me->currentState )
     {
         case ANIMATION_OFF:
@@ -331,6 +333,8 @@ led_interpolator_process( void )
             STATE_END
             break;
     }
+
+    STATE_PROFILE_END( led_interpolator_process, "led", 0 );
 }
 
 /* -------------------------------------------------------------------------- */
@@ -0,0 +1,231 @@
+/* ----- System Includes ---------------------------------------------------- */
+
+#include <string.h>
+
+/* ----- Local Includes ----------------------------------------------------- */
+
+#include "loop_monitor.h"
+
+#include "app_times.h"
+#include "hal_system_speed.h"
+
+/* ----- Defines ------------------------------------------------------------ */
+
+// Log-linear histogram of loop periods in cycles. Each doubling is split into
+// four buckets, starting at 2^LOOP_HISTOGRAM_MIN_SHIFT cycles.
+#define LOOP_HISTOGRAM_MIN_SHIFT 6U
+#define LOOP_HISTOGRAM_SUB_BITS  2U
+#define LOOP_HISTOGRAM_OCTAVES   22U
+#define LOOP_HISTOGRAM_BUCKETS   ( LOOP_HISTOGRAM_OCTAVES << LOOP_HISTOGRAM_SUB_BITS )
+
+typedef struct
+{
+    uint32_t last_pass;
+    uint32_t cycles_per_us;
+
+    uint32_t warning_cycles;
+    uint32_t limit_cycles;
+
+    volatile bool reset_pending;
+
+    uint32_t passes;
+    uint32_t min_cycles;
+    uint32_t max_cycles;
+    uint32_t over_warning;
+    uint32_t over_limit;
+    uint32_t histogram[LOOP_HISTOGRAM_BUCKETS];
+} LoopMonitor_t;
+
+/* ----- Private Variables -------------------------------------------------- */
+
+PRIVATE LoopMonitor_t loop_monitor;
+
+PRIVATE void     loop_monitor_clear( LoopMonitor_t *me );
+PRIVATE uint8_t  loop_monitor_bucket( uint32_t cycles );
+PRIVATE uint32_t loop_monitor_bucket_limit( uint8_t bucket );
+PRIVATE uint16_t loop_monitor_percentile( LoopMonitor_t *me, uint8_t percent );
+PRIVATE uint16_t loop_monitor_to_us( LoopMonitor_t *me, uint32_t cycles );
+
+/* ----- Public Functions --------------------------------------------------- */
+
+PUBLIC void
+loop_monitor_init( void )
+{
+    LoopMonitor_t *me = &loop_monitor;
+
+    memset( me, 0, sizeof( LoopMonitor_t ) );
+    me->cycles_per_us = hal_system_speed_get_speed() / 1000000U;
+
+    loop_monitor_set_budgets( LOOP_BUDGET_WARNING_US, LOOP_BUDGET_LIMIT_US );
+    loop_monitor_clear( me );
+}
+
+/* -------------------------------------------------------------------------- */
+
+PUBLIC void
+loop_monitor_tick( void )
+{
+    LoopMonitor_t *me  = &loop_monitor;
+    uint32_t       now = CYCLE_COUNT();
+
+    if( me->reset_pending )
+    {
+        loop_monitor_clear( me );
+        me->last_pass = now;
+        return;
+    }
+
+    // The first pass after a reset only marks the start of the next period
+    if( me->last_pass == 0 )
+    {
+        me->last_pass = now;
+        return;
+    }
+
+    uint32_t period = now - me->last_pass;
+    me->last_pass   = now;
+
+    me->passes++;
+    me->histogram[loop_monitor_bucket( period )]++;
+
+    if( period < me->min_cycles )
+    {
+        me->min_cycles = period;
+    }
+
+    if( period > me->max_cycles )
+    {
+        me->max_cycles = period;
+    }
+
+    if( period > me->warning_cycles )
+    {
+        me->over_warning++;
+    }
+
+    if( period > me->limit_cycles )
+    {
+        me->over_limit++;
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+
+PUBLIC void
+loop_monitor_set_budgets( uint16_t warning_us, uint16_t limit_us )
+{
+    LoopMonitor_t *me = &loop_monitor;
+
+    me->warning_cycles = warning_us * me->cycles_per_us;
+    me->limit_cycles   = limit_us * me->cycles_per_us;
+}
+
+/* -------------------------------------------------------------------------- */
+
+PUBLIC void
+loop_monitor_reset( void )
+{
+    LoopMonitor_t *me = &loop_monitor;
+
+    me->reset_pending = true;
+}
+
+/* -------------------------------------------------------------------------- */
+
+PUBLIC void
+loop_monitor_get_stats( LoopStats_t *stats )
+{
+    LoopMonitor_t *me = &loop_monitor;
+
+    stats->passes       = me->passes;
+    stats->min_us       = me->passes ? loop_monitor_to_us( me, me->min_cycles ) : 0;
+    stats->p50_us       = loop_monitor_percentile( me, 50 );
+    stats->p99_us       = loop_monitor_percentile( me, 99 );
+    stats->max_us       = loop_monitor_to_us( me, me->max_cycles );
+    stats->over_warning = me->over_warning;
+    stats->over_limit   = me->over_limit;
+}
+
+/* ----- Private Functions -------------------------------------------------- */
+
+PRIVATE void
+loop_monitor_clear( LoopMonitor_t *me )
+{
+    me->passes       = 0;
+    me->min_cycles   = UINT32_MAX;
+    me->max_cycles   = 0;
+    me->over_warning = 0;
+    me->over_limit   = 0;
+    memset( &me->histogram, 0, sizeof( me->histogram ) );
+
+    me->reset_pending = false;
+}
+
+/* -------------------------------------------------------------------------- */
+
+PRIVATE uint8_t
+loop_monitor_bucket( uint32_t cycles )
+{
+    cycles = MAX( cycles, 1U << LOOP_HISTOGRAM_MIN_SHIFT );
+
+    // The leading bit picks the doubling, and the bits below it pick the bucket within it
+    uint32_t octave = 31U - __builtin_clz( cycles );
+    uint32_t sub    = ( cycles >> ( octave - LOOP_HISTOGRAM_SUB_BITS ) ) & ( ( 1U << LOOP_HISTOGRAM_SUB_BITS ) - 1U );
+    uint32_t bucket = ( ( octave - LOOP_HISTOGRAM_MIN_SHIFT ) << LOOP_HISTOGRAM_SUB_BITS ) + sub;
+
+    return MIN( bucket, LOOP_HISTOGRAM_BUCKETS - 1U );
+}
+
+/* -------------------------------------------------------------------------- */
+
+// Largest period that lands in a bucket, in cycles
+PRIVATE uint32_t
+loop_monitor_bucket_limit( uint8_t bucket )
+{
+    uint32_t octave = ( bucket >> LOOP_HISTOGRAM_SUB_BITS ) + LOOP_HISTOGRAM_MIN_SHIFT;
+    uint32_t sub    = bucket & ( ( 1U << LOOP_HISTOGRAM_SUB_BITS ) - 1U );
+
+    return ( ( ( 1U << LOOP_HISTOGRAM_SUB_BITS ) + sub + 1U ) << ( octave - LOOP_HISTOGRAM_SUB_BITS ) ) - 1U;
+}
+
+/* -------------------------------------------------------------------------- */
+
+PRIVATE uint16_t
+loop_monitor_percentile( LoopMonitor_t *me, uint8_t percent )
+{
+    if( !me->passes )
+    {
+        return 0;
+    }
+
+    uint32_t target = ( ( (uint64_t)me->passes * percent ) + 99U ) / 100U;
+    uint32_t seen   = 0;
+
+    for( uint8_t bucket = 0; bucket < LOOP_HISTOGRAM_BUCKETS; bucket++ )
+    {
+        seen += me->histogram[bucket];
+
+        if( seen >= target )
+        {
+            // Report the top of the bucket, but never beyond what was actually seen
+            return loop_monitor_to_us( me, MIN( loop_monitor_bucket_limit( bucket ), me->max_cycles ) );
+        }
+    }
+
+    return loop_monitor_to_us( me, me->max_cycles );
+}
+
+/* -------------------------------------------------------------------------- */
+
+PRIVATE uint16_t
+loop_monitor_to_us( LoopMonitor_t *me, uint32_t cycles )
+{
+    if( !me->cycles_per_us )
+    {
+        return 0;
+    }
+
+    return MIN( cycles / me->cycles_per_us, UINT16_MAX );
+}
+
+/* ----- End ---------------------------------------------------------------- */
@@ -0,0 +1,61 @@
+#ifndef LOOP_MONITOR_H
+#define LOOP_MONITOR_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ----- System Includes ---------------------------------------------------- */
+
+/* ----- Local Includes ----------------------------------------------------- */
+
+#include "global.h"
+
+/* ----- Types -------------------------------------------------------------- */
+
+typedef struct
+{
+    uint32_t passes;
+    uint16_t min_us;
+    uint16_t p50_us;    // percentiles are resolved to within ~20%
+    uint16_t p99_us;
+    uint16_t max_us;
+    uint32_t over_warning;    // passes longer than the warning budget
+    uint32_t over_limit;      // passes longer than the limit budget
+} LoopStats_t;
+
+/* -------------------------------------------------------------------------- */
+
+PUBLIC void
+loop_monitor_init( void );
+
+/* -------------------------------------------------------------------------- */
+
+// Call once per superloop pass, the period is measured between calls
+PUBLIC void
+loop_monitor_tick( void );
+
+/* -------------------------------------------------------------------------- */
+
+// Passes longer than these count against the budgets, in microseconds
+PUBLIC void
+loop_monitor_set_budgets( uint16_t warning_us, uint16_t limit_us );
+
+/* -------------------------------------------------------------------------- */
+
+// Safe to call from interrupts, the statistics are cleared on the next pass
+PUBLIC void
+loop_monitor_reset( void );
+
+/* -------------------------------------------------------------------------- */
+
+PUBLIC void
+loop_monitor_get_stats( LoopStats_t *stats );
+
+/* ----- End ---------------------------------------------------------------- */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LOOP_MONITOR_H */
@@ -24,6 +24,29 @@ cartesian_move_speed( Movement_t *movement )
     return cartesian_move_distance( movement ) / movement->duration;
 }
 
+#ifdef EXPANSION_SERVO
+
+// Angular speed of the expansion axis between two angles (degrees) over a duration (ms)
+PUBLIC degrees_per_second_t
+rotary_move_speed( float start_angle, float end_angle, uint16_t duration )
+{
+    if( !duration )
+    {
+        return 0;
+    }
+
+    return ( degrees_per_second_t )( fabsf( end_angle - start_angle ) * 1000.0f / duration );
+}
+
+// Linear interpolation of the expansion axis angle, 0.0f to 1.0f along the move
+PUBLIC float
+rotary_point_on_line( float start_angle, float end_angle, float pos_weight )
+{
+    return start_angle + ( ( end_angle - start_angle ) * pos_weight );
+}
+
+#endif
+
 // Input speed is in centimeters/second
 // Distance in microns
 // Return the duration in milliseconds (round down)
@@ -149,6 +172,32 @@ int32_t cartesian_distance_between( CartesianPoint_t *a, CartesianPoint_t *b )
 
 /* -------------------------------------------------------------------------- */
 
+// Sample a movement with the interpolator matching its type, 0.0f to 1.0f along the move
+PUBLIC KinematicsSolution_t
+cartesian_point_on_movement( Movement_t *movement, float pos_weight, CartesianPoint_t *output )
+{
+    switch( movement->type )
+    {
+        case _POINT_TRANSIT:
+        case _LINE:
+            return cartesian_point_on_line( movement->points, movement->num_pts, pos_weight, output );
+
+        case _CATMULL_SPLINE:
+            return cartesian_point_on_catmull_spline( movement->points, movement->num_pts, pos_weight, output );
+
+        case _BEZIER_QUADRATIC:
+            return cartesian_point_on_quadratic_bezier( movement->points, movement->num_pts, pos_weight, output );
+
+        case _BEZIER_CUBIC:
+            return cartesian_point_on_cubic_bezier( movement->points, movement->num_pts, pos_weight, output );
+
+        default:
+            return SOLUTION_ERROR;
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+
 // Calculate the control points for a cubic bezier curve which allows for acceleration shaping of a linear move
 // Accepts a line based movement, and mutates it into a cubic bezier
 // Should be called BEFORE sending the movement to the queue
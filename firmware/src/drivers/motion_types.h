@@ -92,10 +92,15 @@ typedef struct
     uint16_t          duration;                         // execution time in milliseconds
     uint16_t          num_pts;                          // number of used elements in points array
     CartesianPoint_t  points[MOVEMENT_POINTS_COUNT];    // array of 3d points
+#ifdef EXPANSION_SERVO
+    float             rotary[2];                        // expansion axis start/end angle in degrees
+    bool              rotary_enabled;                   // expansion axis is interpolated alongside the path
+#endif
 } Movement_t;
 
 typedef uint32_t mm_per_second_t;
 typedef uint32_t micron_per_millisecond_t;
+typedef uint32_t degrees_per_second_t;
 
 /* ----- Functions ---------------------------------------------------------- */
 
@@ -105,6 +110,14 @@ cartesian_move_speed( Movement_t *movement );
 PUBLIC int32_t
 cartesian_move_distance( Movement_t *movement );
 
+#ifdef EXPANSION_SERVO
+PUBLIC degrees_per_second_t
+rotary_move_speed( float start_angle, float end_angle, uint16_t duration );
+
+PUBLIC float
+rotary_point_on_line( float start_angle, float end_angle, float pos_weight );
+#endif
+
 PUBLIC void
 cartesian_point_rotate_around_z( CartesianPoint_t *a, float degrees );
 
@@ -120,6 +133,9 @@ cartesian_duration_for_speed( CartesianPoint_t *a, CartesianPoint_t *b, mm_per_s
 PUBLIC KinematicsSolution_t
 cartesian_plan_smoothed_line( Movement_t *movement, float start_weight, float end_weight );
 
+PUBLIC KinematicsSolution_t
+cartesian_point_on_movement( Movement_t *movement, float pos_weight, CartesianPoint_t *output );
+
 PUBLIC KinematicsSolution_t
 cartesian_point_on_line( CartesianPoint_t *p, size_t points, float pos_weight, CartesianPoint_t *output );
 
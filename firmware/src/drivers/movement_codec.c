@@ -0,0 +1,241 @@
+/* ----- System Includes ---------------------------------------------------- */
+
+#include <string.h>
+
+/* ----- Local Includes ----------------------------------------------------- */
+
+#include "movement_codec.h"
+
+/* ----- Private Functions -------------------------------------------------- */
+
+PRIVATE bool
+movement_read_varint( const uint8_t *data, uint16_t length, uint16_t *offset, uint32_t *value );
+
+PRIVATE bool
+movement_read_sint( const uint8_t *data, uint16_t length, uint16_t *offset, int32_t *value );
+
+/* ----- Public Functions --------------------------------------------------- */
+
+PUBLIC void
+movement_decoder_reset( MovementDecoder_t *me )
+{
+    memset( me, 0, sizeof( MovementDecoder_t ) );
+}
+
+/* -------------------------------------------------------------------------- */
+
+PUBLIC MovementDecodeResult_t
+movement_decoder_begin( MovementDecoder_t *me, const uint8_t *data, uint16_t length, uint16_t *offset )
+{
+    if( length < *offset + 2U )
+    {
+        return MOVEMENT_DECODE_MALFORMED;
+    }
+
+    uint8_t version  = data[*offset];
+    uint8_t sequence = data[*offset + 1U];
+    uint8_t step     = sequence - me->last_sequence;
+    uint8_t expected = ( me->last_sequence == UINT8_MAX ) ? 1U : me->last_sequence + 1U;
+
+    if( ( version & 0x0FU ) != MOVEMENT_COMPACT_VERSION )
+    {
+        return MOVEMENT_DECODE_VERSION;
+    }
+
+    // Packets are pipelined, so a retry can land after later packets, reset packets included
+    if( me->synced && ( step == 0 || step >= 0x80U ) )
+    {
+        return MOVEMENT_DECODE_DUPLICATE;
+    }
+
+    if( version & MOVEMENT_COMPACT_FLAG_RESET )
+    {
+        movement_decoder_reset( me );
+    }
+    else if( !me->synced )
+    {
+        // Deltas can't be followed without knowing where the stream started
+        return MOVEMENT_DECODE_UNSYNCED;
+    }
+    else if( sequence != expected )
+    {
+        // A packet went missing, the deltas after it can't be followed
+        me->synced = false;
+        return MOVEMENT_DECODE_UNSYNCED;
+    }
+
+    me->synced        = true;
+    me->last_sequence = sequence;
+    *offset += 2U;
+
+    return MOVEMENT_DECODE_OK;
+}
+
+/* -------------------------------------------------------------------------- */
+
+PUBLIC MovementDecodeResult_t
+movement_decode( MovementDecoder_t *me, const uint8_t *data, uint16_t length, uint16_t *offset, Movement_t *move )
+{
+    uint16_t pos = *offset;
+
+    // Later deltas would start from the wrong place after a bad move, so wait for a reset
+    me->synced = false;
+
+    if( pos >= length )
+    {
+        return MOVEMENT_DECODE_MALFORMED;
+    }
+
+    uint8_t  header     = data[pos++];
+    uint32_t identifier = ( me->last_id + 1U ) & UINT16_MAX;
+    uint32_t duration   = 0;
+
+    if( ( header & MOVEMENT_COMPACT_TYPE_MASK ) > _BEZIER_CUBIC )
+    {
+        return MOVEMENT_DECODE_MALFORMED;
+    }
+
+    if( !( header & MOVEMENT_COMPACT_NEXT_ID ) && !movement_read_varint( data, length, &pos, &identifier ) )
+    {
+        return MOVEMENT_DECODE_MALFORMED;
+    }
+
+    if( !movement_read_varint( data, length, &pos, &duration ) || identifier > UINT16_MAX || duration > UINT16_MAX )
+    {
+        return MOVEMENT_DECODE_MALFORMED;
+    }
+
+    move->type       = (MotionAdjective_t)( header & MOVEMENT_COMPACT_TYPE_MASK );
+    move->ref        = ( header & MOVEMENT_COMPACT_RELATIVE ) ? _POS_RELATIVE : _POS_ABSOLUTE;
+    move->identifier = identifier;
+    move->duration   = duration;
+    move->num_pts    = ( ( header >> MOVEMENT_COMPACT_PTS_SHIFT ) & MOVEMENT_COMPACT_PTS_MASK ) + 1U;
+
+    // Each point is a step from the one before, starting at the previous endpoint
+    CartesianPoint_t point = me->last_point;
+    uint8_t          first = 0;
+
+    if( header & MOVEMENT_COMPACT_CHAINED )
+    {
+        move->points[0] = point;
+        first           = 1;
+    }
+
+    for( uint8_t i = first; i < move->num_pts; i++ )
+    {
+        int32_t dx, dy, dz;
+
+        if( !movement_read_sint( data, length, &pos, &dx )
+            || !movement_read_sint( data, length, &pos, &dy )
+            || !movement_read_sint( data, length, &pos, &dz ) )
+        {
+            return MOVEMENT_DECODE_MALFORMED;
+        }
+
+        point.x += dx;
+        point.y += dy;
+        point.z += dz;
+
+        move->points[i] = point;
+    }
+
+    // Unused points are zeroed, as they are when the full structure is sent
+    for( uint8_t i = move->num_pts; i < MOVEMENT_POINTS_COUNT; i++ )
+    {
+        memset( &move->points[i], 0, sizeof( CartesianPoint_t ) );
+    }
+
+#ifdef EXPANSION_SERVO
+    // Moves for the expansion axis are only sent in the full format
+    move->rotary_enabled = false;
+#endif
+
+    me->last_point = point;
+    me->last_id    = identifier;
+    me->synced     = true;
+    *offset        = pos;
+
+    return MOVEMENT_DECODE_OK;
+}
+
+/* -------------------------------------------------------------------------- */
+
+PUBLIC MovementDecodeResult_t
+movement_decode_fade( const uint8_t *data, uint16_t length, uint16_t *offset, Fade_t *fade )
+{
+    uint16_t pos = *offset;
+
+    if( length < pos + 6U )
+    {
+        return MOVEMENT_DECODE_MALFORMED;
+    }
+
+    uint8_t type    = data[pos + 4U];
+    uint8_t num_pts = data[pos + 5U];
+
+    if( type > _LINEAR_RAMP || num_pts == 0 || num_pts > COLOUR_SETPOINT_COUNT
+        || length < pos + 6U + ( num_pts * sizeof( HSIColour_t ) ) )
+    {
+        return MOVEMENT_DECODE_MALFORMED;
+    }
+
+    memset( fade, 0, sizeof( Fade_t ) );
+    fade->identifier = data[pos] | ( data[pos + 1U] << 8 );
+    fade->duration   = data[pos + 2U] | ( data[pos + 3U] << 8 );
+    fade->type       = (FadeAdjective_t)type;
+    fade->num_pts    = num_pts;
+    pos += 6U;
+
+    // Both ends are little-endian IEEE floats, so the colours copy straight across
+    memcpy( fade->input_colours, &data[pos], num_pts * sizeof( HSIColour_t ) );
+    *offset = pos + ( num_pts * sizeof( HSIColour_t ) );
+
+    return MOVEMENT_DECODE_OK;
+}
+
+/* ----- Private Functions -------------------------------------------------- */
+
+PRIVATE bool
+movement_read_varint( const uint8_t *data, uint16_t length, uint16_t *offset, uint32_t *value )
+{
+    uint32_t result = 0;
+
+    for( uint8_t shift = 0; shift < 35U; shift += 7U )
+    {
+        if( *offset >= length )
+        {
+            return false;
+        }
+
+        uint8_t byte = data[( *offset )++];
+        result |= (uint32_t)( byte & 0x7FU ) << shift;
+
+        if( !( byte & 0x80U ) )
+        {
+            *value = result;
+            return true;
+        }
+    }
+
+    // More than five bytes can't be a 32-bit value
+    return false;
+}
+
+/* -------------------------------------------------------------------------- */
+
+PRIVATE bool
+movement_read_sint( const uint8_t *data, uint16_t length, uint16_t *offset, int32_t *value )
+{
+    uint32_t zigzag = 0;
+
+    if( !movement_read_varint( data, length, offset, &zigzag ) )
+    {
+        return false;
+    }
+
+    // Zig-zag maps 0, -1, 1, -2... to 0, 1, 2, 3... so small steps either way stay short
+    *value = (int32_t)( zigzag >> 1 ) ^ -(int32_t)( zigzag & 1U );
+    return true;
+}
+
+/* ----- End ---------------------------------------------------------------- */
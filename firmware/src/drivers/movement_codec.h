@@ -0,0 +1,125 @@
+#ifndef MOVEMENT_CODEC_H
+#define MOVEMENT_CODEC_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ----- System Includes ---------------------------------------------------- */
+
+/* ----- Local Includes ----------------------------------------------------- */
+
+#include "global.h"
+#include "led_types.h"
+#include "motion_types.h"
+
+/* ----- Defines ------------------------------------------------------------ */
+
+/*  Compact movement wire format, version 1. All multi-byte integers are
+ *  LEB128 varints, signed values are zig-zag encoded first.
+ *
+ *  Packet header
+ *      u8      version in the low nibble, MOVEMENT_COMPACT_FLAG_RESET
+ *      u8      sequence number, incremented for every packet. Zero is
+ *              skipped, so it can stand for no packet at all.
+ *
+ *  Each move
+ *      u8      type (bits 0-2), reference (bit 3), points - 1 (bits 4-5),
+ *              MOVEMENT_COMPACT_CHAINED (bit 6), MOVEMENT_COMPACT_NEXT_ID (bit 7)
+ *      varint  identifier, omitted with MOVEMENT_COMPACT_NEXT_ID
+ *      varint  duration in milliseconds
+ *      3x sint x, y, z delta in microns from the previous point, for each point.
+ *              The first point is omitted with MOVEMENT_COMPACT_CHAINED.
+ *
+ *  The previous point carries over from the end of the previous move, so
+ *  both ends of the link have to see every packet. A reset packet starts
+ *  again from the origin and identifier zero.
+ *
+ *  A batch packet uses the same header and sequence numbers, followed by
+ *      u8      number of moves, then each move as above
+ *      u8      number of fades, may be left off when there are none
+ *
+ *  A lighting batch is only the fade count and fades. Fades don't depend on
+ *  earlier packets, so it has no header and can be sent alongside the moves.
+ *
+ *  Each fade
+ *      u16     identifier
+ *      u16     duration in milliseconds
+ *      u8      type
+ *      u8      number of colours
+ *      3x f32  hue, saturation and intensity, for each colour
+ */
+
+#define MOVEMENT_COMPACT_VERSION    1U
+#define MOVEMENT_COMPACT_FLAG_RESET 0x80U
+
+#define MOVEMENT_COMPACT_TYPE_MASK  0x07U
+#define MOVEMENT_COMPACT_RELATIVE   0x08U
+#define MOVEMENT_COMPACT_PTS_SHIFT  4U
+#define MOVEMENT_COMPACT_PTS_MASK   0x03U
+#define MOVEMENT_COMPACT_CHAINED    0x40U    // first point is the previous endpoint
+#define MOVEMENT_COMPACT_NEXT_ID    0x80U    // identifier follows on from the previous move
+
+// Worst case, a cubic with every value needing a full varint
+#define MOVEMENT_COMPACT_MAX_BYTES ( 2U + 1U + 3U + 3U + ( MOVEMENT_POINTS_COUNT * 3U * 5U ) )
+
+// A batch has to fit in a single Electric UI payload
+#define MOVEMENT_BATCH_MAX_BYTES 120U
+#define MOVEMENT_BATCH_MAX_MOVES 32U
+#define MOVEMENT_BATCH_MAX_FADES 8U
+
+typedef enum
+{
+    MOVEMENT_DECODE_OK = 0,
+    MOVEMENT_DECODE_DUPLICATE,    // the packet was already decoded, likely a retransmission
+    MOVEMENT_DECODE_VERSION,      // unsupported format version
+    MOVEMENT_DECODE_UNSYNCED,     // no reset packet since boot, so the deltas have no starting point
+    MOVEMENT_DECODE_MALFORMED,    // truncated, or a value out of range
+} MovementDecodeResult_t;
+
+typedef struct
+{
+    CartesianPoint_t last_point;    // endpoint of the previous move
+    uint16_t         last_id;
+    uint8_t          last_sequence;
+    bool             synced;        // a packet has been decoded since the last reset
+} MovementDecoder_t;
+
+/* ----- Public Functions --------------------------------------------------- */
+
+PUBLIC void
+movement_decoder_reset( MovementDecoder_t *me );
+
+/* -------------------------------------------------------------------------- */
+
+/** Check the packet header and step the offset past it. A packet at or
+ *  behind the last sequence number is a retry and should be ignored, one
+ *  which skips ahead leaves the decoder unsynced until the next reset. */
+
+PUBLIC MovementDecodeResult_t
+movement_decoder_begin( MovementDecoder_t *me, const uint8_t *data, uint16_t length, uint16_t *offset );
+
+/* -------------------------------------------------------------------------- */
+
+/** Expand the move at the offset into a Movement_t, and step the offset past
+ *  it. The decoder only moves on when the whole move was valid, a malformed
+ *  move leaves it unsynced until the next reset packet. */
+
+PUBLIC MovementDecodeResult_t
+movement_decode( MovementDecoder_t *me, const uint8_t *data, uint16_t length, uint16_t *offset, Movement_t *move );
+
+/* -------------------------------------------------------------------------- */
+
+/** Read a fade from a batch at the offset, and step the offset past it. Fades
+ *  are sent whole, so they don't touch the decoder state. */
+
+PUBLIC MovementDecodeResult_t
+movement_decode_fade( const uint8_t *data, uint16_t length, uint16_t *offset, Fade_t *fade );
+
+/* ----- End ---------------------------------------------------------------- */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MOVEMENT_CODEC_H */
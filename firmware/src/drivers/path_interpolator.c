@@ -16,6 +16,8 @@
 #include "hal_systick.h"
 
 #include "clearpath.h"
+#include "input_shaper.h"
+#include "servo_lag.h"
 #include "user_interface.h"
 #include "kinematics.h"
 #include "motion_types.h"
@@ -45,6 +47,9 @@ typedef struct
     float    progress_percent;         // calculated progress
 
     CartesianPoint_t effector_position;    //position of the end effector (used for relative moves)
+#ifdef EXPANSION_SERVO
+    float expansion_angle;    // commanded angle of the expansion axis (used for relative moves)
+#endif
 
 } MotionPlanner_t;
 
@@ -54,6 +59,8 @@ PRIVATE MotionPlanner_t planner;
 
 PRIVATE void path_interpolator_premove_transforms( Movement_t *move );
 PRIVATE void path_interpolator_execute_move( Movement_t *move, float percentage );
+PRIVATE void path_interpolator_output_target( CartesianPoint_t *target );
+PRIVATE void path_interpolator_update_settings( void );
 PRIVATE void path_interpolator_calculate_percentage( uint16_t move_duration );
 
 PRIVATE void path_interpolator_notify_pathing_started( uint16_t move_id );
@@ -65,6 +72,8 @@ PUBLIC void
 path_interpolator_init( void )
 {
     memset( &planner, 0, sizeof( planner ) );
+    input_shaper_init();
+    servo_lag_init();
 }
 
 /* -------------------------------------------------------------------------- */
@@ -99,6 +108,14 @@ path_interpolator_is_ready_for_next( void )
 
 /* -------------------------------------------------------------------------- */
 
+PUBLIC bool
+path_interpolator_is_idle( void )
+{
+    return ( planner.move_a.duration == 0 ) && ( planner.move_b.duration == 0 );
+}
+
+/* -------------------------------------------------------------------------- */
+
 PUBLIC float
 path_interpolator_get_progress( void )
 {
@@ -144,6 +161,24 @@ path_interpolator_get_global_position( void )
 
 /* -------------------------------------------------------------------------- */
 
+#ifdef EXPANSION_SERVO
+PUBLIC float
+path_interpolator_get_expansion_angle( void )
+{
+    return planner.expansion_angle;
+}
+
+/* -------------------------------------------------------------------------- */
+
+PUBLIC void
+path_interpolator_set_expansion_angle( float angle )
+{
+    planner.expansion_angle = angle;
+}
+#endif
+
+/* -------------------------------------------------------------------------- */
+
 PUBLIC void
 path_interpolator_start( void )
 {
@@ -164,6 +199,11 @@ path_interpolator_stop( void )
     // Wipe out the moves currently loaded into the queue
     memset( &me->move_a, 0, sizeof( Movement_t ) );
     memset( &me->move_b, 0, sizeof( Movement_t ) );
+
+    // Don't let the shaper keep playing out the old path once stopped. It stops where the
+    // shaped output had got to, so the next move (i.e. a track retarget) starts from there
+    input_shaper_hold( &me->effector_position );
+    user_interface_set_position( me->effector_position.x, me->effector_position.y, me->effector_position.z );
 }
 
 /* -------------------------------------------------------------------------- */
@@ -174,6 +214,10 @@ path_interpolator_set_home( void )
     planner.effector_position.x = 0;
     planner.effector_position.y = 0;
     planner.effector_position.z = 0;
+#ifdef EXPANSION_SERVO
+    planner.expansion_angle = 0;
+#endif
+    input_shaper_reset( &planner.effector_position );
     user_interface_set_position( planner.effector_position.x, planner.effector_position.y, planner.effector_position.z );
 }
 
@@ -184,12 +228,20 @@ path_interpolator_process( void )
 {
     MotionPlanner_t *me = &planner;
 
+    STATE_PROFILE_BEGIN;
+
     switch( me->currentState )
     {
         case PLANNER_OFF:
             STATE_ENTRY_ACTION
             user_interface_set_pathing_status( me->currentState );
             STATE_TRANSITION_TEST
+            // Let the shaped setpoint finish converging on the final position of the last move
+            if( !input_shaper_is_settled() )
+            {
+                path_interpolator_output_target( &me->effector_position );
+            }
+
             if( planner.enable )
             {
                 if( me->move_a.duration )
@@ -211,6 +263,7 @@ path_interpolator_process( void )
             path_interpolator_notify_pathing_started( me->move_a.identifier );
 
             path_interpolator_premove_transforms( &me->move_a );
+            path_interpolator_update_settings();
             me->movement_started      = hal_systick_get_ms();
             me->movement_est_complete = me->movement_started + me->move_a.duration;
             me->progress_percent      = 0;
@@ -250,6 +303,7 @@ path_interpolator_process( void )
             path_interpolator_notify_pathing_started( me->move_b.identifier );
 
             path_interpolator_premove_transforms( &me->move_b );
+            path_interpolator_update_settings();
             me->movement_started      = hal_systick_get_ms();
             me->movement_est_complete = me->movement_started + me->move_b.duration;
             me->progress_percent      = 0;
@@ -283,6 +337,8 @@ path_interpolator_process( void )
             STATE_END
             break;
     }
+
+    STATE_PROFILE_END( path_interpolator_process, "path", 0 );
 }
 
 PRIVATE void
@@ -297,6 +353,11 @@ path_interpolator_premove_transforms( Movement_t *move )
             move->points[i].y += planner.effector_position.y;
             move->points[i].z += planner.effector_position.z;
         }
+
+#ifdef EXPANSION_SERVO
+        move->rotary[0] += planner.expansion_angle;
+        move->rotary[1] += planner.expansion_angle;
+#endif
     }
 
     // A transit move is from current position to point 1, so overwrite 0 with current position,
@@ -314,54 +375,76 @@ path_interpolator_premove_transforms( Movement_t *move )
         move->points[0].x = planner.effector_position.x;
         move->points[0].y = planner.effector_position.y;
         move->points[0].z = planner.effector_position.z;
+
+#ifdef EXPANSION_SERVO
+        move->rotary[0] = planner.expansion_angle;
+#endif
     }
 }
 
 PRIVATE void
 path_interpolator_execute_move( Movement_t *move, float percentage )
 {
-    CartesianPoint_t target       = { 0, 0, 0 };    //target position in cartesian space
-    JointAngles_t    angle_target = { 0, 0, 0 };    //target motor shaft angle in degrees
+    CartesianPoint_t target = { 0, 0, 0 };    //target position in cartesian space
 
-    switch( move->type )
-    {
-        case _POINT_TRANSIT:
-            cartesian_point_on_line( move->points, move->num_pts, percentage, &target );
-            break;
+    //TODO an unknown move type should be considered a motion error
+    cartesian_point_on_movement( move, percentage, &target );
 
-        case _LINE:
-            cartesian_point_on_line( move->points, move->num_pts, percentage, &target );
-            break;
+    path_interpolator_output_target( &target );
 
-        case _CATMULL_SPLINE:
-            cartesian_point_on_catmull_spline( move->points, move->num_pts, percentage, &target );
-            break;
+#ifdef EXPANSION_SERVO
+    // The expansion axis follows the same progress value so it stays in lockstep with the path
+    if( move->rotary_enabled )
+    {
+        planner.expansion_angle = rotary_point_on_line( move->rotary[0], move->rotary[1], percentage );
+        servo_set_target_angle_raw( _CLEARPATH_4, planner.expansion_angle );
+    }
+#endif
 
-        case _BEZIER_QUADRATIC:
-            cartesian_point_on_quadratic_bezier( move->points, move->num_pts, percentage, &target );
-            break;
+    // Update the config/UI data based on these actions
+    memcpy( &planner.effector_position, &target, sizeof( CartesianPoint_t ) );
+    user_interface_set_movement_data( move->identifier, move->type, ( uint8_t )( percentage * 100 ) );
+}
 
-        case _BEZIER_CUBIC:
-            cartesian_point_on_cubic_bezier( move->points, move->num_pts, percentage, &target );
-            break;
-        default:
-            //TODO this should be considered a motion error
+PRIVATE void
+path_interpolator_output_target( CartesianPoint_t *target )
+{
+    CartesianPoint_t shaped         = { 0, 0, 0 };    //vibration-suppressed setpoint
+    JointAngles_t    angle_target   = { 0, 0, 0 };    //target motor shaft angle in degrees
+    JointAngles_t    angle_advanced = { 0, 0, 0 };    //target with servo lag compensation
 
-            break;
-    }
+    // Filter the setpoint stream so the arms don't ring at the end of fast moves
+    input_shaper_process( target, &shaped );
 
     // Calculate a motor angle solution for the cartesian position
-    kinematics_point_to_angle( target, &angle_target );
+    kinematics_point_to_angle( shaped, &angle_target );
+
+    // The servos trail the step stream at speed, so lead them by their lag
+    servo_lag_advance( &angle_target, &angle_advanced );
 
     // Ask the motors to please move there
-    servo_set_target_angle_limited( _CLEARPATH_1, angle_target.a1 );
-    servo_set_target_angle_limited( _CLEARPATH_2, angle_target.a2 );
-    servo_set_target_angle_limited( _CLEARPATH_3, angle_target.a3 );
+    servo_set_target_angle_limited( _CLEARPATH_1, angle_advanced.a1 );
+    servo_set_target_angle_limited( _CLEARPATH_2, angle_advanced.a2 );
+    servo_set_target_angle_limited( _CLEARPATH_3, angle_advanced.a3 );
 
-    // Update the config/UI data based on these actions
-    user_interface_set_position( target.x, target.y, target.z );
-    memcpy( &planner.effector_position, &target, sizeof( CartesianPoint_t ) );
-    user_interface_set_movement_data( move->identifier, move->type, ( uint8_t )( percentage * 100 ) );
+    user_interface_set_position( shaped.x, shaped.y, shaped.z );
+    user_interface_stream_position( &shaped, &angle_advanced );
+}
+
+PRIVATE void
+path_interpolator_update_settings( void )
+{
+    uint8_t type      = 0;
+    float   frequency = 0.0f;
+    float   damping   = 0.0f;
+    float   lag_ms[3] = { 0.0f, 0.0f, 0.0f };
+
+    // Settings are only applied between moves to avoid a step in the setpoint
+    user_interface_get_input_shaper( &type, &frequency, &damping );
+    input_shaper_configure( type, frequency, damping );
+
+    user_interface_get_servo_lag( lag_ms );
+    servo_lag_configure( lag_ms );
 }
 
 PRIVATE void
@@ -374,6 +457,9 @@ path_interpolator_notify_pathing_started( uint16_t move_id )
     eventPublish( (StateEvent *)barrier_ev );
 }
 
+// Sent when the raw path reaches the end of the move, not once the arm is still.
+// The shaped setpoint trails it by up to the shaper duration, and waiting for that
+// would open a gap between queued moves. PLANNER_OFF finishes driving it out.
 PRIVATE void
 path_interpolator_notify_pathing_complete( uint16_t move_id )
 {
@@ -32,6 +32,12 @@ path_interpolator_is_ready_for_next( void );
 
 /* -------------------------------------------------------------------------- */
 
+// True when no moves are loaded, so the effector is at its last commanded position
+PUBLIC bool
+path_interpolator_is_idle( void );
+
+/* -------------------------------------------------------------------------- */
+
 PUBLIC float
 path_interpolator_get_progress( void );
 
@@ -47,6 +53,18 @@ path_interpolator_get_global_position( void );
 
 /* -------------------------------------------------------------------------- */
 
+#ifdef EXPANSION_SERVO
+PUBLIC float
+path_interpolator_get_expansion_angle( void );
+
+/* -------------------------------------------------------------------------- */
+
+PUBLIC void
+path_interpolator_set_expansion_angle( float angle );
+#endif
+
+/* -------------------------------------------------------------------------- */
+
 PUBLIC void
 path_interpolator_start( void );
 
@@ -0,0 +1,388 @@
+/* ----- System Includes ---------------------------------------------------- */
+
+#include <math.h>
+#include <string.h>
+
+/* ----- Local Includes ----------------------------------------------------- */
+
+#include "resonance_test.h"
+
+#include "app_times.h"
+#include "hal_systick.h"
+#include "simple_state_machine.h"
+
+#include "clearpath.h"
+#include "kinematics.h"
+#include "user_interface.h"
+
+/* ----- Private Types ------------------------------------------------------ */
+
+typedef enum
+{
+    RESONANCE_STATE_OFF,
+    RESONANCE_STATE_SETTLE,
+    RESONANCE_STATE_MEASURE,
+    RESONANCE_STATE_ANALYSE,
+} ResonanceState_t;
+
+typedef struct
+{
+    // Running sums for a single-bin DFT of each servo's torque against the drive signal
+    float torque;
+    float torque_sin;
+    float torque_cos;
+} ResonanceCorrelation_t;
+
+typedef struct
+{
+    ResonanceState_t previousState;
+    ResonanceState_t currentState;
+    ResonanceState_t nextState;
+
+    bool             running;
+    ResonanceAxis_t  axis;
+    CartesianPoint_t centre;
+
+    uint8_t  step;            // index of the frequency being tested
+    float    frequency;       // drive frequency in Hz
+    uint32_t step_started;    // timestamp the drive sine started at
+    uint32_t last_sample;     // torque is sampled at most once per millisecond
+
+    ResonanceCorrelation_t servo[3];
+    float                  sum_sin;
+    float                  sum_cos;
+    uint32_t               samples;
+
+    float response[RESONANCE_NUM_STEPS];    // torque % per mm of drive amplitude
+} ResonanceTest_t;
+
+/* ----- Private Variables -------------------------------------------------- */
+
+PRIVATE ResonanceTest_t resonance;
+
+/* ----- Private Functions -------------------------------------------------- */
+
+PRIVATE float resonance_test_drive( ResonanceTest_t *me );
+PRIVATE void  resonance_test_output( CartesianPoint_t *target );
+PRIVATE float resonance_test_magnitude( ResonanceTest_t *me );
+PRIVATE void  resonance_test_analyse( ResonanceTest_t *me );
+
+/* ----- Public Functions --------------------------------------------------- */
+
+PUBLIC void
+resonance_test_init( void )
+{
+    memset( &resonance, 0, sizeof( resonance ) );
+}
+
+/* -------------------------------------------------------------------------- */
+
+PUBLIC void
+resonance_test_start( ResonanceAxis_t axis, CartesianPoint_t *centre )
+{
+    ResonanceTest_t *me = &resonance;
+
+    me->axis = axis;
+    memcpy( &me->centre, centre, sizeof( CartesianPoint_t ) );
+    memset( &me->response, 0, sizeof( me->response ) );
+    me->step    = 0;
+    me->running = true;
+
+    // Restart the state machine in case a previous sweep was abandoned part way through
+    STATE_INIT_INITIAL( RESONANCE_STATE_OFF );
+
+    user_interface_set_resonance_progress( axis, 0 );
+}
+
+/* -------------------------------------------------------------------------- */
+
+PUBLIC void
+resonance_test_stop( void )
+{
+    ResonanceTest_t *me = &resonance;
+
+    if( me->running )
+    {
+        me->running = false;
+        resonance_test_output( &me->centre );
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+
+PUBLIC bool
+resonance_test_is_running( void )
+{
+    ResonanceTest_t *me = &resonance;
+
+    return me->running;
+}
+
+/* -------------------------------------------------------------------------- */
+
+PUBLIC void
+resonance_test_process( void )
+{
+    ResonanceTest_t *me = &resonance;
+
+    switch( me->currentState )
+    {
+        case RESONANCE_STATE_OFF:
+            STATE_ENTRY_ACTION
+
+            STATE_TRANSITION_TEST
+
+            if( me->running )
+            {
+                STATE_NEXT( RESONANCE_STATE_SETTLE );
+            }
+
+            STATE_EXIT_ACTION
+            STATE_END
+            break;
+
+        case RESONANCE_STATE_SETTLE:
+            STATE_ENTRY_ACTION
+
+            me->frequency    = RESONANCE_START_HZ + ( me->step * RESONANCE_STEP_HZ );
+            me->step_started = hal_systick_get_ms();
+
+            STATE_TRANSITION_TEST
+
+            // Let the mechanism reach steady state before correlating against the drive signal
+            float elapsed = resonance_test_drive( me );
+
+            if( !me->running )
+            {
+                STATE_NEXT( RESONANCE_STATE_OFF );
+            }
+            else if( elapsed * me->frequency >= RESONANCE_SETTLE_CYCLES )
+            {
+                STATE_NEXT( RESONANCE_STATE_MEASURE );
+            }
+
+            STATE_EXIT_ACTION
+            STATE_END
+            break;
+
+        case RESONANCE_STATE_MEASURE:
+            STATE_ENTRY_ACTION
+
+            memset( &me->servo, 0, sizeof( me->servo ) );
+            me->sum_sin     = 0.0f;
+            me->sum_cos     = 0.0f;
+            me->samples     = 0;
+            me->last_sample = hal_systick_get_ms() - 1;
+
+            STATE_TRANSITION_TEST
+
+            float    elapsed = resonance_test_drive( me );
+            uint32_t now     = hal_systick_get_ms();
+
+            if( now != me->last_sample )
+            {
+                float phase = 2.0f * M_PI * me->frequency * elapsed;
+                float s     = sinf( phase );
+                float c     = cosf( phase );
+
+                for( ClearpathServoInstance_t servo = _CLEARPATH_1; servo <= _CLEARPATH_3; servo++ )
+                {
+                    float torque = servo_get_feedback_torque( servo );
+
+                    me->servo[servo].torque += torque;
+                    me->servo[servo].torque_sin += torque * s;
+                    me->servo[servo].torque_cos += torque * c;
+                }
+
+                me->sum_sin += s;
+                me->sum_cos += c;
+                me->samples++;
+                me->last_sample = now;
+            }
+
+            if( !me->running )
+            {
+                STATE_NEXT( RESONANCE_STATE_OFF );
+            }
+            else if( elapsed * me->frequency >= RESONANCE_SETTLE_CYCLES + RESONANCE_MEASURE_CYCLES )
+            {
+                me->response[me->step] = resonance_test_magnitude( me );
+                me->step++;
+
+                user_interface_set_resonance_progress( me->axis, ( me->step * 100U ) / RESONANCE_NUM_STEPS );
+
+                if( me->step < RESONANCE_NUM_STEPS )
+                {
+                    STATE_NEXT( RESONANCE_STATE_SETTLE );
+                }
+                else
+                {
+                    STATE_NEXT( RESONANCE_STATE_ANALYSE );
+                }
+            }
+
+            STATE_EXIT_ACTION
+            STATE_END
+            break;
+
+        case RESONANCE_STATE_ANALYSE:
+            STATE_ENTRY_ACTION
+
+            resonance_test_output( &me->centre );
+            resonance_test_analyse( me );
+
+            STATE_TRANSITION_TEST
+
+            me->running = false;
+            STATE_NEXT( RESONANCE_STATE_OFF );
+
+            STATE_EXIT_ACTION
+            STATE_END
+            break;
+    }
+}
+
+/* ----- Private Functions -------------------------------------------------- */
+
+// Move the effector along the sine for the current step, returning the seconds since the step started
+PRIVATE float
+resonance_test_drive( ResonanceTest_t *me )
+{
+    float            elapsed = ( hal_systick_get_ms() - me->step_started ) / 1000.0f;
+    float            offset  = RESONANCE_AMPLITUDE_UM * sinf( 2.0f * M_PI * me->frequency * elapsed );
+    CartesianPoint_t target  = me->centre;
+
+    switch( me->axis )
+    {
+        case RESONANCE_AXIS_X:
+            target.x += lroundf( offset );
+            break;
+        case RESONANCE_AXIS_Y:
+            target.y += lroundf( offset );
+            break;
+        case RESONANCE_AXIS_Z:
+            target.z += lroundf( offset );
+            break;
+        default:
+            break;
+    }
+
+    resonance_test_output( &target );
+
+    return elapsed;
+}
+
+/* -------------------------------------------------------------------------- */
+
+// The sweep bypasses the input shaper, as it would suppress the frequencies we want to excite
+PRIVATE void
+resonance_test_output( CartesianPoint_t *target )
+{
+    JointAngles_t angle_target = { 0, 0, 0 };
+
+    kinematics_point_to_angle( *target, &angle_target );
+
+    servo_set_target_angle_limited( _CLEARPATH_1, angle_target.a1 );
+    servo_set_target_angle_limited( _CLEARPATH_2, angle_target.a2 );
+    servo_set_target_angle_limited( _CLEARPATH_3, angle_target.a3 );
+
+    user_interface_set_position( target->x, target->y, target->z );
+}
+
+/* -------------------------------------------------------------------------- */
+
+// Torque response at the drive frequency summed across the servos, normalised to drive amplitude
+PRIVATE float
+resonance_test_magnitude( ResonanceTest_t *me )
+{
+    if( !me->samples )
+    {
+        return 0.0f;
+    }
+
+    float n         = (float)me->samples;
+    float magnitude = 0.0f;
+
+    for( ClearpathServoInstance_t servo = _CLEARPATH_1; servo <= _CLEARPATH_3; servo++ )
+    {
+        // Remove the DC torque holding the effector up, as the sample count isn't exactly whole cycles
+        float mean = me->servo[servo].torque / n;
+        float in   = me->servo[servo].torque_sin - ( mean * me->sum_sin );
+        float quad = me->servo[servo].torque_cos - ( mean * me->sum_cos );
+
+        magnitude += 2.0f * sqrtf( ( in * in ) + ( quad * quad ) ) / n;
+    }
+
+    return magnitude / ( RESONANCE_AMPLITUDE_UM / 1000.0f );
+}
+
+/* -------------------------------------------------------------------------- */
+
+// Find the peak response and estimate damping from the half-power bandwidth
+PRIVATE void
+resonance_test_analyse( ResonanceTest_t *me )
+{
+    uint8_t peak = 0;
+
+    for( uint8_t i = 1; i < RESONANCE_NUM_STEPS; i++ )
+    {
+        if( me->response[i] > me->response[peak] )
+        {
+            peak = i;
+        }
+    }
+
+    float peak_hz = RESONANCE_START_HZ + ( peak * RESONANCE_STEP_HZ );
+
+    // Parabolic interpolation between the neighbouring bins refines the peak location
+    if( peak > 0 && peak < RESONANCE_NUM_STEPS - 1 )
+    {
+        float a     = me->response[peak - 1];
+        float b     = me->response[peak];
+        float c     = me->response[peak + 1];
+        float denom = a - ( 2.0f * b ) + c;
+
+        if( fabsf( denom ) > 0.0f )
+        {
+            peak_hz += 0.5f * ( a - c ) / denom * RESONANCE_STEP_HZ;
+        }
+    }
+
+    // Walk out from the peak to the -3dB points on either side
+    float half_power = me->response[peak] * M_SQRT1_2;
+    float lower_hz   = 0.0f;
+    float upper_hz   = 0.0f;
+
+    for( int8_t i = peak; i > 0; i-- )
+    {
+        if( me->response[i - 1] < half_power )
+        {
+            float weight = ( me->response[i] - half_power ) / ( me->response[i] - me->response[i - 1] );
+            lower_hz     = RESONANCE_START_HZ + ( ( i - weight ) * RESONANCE_STEP_HZ );
+            break;
+        }
+    }
+
+    for( uint8_t i = peak; i < RESONANCE_NUM_STEPS - 1; i++ )
+    {
+        if( me->response[i + 1] < half_power )
+        {
+            float weight = ( me->response[i] - half_power ) / ( me->response[i] - me->response[i + 1] );
+            upper_hz     = RESONANCE_START_HZ + ( ( i + weight ) * RESONANCE_STEP_HZ );
+            break;
+        }
+    }
+
+    // Damping is reported as zero when the peak isn't fully inside the sweep range
+    float damping = 0.0f;
+
+    if( lower_hz > 0.0f && upper_hz > 0.0f && peak_hz > 0.0f )
+    {
+        damping = ( upper_hz - lower_hz ) / ( 2.0f * peak_hz );
+    }
+
+    user_interface_set_resonance_result( me->axis, peak_hz, damping, me->response[peak] );
+    user_interface_set_resonance_response( me->axis, me->response, RESONANCE_NUM_STEPS );
+}
+
+/* ----- End ---------------------------------------------------------------- */
@@ -0,0 +1,59 @@
+#ifndef RESONANCE_TEST_H
+#define RESONANCE_TEST_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ----- System Includes ---------------------------------------------------- */
+
+/* ----- Local Includes ----------------------------------------------------- */
+
+#include "global.h"
+#include "motion_types.h"
+
+/* ----- Types -------------------------------------------------------------- */
+
+typedef enum
+{
+    RESONANCE_AXIS_X = 0,
+    RESONANCE_AXIS_Y,
+    RESONANCE_AXIS_Z,
+    RESONANCE_AXIS_COUNT,
+} ResonanceAxis_t;
+
+/* -------------------------------------------------------------------------- */
+
+PUBLIC void
+resonance_test_init( void );
+
+/* -------------------------------------------------------------------------- */
+
+// Start a stepped-sine sweep along one axis, centred on the provided position.
+// The path interpolator must be idle, as the sweep drives the servos directly
+PUBLIC void
+resonance_test_start( ResonanceAxis_t axis, CartesianPoint_t *centre );
+
+/* -------------------------------------------------------------------------- */
+
+// Abandon a running sweep and return the servos to the centre position
+PUBLIC void
+resonance_test_stop( void );
+
+/* -------------------------------------------------------------------------- */
+
+PUBLIC bool
+resonance_test_is_running( void );
+
+/* -------------------------------------------------------------------------- */
+
+PUBLIC void
+resonance_test_process( void );
+
+/* ----- End ---------------------------------------------------------------- */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* RESONANCE_TEST_H */
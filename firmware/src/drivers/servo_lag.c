@@ -0,0 +1,93 @@
+/* ----- System Includes ---------------------------------------------------- */
+
+#include <string.h>
+
+/* ----- Local Includes ----------------------------------------------------- */
+
+#include "servo_lag.h"
+
+#include "app_times.h"
+#include "hal_systick.h"
+
+/* ----- Defines ------------------------------------------------------------ */
+
+// Larger lags are almost certainly a configuration error, and the feed-forward would amplify noise
+#define SERVO_LAG_MAX_MS 50.0f
+
+// Velocity isn't meaningful across a gap in the target stream, so restart the estimate
+#define SERVO_LAG_RESEED_MS 20U
+
+typedef struct
+{
+    float lag_ms;
+
+    // Feed-forward velocity estimation from the target stream
+    float    last_target;
+    uint32_t last_target_ms;
+    float    velocity;    // degrees per millisecond
+} ServoLag_t;
+
+/* ----- Private Variables -------------------------------------------------- */
+
+PRIVATE ServoLag_t servo_lag[3];
+
+PRIVATE float servo_lag_advance_axis( ServoLag_t *me, float target, uint32_t now );
+
+/* ----- Public Functions --------------------------------------------------- */
+
+PUBLIC void
+servo_lag_init( void )
+{
+    memset( &servo_lag, 0, sizeof( servo_lag ) );
+}
+
+/* -------------------------------------------------------------------------- */
+
+PUBLIC void
+servo_lag_configure( const float lag_ms[3] )
+{
+    for( uint8_t i = 0; i < 3; i++ )
+    {
+        servo_lag[i].lag_ms = CLAMP( lag_ms[i], 0.0f, SERVO_LAG_MAX_MS );
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+
+PUBLIC void
+servo_lag_advance( JointAngles_t *target, JointAngles_t *advanced )
+{
+    uint32_t now = hal_systick_get_ms();
+
+    advanced->a1 = servo_lag_advance_axis( &servo_lag[0], target->a1, now );
+    advanced->a2 = servo_lag_advance_axis( &servo_lag[1], target->a2, now );
+    advanced->a3 = servo_lag_advance_axis( &servo_lag[2], target->a3, now );
+}
+
+/* ----- Private Functions -------------------------------------------------- */
+
+PRIVATE float
+servo_lag_advance_axis( ServoLag_t *me, float target, uint32_t now )
+{
+    uint32_t dt = now - me->last_target_ms;
+
+    // The path is evaluated at ms resolution, so only differentiate when time has moved on
+    if( dt >= SERVO_LAG_RESEED_MS )
+    {
+        me->velocity       = 0.0f;
+        me->last_target    = target;
+        me->last_target_ms = now;
+    }
+    else if( dt > 0 )
+    {
+        me->velocity       = ( target - me->last_target ) / dt;
+        me->last_target    = target;
+        me->last_target_ms = now;
+    }
+
+    // A first-order lag trails a ramp by velocity * time constant, so lead by the same amount
+    return target + ( me->velocity * me->lag_ms );
+}
+
+
+/* ----- End ---------------------------------------------------------------- */
@@ -0,0 +1,28 @@
+#ifndef SERVO_LAG_H
+#define SERVO_LAG_H
+
+/* ----- Local Includes ----------------------------------------------------- */
+
+#include "global.h"
+#include <motion_types.h>
+
+/* ----- Public Functions --------------------------------------------------- */
+
+PUBLIC void
+servo_lag_init( void );
+
+/* -------------------------------------------------------------------------- */
+
+// Set the first-order lag time constant of each servo, in milliseconds
+PUBLIC void
+servo_lag_configure( const float lag_ms[3] );
+
+/* -------------------------------------------------------------------------- */
+
+// Add velocity feed-forward to the joint targets so the lagging servos land on the requested angles
+PUBLIC void
+servo_lag_advance( JointAngles_t *target, JointAngles_t *advanced );
+
+/* -------------------------------------------------------------------------- */
+
+#endif /* SERVO_LAG_H */
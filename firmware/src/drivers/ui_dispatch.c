@@ -0,0 +1,102 @@
+/* ----- System Includes ---------------------------------------------------- */
+
+#include <string.h>
+
+/* ----- Local Includes ----------------------------------------------------- */
+
+#include "ui_dispatch.h"
+#include "qassert.h"
+
+/* -------------------------------------------------------------------------- */
+
+DEFINE_THIS_FILE; /* Used for ASSERT checks to define __FILE__ only once */
+
+/* ----- Private Functions -------------------------------------------------- */
+
+PRIVATE uint32_t
+ui_dispatch_hash_id( const uint8_t *id );
+
+/* ----- Public Functions --------------------------------------------------- */
+
+PUBLIC void
+ui_dispatch_init( UiDispatch_t      *me,
+                  const UiHandler_t *handlers,
+                  uint8_t            num_handlers,
+                  uint32_t          *hashes,
+                  uint8_t           *slots,
+                  uint16_t           num_slots )
+{
+    REQUIRE( ( num_slots & ( num_slots - 1U ) ) == 0 );
+    REQUIRE( num_handlers * 2U <= num_slots );
+
+    me->handlers     = handlers;
+    me->hashes       = hashes;
+    me->slots        = slots;
+    me->num_handlers = num_handlers;
+    me->num_slots    = num_slots;
+
+    memset( slots, 0, num_slots );
+
+    for( uint8_t i = 0; i < num_handlers; i++ )
+    {
+        uint32_t hash = ui_dispatch_hash_id( (const uint8_t *)handlers[i].id );
+
+        for( uint16_t probe = 0; probe < num_slots; probe++ )
+        {
+            uint16_t slot = ( hash + probe ) & ( num_slots - 1U );
+
+            if( !slots[slot] )
+            {
+                slots[slot] = i + 1U;
+                hashes[i]   = hash;
+                break;
+            }
+        }
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+
+PUBLIC const UiHandler_t *
+ui_dispatch_find( UiDispatch_t *me, const uint8_t *id )
+{
+    uint32_t hash = ui_dispatch_hash_id( id );
+
+    for( uint16_t probe = 0; probe < me->num_slots; probe++ )
+    {
+        uint8_t entry = me->slots[( hash + probe ) & ( me->num_slots - 1U )];
+
+        if( !entry )
+        {
+            return NULL;
+        }
+
+        const UiHandler_t *h = &me->handlers[entry - 1U];
+
+        if( me->hashes[entry - 1U] == hash && strcmp( (const char *)id, h->id ) == 0 )
+        {
+            return h;
+        }
+    }
+
+    return NULL;
+}
+
+/* ----- Private Functions -------------------------------------------------- */
+
+// FNV-1a, short IDs rarely collide and it's a handful of cycles per character
+
+PRIVATE uint32_t
+ui_dispatch_hash_id( const uint8_t *id )
+{
+    uint32_t hash = 2166136261U;
+
+    while( *id )
+    {
+        hash = ( hash ^ *id++ ) * 16777619U;
+    }
+
+    return hash;
+}
+
+/* ----- End ---------------------------------------------------------------- */
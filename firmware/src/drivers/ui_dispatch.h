@@ -0,0 +1,58 @@
+#ifndef UI_DISPATCH_H
+#define UI_DISPATCH_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ----- System Includes ---------------------------------------------------- */
+
+/* ----- Local Includes ----------------------------------------------------- */
+
+#include "global.h"
+
+/* ----- Types -------------------------------------------------------------- */
+
+typedef struct
+{
+    const char *id;
+    void ( *handler )( uint8_t link, uint16_t length );
+} UiHandler_t;
+
+// Handler IDs hashed into an open addressed table, so an inbound write finds
+// its handler with one hash and usually a single comparison. The caller
+// provides the storage, with a power of two number of slots which is at
+// least twice the number of handlers to keep the probe chains short.
+typedef struct
+{
+    const UiHandler_t *handlers;
+    uint32_t          *hashes;        // one per handler
+    uint8_t           *slots;         // handler index + 1, zero when empty
+    uint8_t            num_handlers;
+    uint16_t           num_slots;
+} UiDispatch_t;
+
+/* ----- Public Functions --------------------------------------------------- */
+
+PUBLIC void
+ui_dispatch_init( UiDispatch_t      *me,
+                  const UiHandler_t *handlers,
+                  uint8_t            num_handlers,
+                  uint32_t          *hashes,
+                  uint8_t           *slots,
+                  uint16_t           num_slots );
+
+/* -------------------------------------------------------------------------- */
+
+/** Find the handler for a null terminated message ID, NULL when it has none. */
+
+PUBLIC const UiHandler_t *
+ui_dispatch_find( UiDispatch_t *me, const uint8_t *id );
+
+/* ----- End ---------------------------------------------------------------- */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* UI_DISPATCH_H */
@@ -1,3 +1,4 @@
+#include <electricui.h>
 #include <string.h>
 
 /* ----- Local Includes ----------------------------------------------------- */
@@ -14,14 +15,52 @@
 #include "app_times.h"
 #include "app_version.h"
 #include "event_subscribe.h"
+#include "state_profile.h"
 #include "hal_uuid.h"
 #include "hal_uart.h"
+#include "hal_system_speed.h"
+#include "hal_systick.h"
+#include "hal_isr_profile.h"
+#include "job_scheduler.h"
+#include "loop_monitor.h"
+#include "movement_codec.h"
+#include "ui_dispatch.h"
+#include "fifo.h"
 
 /* ----- Private Function Declaration --------------------------------------- */
 
 PRIVATE void
 user_interface_eui_callback( uint8_t link, eui_interface_t *interface, uint8_t message );
 
+PRIVATE void user_interface_parse_link( uint8_t link );
+PRIVATE void user_interface_tx_put( uint8_t link, uint8_t *c, uint16_t length );
+PRIVATE void user_interface_send_on_route( uint8_t route, const char *id );
+
+PRIVATE void user_interface_telemetry_init( void );
+PRIVATE void user_interface_send_telemetry( void );
+PRIVATE void user_interface_pack_position_stream( void );
+
+PRIVATE void user_interface_dispatch( uint8_t link, const uint8_t *id, uint16_t length );
+
+PRIVATE void handle_mode_request( uint8_t link, uint16_t length );
+PRIVATE void handle_route( uint8_t link, uint16_t length );
+PRIVATE void handle_move( uint8_t link, uint16_t length );
+PRIVATE void handle_move_compact( uint8_t link, uint16_t length );
+PRIVATE void handle_move_batch( uint8_t link, uint16_t length );
+PRIVATE void handle_fade( uint8_t link, uint16_t length );
+PRIVATE void handle_fade_batch( uint8_t link, uint16_t length );
+PRIVATE void handle_track_position( uint8_t link, uint16_t length );
+#ifdef EXPANSION_SERVO
+PRIVATE void handle_servo_angle( uint8_t link, uint16_t length );
+#endif
+PRIVATE void handle_manual_led( uint8_t link, uint16_t length );
+PRIVATE void handle_capture( uint8_t link, uint16_t length );
+PRIVATE void handle_loop_budget( uint8_t link, uint16_t length );
+PRIVATE void handle_position_decimation( uint8_t link, uint16_t length );
+#ifdef EVENT_TRACE
+PRIVATE void handle_trace_read( uint8_t link, uint16_t length );
+#endif
+
 PRIVATE void user_interface_tx_put_external(uint8_t *c, uint16_t length );
 PRIVATE void user_interface_eui_callback_external(uint8_t message );
 
@@ -46,14 +85,70 @@ PRIVATE void tracked_external_servo_request( void );
 
 PRIVATE void rgb_manual_led_event( void );
 PRIVATE void movement_generate_event( void );
+PRIVATE void movement_stage_event( void );
+PRIVATE void movement_compact_event( uint16_t length );
+PRIVATE void movement_batch_event( uint16_t length );
+PRIVATE void lighting_batch_event( uint16_t length );
+PRIVATE MovementDecodeResult_t
+batch_stage_fades( const uint8_t *data, uint16_t length, uint16_t *offset, StateEvent **staged, uint8_t *num_staged, uint8_t *num_fades );
+PRIVATE bool batch_commit( StateEvent **staged, uint8_t num_staged, MovementDecodeResult_t result );
 PRIVATE void lighting_generate_event( void );
+PRIVATE void queue_credit_consume( uint8_t moves, uint8_t fades );
+PRIVATE void queue_credit_update( bool force );
 PRIVATE void sync_begin_queues( void );
 PRIVATE void trigger_camera_capture( void );
+PRIVATE void clear_state_profile( void );
+PRIVATE void clear_loop_stats( void );
+PRIVATE void clear_job_stats( void );
+#ifdef EVENT_TRACE
+PRIVATE void trace_read_chunk( void );
+#endif
 
 /* ----- Defines ----------------------------------------------------------- */
 
+enum
+{
+    LINK_MODULE = 0,
+    LINK_INTERNAL,
+    LINK_EXTERNAL,
+    UI_NUM_LINKS,
+} EUI_LINK_NAMES;
+
+// Traffic the firmware sends without being asked goes out on the link set for
+// its route. The host can move each route to a different link by writing
+// "route", so telemetry and bulk uploads don't sit in front of control replies.
+enum
+{
+    ROUTE_CONTROL = 0,    // state changes and errors
+    ROUTE_BULK,           // queue credit, follows the link moves and fades arrive on
+    ROUTE_TELEMETRY,      // position, resonance and trace data
+    UI_NUM_ROUTES,
+};
+
+PRIVATE const HalUartPort_t link_port[UI_NUM_LINKS] = {
+    [LINK_MODULE]   = HAL_UART_PORT_MODULE,
+    [LINK_INTERNAL] = HAL_UART_PORT_INTERNAL,
+    [LINK_EXTERNAL] = HAL_UART_PORT_EXTERNAL,
+};
+
 SystemData_t     sys_stats;
 Task_Info_t      task_info[TASK_MAX] = { 0 };
+Pool_Info_t      pool_info[POOL_MAX] = { 0 };
+State_Profile_t  state_profile[UI_PROFILE_WORST] = { 0 };
+HalIsrStats_t    isr_info[HAL_ISR_NUM] = { 0 };
+LoopStats_t      loop_stats;
+uint16_t         loop_budget_us[2] = { LOOP_BUDGET_WARNING_US, LOOP_BUDGET_LIMIT_US };
+JobStats_t       job_info[JOB_SCHEDULER_MAX_JOBS] = { 0 };
+Link_Stats_t     link_stats[UI_NUM_LINKS] = { 0 };
+uint8_t          link_route[UI_NUM_ROUTES] = { LINK_MODULE, LINK_MODULE, LINK_MODULE };
+PRIVATE uint64_t rx_parse_cycles[UI_NUM_LINKS] = { 0 };
+PRIVATE uint32_t rx_rate_bytes[UI_NUM_LINKS]   = { 0 };
+PRIVATE uint32_t tx_rate_bytes[UI_NUM_LINKS]   = { 0 };
+PRIVATE uint32_t link_rate_ms                  = 0;
+#ifdef EVENT_TRACE
+Trace_Chunk_t    trace_chunk;
+uint16_t         trace_read_index = 0;
+#endif
 KinematicsInfo_t mechanical_info;
 
 FanData_t  fan_stats;
@@ -65,7 +160,13 @@ uint8_t fan_manual_enable   = 0;
 TempData_t temp_sensors;
 
 SystemStates_t sys_states;
-QueueDepths_t  queue_data;
+QueueDepths_t  queue_data = { .movement_credit = MOVEMENT_CREDIT_WINDOW, .lighting_credit = LED_CREDIT_WINDOW };
+
+PRIVATE QueueDepths_t queue_reported;         // what the host was last told
+PRIVATE uint16_t      motion_received   = 0;    // running counts of items from the host, since the last clear
+PRIVATE uint16_t      lighting_received = 0;
+PRIVATE uint8_t       motion_accepted   = 0;    // compact packet sequence numbers, so the host knows where to resend from
+PRIVATE uint8_t       motion_seen       = 0;
 
 MotionData_t motion_global;
 #ifdef EXPANSION_SERVO
@@ -76,13 +177,23 @@ MotorData_t  motion_servo[3];
 
 #endif
 
-Movement_t       motion_inbound;
+InputShaperSettings_t input_shaper;
+float                 servo_lag_ms[3];
+ResonanceData_t       resonance_results[3];
+float                 resonance_response[3][RESONANCE_NUM_STEPS];
+
+Movement_t       motion_inbound;    // only used when no staging event could be allocated
+uint8_t          motion_compact[MOVEMENT_COMPACT_MAX_BYTES];
+uint8_t          motion_batch[MOVEMENT_BATCH_MAX_BYTES];
 CartesianPoint_t current_position;    //global position of end effector in cartesian space
+Position_Stream_t position_stream;
+uint8_t           position_decimation = 0;
 CartesianPoint_t target_position;
 
 LedState_t    rgb_led_drive;
 LedControl_t  rgb_manual_control;
 Fade_t        light_fade_inbound;
+uint8_t       light_batch[MOVEMENT_BATCH_MAX_BYTES];
 
 
 char device_nickname[16] = "Zaphod Beeblebot";
@@ -103,6 +214,21 @@ eui_message_t ui_variables[] = {
         EUI_CUSTOM( "super", sys_states ),
 //        EUI_CUSTOM( "fwb", fw_info ),
         EUI_CUSTOM( "tasks", task_info ),
+        EUI_CUSTOM_RO( "pools", pool_info ),
+        EUI_CUSTOM_RO( "profile", state_profile ),
+        EUI_FUNC( "prof_clr", clear_state_profile ),
+        EUI_CUSTOM_RO( "isr", isr_info ),
+        EUI_CUSTOM_RO( "loop", loop_stats ),
+        EUI_UINT16_ARRAY( "loop_bgt", loop_budget_us ),
+        EUI_FUNC( "loop_clr", clear_loop_stats ),
+        EUI_CUSTOM_RO( "jobs", job_info ),
+        EUI_FUNC( "jobs_clr", clear_job_stats ),
+        EUI_CUSTOM_RO( "links", link_stats ),
+        EUI_UINT8_ARRAY( "route", link_route ),
+#ifdef EVENT_TRACE
+        EUI_CUSTOM_RO( "trace", trace_chunk ),
+        EUI_UINT16( "trace_rd", trace_read_index ),
+#endif
         EUI_CUSTOM_RO( "kinematics", mechanical_info ),
 
         // Temperature and cooling system
@@ -118,6 +244,10 @@ eui_message_t ui_variables[] = {
 
         EUI_CUSTOM_RO( "moStat", motion_global ),
         EUI_CUSTOM_RO( "servo", motion_servo ),
+        EUI_CUSTOM( "shaper", input_shaper ),
+        EUI_FLOAT_ARRAY( "lag_ms", servo_lag_ms ),
+        EUI_CUSTOM_RO( "resonance", resonance_results ),
+        EUI_CUSTOM_RO( "res_resp", resonance_response ),
 
 //        EUI_CUSTOM( "pwr_cal", power_trims ),
         EUI_CUSTOM_RO( "rgb", rgb_led_drive ),
@@ -127,6 +257,9 @@ eui_message_t ui_variables[] = {
         //inbound movement buffer and 'add to queue' callback
         EUI_CUSTOM( "inlt", light_fade_inbound ),
         EUI_CUSTOM( "inmv", motion_inbound ),
+        EUI_CUSTOM( "mvc", motion_compact ),
+        EUI_CUSTOM( "mvb", motion_batch ),
+        EUI_CUSTOM( "ltb", light_batch ),
 
         EUI_FUNC( "stmv", execute_motion_queue ),
         EUI_FUNC( "clmv", clear_all_queue ),
@@ -135,6 +268,8 @@ eui_message_t ui_variables[] = {
 
         EUI_INT32_ARRAY( "tpos", target_position ),
         EUI_INT32_ARRAY_RO( "cpos", current_position ),
+        EUI_CUSTOM_RO( "pstream", position_stream ),
+        EUI_UINT8( "pdec", position_decimation ),
 
 #ifdef EXPANSION_SERVO
         EUI_FLOAT( "exp_ang", external_servo_angle_target),
@@ -154,41 +289,321 @@ eui_message_t ui_variables[] = {
 
 };
 
-enum
-{
-    LINK_MODULE = 0,
-    LINK_INTERNAL,
-    LINK_EXTERNAL,
-} EUI_LINK_NAMES;
-
 eui_interface_t communication_interface[] = {
         EUI_INTERFACE_CB( &user_interface_tx_put_module, &user_interface_eui_callback_module ),
         EUI_INTERFACE_CB( &user_interface_tx_put_internal, &user_interface_eui_callback_internal ),
         EUI_INTERFACE_CB(&user_interface_tx_put_external, &user_interface_eui_callback_external ),
 };
 
+// Writes which need more than the library storing the new value
+PRIVATE const UiHandler_t ui_handlers[] = {
+        { "req_mode", handle_mode_request },
+        { "route", handle_route },
+        { "inmv", handle_move },
+        { "mvc", handle_move_compact },
+        { "mvb", handle_move_batch },
+        { "inlt", handle_fade },
+        { "ltb", handle_fade_batch },
+        { "tpos", handle_track_position },
+#ifdef EXPANSION_SERVO
+        { "exp_ang", handle_servo_angle },
+#endif
+        { "hsv", handle_manual_led },
+        { "ledset", handle_manual_led },
+        { "capture", handle_capture },
+        { "loop_bgt", handle_loop_budget },
+        { "pdec", handle_position_decimation },
+#ifdef EVENT_TRACE
+        { "trace_rd", handle_trace_read },
+#endif
+};
+
+#define UI_DISPATCH_SLOTS 32U    // at least twice the handlers keeps probe chains short
+#define UI_DISPATCH_MASK  ( UI_DISPATCH_SLOTS - 1U )
+
+_Static_assert( ( UI_DISPATCH_SLOTS & UI_DISPATCH_MASK ) == 0, "Dispatch slots must be a power of two" );
+_Static_assert( DIM( ui_handlers ) * 2U <= UI_DISPATCH_SLOTS, "Too many handlers for the dispatch table" );
+
+PRIVATE UiDispatch_t ui_dispatch;
+PRIVATE uint8_t      dispatch_slots[UI_DISPATCH_SLOTS];
+PRIVATE uint32_t     dispatch_hash[DIM( ui_handlers )];
+
+// Values pushed to the host. Setters only mark them dirty, and the latest
+// value goes out at most once per period, within each link's telemetry
+// budget. A zero period is a state change, sent on the next pass regardless.
+enum
+{
+    TELEMETRY_SUPER = 0,
+    TELEMETRY_TRACK_TARGET,
+    TELEMETRY_POSITION,
+    TELEMETRY_MOTION,
+    TELEMETRY_SERVO,
+    TELEMETRY_LED,
+    TELEMETRY_RESONANCE,
+    TELEMETRY_RESPONSE,
+    TELEMETRY_POSITION_STREAM,
+    UI_NUM_TELEMETRY,
+};
+
+typedef struct
+{
+    const char *id;
+    uint8_t     route;
+    uint16_t    period_ms;
+} UiTelemetry_t;
+
+PRIVATE const UiTelemetry_t ui_telemetry[UI_NUM_TELEMETRY] = {
+        [TELEMETRY_SUPER]           = { "super", ROUTE_CONTROL, 0 },
+        [TELEMETRY_TRACK_TARGET]    = { "tpos", ROUTE_CONTROL, 0 },
+        [TELEMETRY_POSITION]        = { "cpos", ROUTE_TELEMETRY, 50 },
+        [TELEMETRY_MOTION]          = { "moStat", ROUTE_TELEMETRY, 100 },
+        [TELEMETRY_SERVO]           = { "servo", ROUTE_TELEMETRY, 50 },
+        [TELEMETRY_LED]             = { "rgb", ROUTE_TELEMETRY, 100 },
+        [TELEMETRY_RESONANCE]       = { "resonance", ROUTE_TELEMETRY, 100 },
+        [TELEMETRY_RESPONSE]        = { "res_resp", ROUTE_TELEMETRY, 100 },
+        [TELEMETRY_POSITION_STREAM] = { "pstream", ROUTE_TELEMETRY, 1 },
+};
+
+#define UI_PACKET_OVERHEAD 8U    // header, checksum and framing around the ID and payload
+
+PRIVATE const uint32_t link_baud[UI_NUM_LINKS] = {
+    [LINK_MODULE]   = MODULE_BAUD,
+    [LINK_INTERNAL] = INTERNAL_BAUD,
+    [LINK_EXTERNAL] = EXTERNAL_BAUD,
+};
+
+PRIVATE volatile bool telemetry_dirty[UI_NUM_TELEMETRY];
+PRIVATE uint32_t      telemetry_sent_ms[UI_NUM_TELEMETRY];
+PRIVATE uint16_t      telemetry_bytes[UI_NUM_TELEMETRY];    // packet size on the wire
+PRIVATE int32_t       telemetry_credit[UI_NUM_LINKS];       // thousandths of a byte, negative when over budget
+PRIVATE uint32_t      telemetry_refill_ms;
+
+// Position frames wait here until the telemetry budget lets them out
+#define UI_POSITION_RING_FRAMES 64U    // with 32 byte frames the fifo stays a power of two
+
+PRIVATE fifo_t   position_fifo;
+PRIVATE uint8_t  position_buffer[UI_POSITION_RING_FRAMES * sizeof( Position_Frame_t )];
+PRIVATE uint8_t  position_countdown = 0;
+PRIVATE uint16_t position_sequence  = 0;
+
 /* ----- Public Functions --------------------------------------------------- */
 
 PUBLIC void
 user_interface_init( void )
 {
     hal_uart_init( HAL_UART_PORT_MODULE );
-    // TODO init other serial ports for UI use?
+    hal_uart_init( HAL_UART_PORT_INTERNAL );
+#ifdef EXTERNAL_UI_LINK
+    hal_uart_init( HAL_UART_PORT_EXTERNAL );
+#endif
+
+    ui_dispatch_init( &ui_dispatch, ui_handlers, DIM( ui_handlers ), dispatch_hash, dispatch_slots, UI_DISPATCH_SLOTS );
+    user_interface_telemetry_init();
 
     EUI_LINK( communication_interface );
     EUI_TRACK( ui_variables );
     eui_setup_identifier( (char *)HAL_UUID, 12 );    //header byte is 96-bit, therefore 12-bytes
 }
 
+// Runs as a background job rather than from the tick, so packet callbacks
+// (and the events they publish) stay out of interrupt context.
+// Each link is parsed in place from its UART's DMA buffer under its own byte
+// budget, so a busy link can't hold up the others. The control link goes first.
+// Telemetry is sent afterwards, so it only takes up what's left of the pass.
+
 PUBLIC void
 user_interface_handle_data( void )
 {
-    while( hal_uart_rx_data_available( HAL_UART_PORT_MODULE ) )
+    uint8_t control = link_route[ROUTE_CONTROL];
+
+    user_interface_parse_link( control );
+
+    for( uint8_t link = 0; link < UI_NUM_LINKS; link++ )
+    {
+        if( link != control )
+        {
+            user_interface_parse_link( link );
+        }
+    }
+
+    user_interface_send_telemetry();
+}
+
+PRIVATE void
+user_interface_parse_link( uint8_t link )
+{
+#ifndef EXTERNAL_UI_LINK
+    if( link == LINK_EXTERNAL )
+    {
+        return;
+    }
+#endif
+
+    HalUartPort_t port    = link_port[link];
+    Link_Stats_t *stats   = &link_stats[link];
+    uint32_t      backlog = hal_uart_rx_data_available( port );
+    uint32_t      parsed  = 0;
+    uint32_t      start   = CYCLE_COUNT();
+
+    while( parsed < UI_RX_BUDGET_BYTES )
+    {
+        const uint8_t *span   = 0;
+        uint32_t       length = hal_uart_rx_span( port, &span );
+
+        if( !length )
+        {
+            break;
+        }
+
+        length = MIN( length, UI_RX_BUDGET_BYTES - parsed );
+
+        for( uint32_t i = 0; i < length; i++ )
+        {
+            eui_parse( span[i], &communication_interface[link] );
+        }
+
+        hal_uart_rx_consume( port, length );
+        parsed += length;
+    }
+
+    if( parsed )
+    {
+        rx_parse_cycles[link] += CYCLE_COUNT() - start;
+    }
+
+    stats->rx_bytes += parsed;
+    stats->backlog     = MIN( backlog, UINT16_MAX );
+    stats->backlog_max = MAX( stats->backlog_max, stats->backlog );
+
+    if( backlog > parsed )
+    {
+        stats->budget_hits++;
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+
+PRIVATE void
+user_interface_telemetry_init( void )
+{
+    memset( (void *)telemetry_dirty, 0, sizeof( telemetry_dirty ) );
+    memset( telemetry_sent_ms, 0, sizeof( telemetry_sent_ms ) );
+    memset( telemetry_credit, 0, sizeof( telemetry_credit ) );
+    telemetry_refill_ms = hal_systick_get_ms();
+
+    fifo_init( &position_fifo, position_buffer, sizeof( position_buffer ) );
+
+    for( uint8_t i = 0; i < UI_NUM_TELEMETRY; i++ )
+    {
+        for( uint8_t v = 0; v < DIM( ui_variables ); v++ )
+        {
+            if( strcmp( ui_variables[v].id, ui_telemetry[i].id ) == 0 )
+            {
+                telemetry_bytes[i] = ui_variables[v].size + strlen( ui_telemetry[i].id ) + UI_PACKET_OVERHEAD;
+                break;
+            }
+        }
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+
+// Send the dirty values which are due, while their link has budget for them.
+// Anything held back stays dirty, so only the latest value is ever sent.
+
+PRIVATE void
+user_interface_send_telemetry( void )
+{
+    uint32_t now_ms  = hal_systick_get_ms();
+    uint32_t elapsed = now_ms - telemetry_refill_ms;
+
+    if( elapsed )
+    {
+        for( uint8_t link = 0; link < UI_NUM_LINKS; link++ )
+        {
+            // bytes per second over milliseconds gives thousandths of a byte
+            int32_t bytes_per_s = ( link_baud[link] / 10U ) * UI_TELEMETRY_PERCENT / 100U;
+            int32_t limit       = bytes_per_s * UI_TELEMETRY_BURST_MS;
+
+            telemetry_credit[link] = MIN( telemetry_credit[link] + bytes_per_s * (int32_t)MIN( elapsed, UI_TELEMETRY_BURST_MS ), limit );
+        }
+
+        telemetry_refill_ms = now_ms;
+    }
+
+    for( uint8_t i = 0; i < UI_NUM_TELEMETRY; i++ )
+    {
+        const UiTelemetry_t *t = &ui_telemetry[i];
+
+        if( !telemetry_dirty[i] || now_ms - telemetry_sent_ms[i] < t->period_ms )
+        {
+            continue;
+        }
+
+        uint8_t link = link_route[t->route];
+
+        // Periodic values wait for budget, state changes are charged but never held back
+        if( t->period_ms && telemetry_credit[link] < 0 )
+        {
+            continue;
+        }
+
+        // A full fifo would drop the packet, leave it dirty for a later pass instead
+        if( hal_uart_tx_free( link_port[link] ) < MIN( telemetry_bytes[i], HAL_UART_TX_FIFO_SIZE ) )
+        {
+            continue;
+        }
+
+        telemetry_dirty[i]   = false;
+        telemetry_sent_ms[i] = now_ms;
+        telemetry_credit[link] -= telemetry_bytes[i] * 1000;
+
+        if( i == TELEMETRY_POSITION_STREAM )
+        {
+            user_interface_pack_position_stream();
+        }
+
+        eui_send_tracked_on( t->id, &communication_interface[link] );
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+
+// Move the oldest queued frames into the packet, it stays dirty while more are waiting
+
+PRIVATE void
+user_interface_pack_position_stream( void )
+{
+    uint8_t count = 0;
+
+    while( count < UI_POSITION_FRAMES && fifo_used( &position_fifo ) >= sizeof( Position_Frame_t ) )
     {
-        eui_parse( hal_uart_rx_get( HAL_UART_PORT_MODULE ), &communication_interface[LINK_MODULE] );
+        fifo_read( &position_fifo, (uint8_t *)&position_stream.frames[count], sizeof( Position_Frame_t ) );
+        count++;
     }
 
-    // TODO handle other communication link serial FIFO
+    memset( &position_stream.frames[count], 0, ( UI_POSITION_FRAMES - count ) * sizeof( Position_Frame_t ) );
+    position_stream.count      = count;
+    position_stream.decimation = position_decimation;
+
+    telemetry_dirty[TELEMETRY_POSITION_STREAM] = fifo_used( &position_fifo ) > 0;
+}
+
+/* -------------------------------------------------------------------------- */
+
+PRIVATE void
+user_interface_tx_put( uint8_t link, uint8_t *c, uint16_t length )
+{
+    uint32_t sent = hal_uart_write( link_port[link], c, length );
+
+    link_stats[link].tx_bytes += sent;
+    link_stats[link].tx_dropped += length - sent;
+}
+
+PRIVATE void
+user_interface_send_on_route( uint8_t route, const char *id )
+{
+    eui_send_tracked_on( id, &communication_interface[link_route[route]] );
 }
 
 /* -------------------------------------------------------------------------- */
@@ -196,7 +611,7 @@ user_interface_handle_data( void )
 PRIVATE void
 user_interface_tx_put_external(uint8_t *c, uint16_t length )
 {
-    hal_uart_write( HAL_UART_PORT_EXTERNAL, c, length );
+    user_interface_tx_put( LINK_EXTERNAL, c, length );
 }
 
 PRIVATE void
@@ -210,7 +625,7 @@ user_interface_eui_callback_external(uint8_t message )
 PRIVATE void
 user_interface_tx_put_internal( uint8_t *c, uint16_t length )
 {
-    hal_uart_write( HAL_UART_PORT_INTERNAL, c, length );
+    user_interface_tx_put( LINK_INTERNAL, c, length );
 }
 
 PRIVATE void
@@ -224,7 +639,7 @@ user_interface_eui_callback_internal( uint8_t message )
 PRIVATE void
 user_interface_tx_put_module( uint8_t *c, uint16_t length )
 {
-    hal_uart_write( HAL_UART_PORT_MODULE, c, length );
+    user_interface_tx_put( LINK_MODULE, c, length );
 }
 
 PRIVATE void
@@ -243,71 +658,12 @@ user_interface_eui_callback( uint8_t link, eui_interface_t *interface, uint8_t m
     {
         case EUI_CB_TRACKED: {
             // UI received a tracked message ID and has completed processing
-            eui_header_t header  = interface->packet.header;
-            void *       payload = interface->packet.data_in;
-            uint8_t *    name_rx = interface->packet.id_in;
-
-            // See if the inbound packet name matches our intended variable
-            if( strcmp( (char *)name_rx, "req_mode" ) == 0 )
-            {
-
-                // Fire an event to the supervisor to change mode
-                switch( mode_request )
-                {
-                    case CONTROL_NONE:
-                        // TODO allow UI to request a no-mode setting?
-                        break;
-                    case CONTROL_MANUAL:
-                        eventPublish( EVENT_NEW( StateEvent, MODE_MANUAL ) );
-                        break;
-                    case CONTROL_EVENT:
-                        eventPublish( EVENT_NEW( StateEvent, MODE_EVENT ) );
-                        break;
-                    case CONTROL_DEMO:
-                        eventPublish( EVENT_NEW( StateEvent, MODE_DEMO ) );
-                        break;
-                    case CONTROL_TRACK:
-                        eventPublish( EVENT_NEW( StateEvent, MODE_TRACK ) );
-                        break;
-
-                    default:
-                        // Punish an incorrect attempt at mode changes with E-STOP
-                        eventPublish( EVENT_NEW( StateEvent, MOTION_EMERGENCY ) );
-                        break;
-                }
-            }
-
-            if( strcmp( (char *)name_rx, "inmv" ) == 0 && header.data_len )
-            {
-                movement_generate_event();
-            }
+            eui_header_t header = interface->packet.header;
 
-            if( strcmp( (char *)name_rx, "inlt" ) == 0 && header.data_len )
+            // Queries don't change anything, only writes need acting on
+            if( header.data_len )
             {
-                lighting_generate_event();
-            }
-
-            if( strcmp( (char *)name_rx, "tpos" ) == 0 && header.data_len )
-            {
-                tracked_position_event();
-            }
-
-#ifdef EXPANSION_SERVO
-            if( strcmp( (char *)name_rx, "exp_ang" ) == 0 && header.data_len )
-            {
-                tracked_external_servo_request();
-            }
-#endif
-
-            if( ( strcmp( (char *)name_rx, "hsv" ) == 0 || strcmp( (char *)name_rx, "ledset" ) == 0 )
-                && header.data_len )
-            {
-                rgb_manual_led_event();
-            }
-
-            if( strcmp( (char *)name_rx, "capture" ) == 0 && header.data_len )
-            {
-                trigger_camera_capture();
+                user_interface_dispatch( link, interface->packet.id_in, header.data_len );
             }
 
             break;
@@ -331,6 +687,159 @@ user_interface_eui_callback( uint8_t link, eui_interface_t *interface, uint8_t m
 
 /* -------------------------------------------------------------------------- */
 
+PRIVATE void
+user_interface_dispatch( uint8_t link, const uint8_t *id, uint16_t length )
+{
+    const UiHandler_t *h = ui_dispatch_find( &ui_dispatch, id );
+
+    // Most writes are settings the library has already stored, with nothing more to do
+    if( h )
+    {
+        h->handler( link, length );
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+
+// Inbound write handlers
+
+PRIVATE void
+handle_mode_request( uint8_t link, uint16_t length )
+{
+    // Fire an event to the supervisor to change mode
+    switch( mode_request )
+    {
+        case CONTROL_NONE:
+            // TODO allow UI to request a no-mode setting?
+            break;
+        case CONTROL_MANUAL:
+            eventPublish( EVENT_NEW( StateEvent, MODE_MANUAL ) );
+            break;
+        case CONTROL_EVENT:
+            eventPublish( EVENT_NEW( StateEvent, MODE_EVENT ) );
+            break;
+        case CONTROL_DEMO:
+            eventPublish( EVENT_NEW( StateEvent, MODE_DEMO ) );
+            break;
+        case CONTROL_TRACK:
+            eventPublish( EVENT_NEW( StateEvent, MODE_TRACK ) );
+            break;
+        case CONTROL_RESONANCE:
+            eventPublish( EVENT_NEW( StateEvent, MODE_RESONANCE ) );
+            break;
+
+        default:
+            // Punish an incorrect attempt at mode changes with E-STOP
+            eventPublish( EVENT_NEW( StateEvent, MOTION_EMERGENCY ) );
+            break;
+    }
+}
+
+PRIVATE void
+handle_route( uint8_t link, uint16_t length )
+{
+    // Links which aren't running can't carry anything
+    for( uint8_t route = 0; route < UI_NUM_ROUTES; route++ )
+    {
+#ifdef EXTERNAL_UI_LINK
+        if( link_route[route] >= UI_NUM_LINKS )
+#else
+        if( link_route[route] >= LINK_EXTERNAL )
+#endif
+        {
+            link_route[route] = link;
+        }
+    }
+}
+
+// Credit has to go back to whichever link the stream is coming in on
+
+PRIVATE void
+handle_move( uint8_t link, uint16_t length )
+{
+    link_route[ROUTE_BULK] = link;
+    movement_generate_event();
+}
+
+PRIVATE void
+handle_move_compact( uint8_t link, uint16_t length )
+{
+    link_route[ROUTE_BULK] = link;
+    movement_compact_event( length );
+}
+
+PRIVATE void
+handle_move_batch( uint8_t link, uint16_t length )
+{
+    link_route[ROUTE_BULK] = link;
+    movement_batch_event( length );
+}
+
+PRIVATE void
+handle_fade( uint8_t link, uint16_t length )
+{
+    link_route[ROUTE_BULK] = link;
+    lighting_generate_event();
+}
+
+PRIVATE void
+handle_fade_batch( uint8_t link, uint16_t length )
+{
+    link_route[ROUTE_BULK] = link;
+    lighting_batch_event( length );
+}
+
+PRIVATE void
+handle_track_position( uint8_t link, uint16_t length )
+{
+    tracked_position_event();
+}
+
+#ifdef EXPANSION_SERVO
+PRIVATE void
+handle_servo_angle( uint8_t link, uint16_t length )
+{
+    tracked_external_servo_request();
+}
+#endif
+
+PRIVATE void
+handle_manual_led( uint8_t link, uint16_t length )
+{
+    rgb_manual_led_event();
+}
+
+PRIVATE void
+handle_capture( uint8_t link, uint16_t length )
+{
+    trigger_camera_capture();
+}
+
+PRIVATE void
+handle_loop_budget( uint8_t link, uint16_t length )
+{
+    loop_monitor_set_budgets( loop_budget_us[0], loop_budget_us[1] );
+}
+
+PRIVATE void
+handle_position_decimation( uint8_t link, uint16_t length )
+{
+    // Start the new stream from a clean slate
+    fifo_init( &position_fifo, position_buffer, sizeof( position_buffer ) );
+    position_countdown      = 0;
+    position_stream.dropped = 0;
+}
+
+#ifdef EVENT_TRACE
+PRIVATE void
+handle_trace_read( uint8_t link, uint16_t length )
+{
+    trace_read_chunk();
+}
+#endif
+
+/* -------------------------------------------------------------------------- */
+
 PUBLIC void
 user_interface_set_reset_cause( const char *reset_description )
 {
@@ -349,7 +858,7 @@ user_interface_report_error( char *error_string )
             .size = strlen( error_string ),
             { .data = error_string } };
 
-    eui_send_untracked( &err_message );
+    eui_send_untracked_on( &err_message, &communication_interface[link_route[ROUTE_CONTROL]] );
 }
 
 /* -------------------------------------------------------------------------- */
@@ -371,6 +880,8 @@ user_interface_set_cpu_clock( uint32_t clock )
 PUBLIC void
 user_interface_update_task_statistics( void )
 {
+    app_task_update_statistics();
+
     for( uint8_t id = ( TASK_MAX - 1 ); id > 0; id-- )
     {
         StateTask *t = app_task_by_id( id );
@@ -387,6 +898,70 @@ user_interface_update_task_statistics( void )
             strcpy( (char *)&task_info[id].name, t->name );
         }
     }
+
+    for( uint8_t id = 0; id < POOL_MAX; id++ )
+    {
+        const EventPool *p = eventPoolGetPool( id );
+        if( p )
+        {
+            pool_info[id].event_size = p->eventSize;
+            pool_info[id].total      = p->totalEvents;
+            pool_info[id].used       = p->totalEvents - p->freeEvents;
+            pool_info[id].high_water = p->totalEvents - p->minimumEvents;
+            pool_info[id].spilled    = p->spilledEvents;
+            pool_info[id].failed     = p->failedEvents;
+        }
+    }
+
+    const StateProfile *worst[UI_PROFILE_WORST];
+    uint8_t             found = stateProfileWorst( worst, UI_PROFILE_WORST );
+
+    memset( &state_profile, 0, sizeof( state_profile ) );
+
+    for( uint8_t i = 0; i < found; i++ )
+    {
+        state_profile[i].handler  = (uint32_t)(uintptr_t)worst[i]->handler;
+        state_profile[i].count    = worst[i]->count;
+        state_profile[i].last     = worst[i]->last;
+        state_profile[i].min      = worst[i]->min;
+        state_profile[i].avg      = worst[i]->total / worst[i]->count;
+        state_profile[i].max      = worst[i]->max;
+        state_profile[i].instance = worst[i]->instance;
+        state_profile[i].state    = worst[i]->state;
+
+        strncpy( state_profile[i].name, worst[i]->name, sizeof( state_profile[0].name ) - 1 );
+    }
+
+    hal_isr_profile_read( isr_info );
+    loop_monitor_get_stats( &loop_stats );
+    job_scheduler_get_stats( job_info );
+
+    uint32_t now_ms = hal_systick_get_ms();
+
+    for( uint8_t link = 0; link < UI_NUM_LINKS; link++ )
+    {
+        Link_Stats_t *stats = &link_stats[link];
+
+#ifndef EXTERNAL_UI_LINK
+        if( link == LINK_EXTERNAL )
+        {
+            continue;
+        }
+#endif
+
+        stats->rx_dropped    = hal_uart_rx_dropped( link_port[link] );
+        stats->cycles_per_kb = stats->rx_bytes ? (uint32_t)( ( rx_parse_cycles[link] * 1024U ) / stats->rx_bytes ) : 0;
+
+        if( now_ms != link_rate_ms )
+        {
+            stats->rx_bytes_per_s = ( ( stats->rx_bytes - rx_rate_bytes[link] ) * 1000U ) / ( now_ms - link_rate_ms );
+            stats->tx_bytes_per_s = ( ( stats->tx_bytes - tx_rate_bytes[link] ) * 1000U ) / ( now_ms - link_rate_ms );
+            rx_rate_bytes[link]   = stats->rx_bytes;
+            tx_rate_bytes[link]   = stats->tx_bytes;
+        }
+    }
+
+    link_rate_ms = now_ms;
     //app_task_clear_statistics();
 }
 
@@ -416,14 +991,14 @@ user_interface_set_main_state( uint8_t state )
 {
     sys_states.supervisor = state;
     sys_states.motors     = motion_servo[0].enabled || motion_servo[1].enabled || motion_servo[2].enabled;
-    eui_send_tracked( "super" );
+    telemetry_dirty[TELEMETRY_SUPER] = true;
 }
 
 PUBLIC void
 user_interface_set_control_mode( uint8_t mode )
 {
     sys_states.control_mode = mode;
-    eui_send_tracked( "super" );
+    telemetry_dirty[TELEMETRY_SUPER] = true;
 }
 
 /* -------------------------------------------------------------------------- */
@@ -528,9 +1103,89 @@ user_interface_set_temp_cpu( float temp )
 PUBLIC void
 user_interface_set_position( int32_t x, int32_t y, int32_t z )
 {
-    current_position.x = x;
-    current_position.y = y;
-    current_position.z = z;
+    if( current_position.x != x || current_position.y != y || current_position.z != z )
+    {
+        current_position.x = x;
+        current_position.y = y;
+        current_position.z = z;
+        telemetry_dirty[TELEMETRY_POSITION] = true;
+    }
+}
+
+PUBLIC void
+user_interface_stream_position( const CartesianPoint_t *position, const JointAngles_t *angles )
+{
+    if( !position_decimation )
+    {
+        return;
+    }
+
+    if( position_countdown )
+    {
+        position_countdown--;
+        return;
+    }
+
+    position_countdown = position_decimation - 1U;
+
+    Position_Frame_t frame = {
+        .timestamp_ms = hal_systick_get_ms(),
+        .sequence     = position_sequence++,
+        .identifier   = motion_global.movement_identifier,
+        .x            = position->x,
+        .y            = position->y,
+        .z            = position->z,
+        .a1           = angles->a1,
+        .a2           = angles->a2,
+        .a3           = angles->a3,
+    };
+
+    // Newer frames are dropped rather than older ones, so the host sees a gap instead of a jump
+    if( fifo_free( &position_fifo ) < sizeof( Position_Frame_t ) )
+    {
+        position_stream.dropped++;
+        return;
+    }
+
+    fifo_write( &position_fifo, (const uint8_t *)&frame, sizeof( Position_Frame_t ) );
+    telemetry_dirty[TELEMETRY_POSITION_STREAM] = true;
+}
+
+PUBLIC void
+user_interface_get_input_shaper( uint8_t *type, float *frequency, float *damping )
+{
+    *type      = input_shaper.type;
+    *frequency = input_shaper.frequency;
+    *damping   = input_shaper.damping;
+}
+
+PUBLIC void
+user_interface_get_servo_lag( float *lag_ms )
+{
+    memcpy( lag_ms, &servo_lag_ms, sizeof( servo_lag_ms ) );
+}
+
+PUBLIC void
+user_interface_set_resonance_progress( uint8_t axis, uint8_t percent )
+{
+    resonance_results[axis].progress = percent;
+    telemetry_dirty[TELEMETRY_RESONANCE] = true;
+}
+
+PUBLIC void
+user_interface_set_resonance_result( uint8_t axis, float peak_hz, float damping, float peak_response )
+{
+    resonance_results[axis].peak_hz       = peak_hz;
+    resonance_results[axis].damping       = damping;
+    resonance_results[axis].peak_response = peak_response;
+    telemetry_dirty[TELEMETRY_RESONANCE] = true;
+}
+
+PUBLIC void
+user_interface_set_resonance_response( uint8_t axis, float *response, uint8_t count )
+{
+    memcpy( &resonance_response[axis], response, MIN( count, RESONANCE_NUM_STEPS ) * sizeof( float ) );
+    telemetry_dirty[TELEMETRY_RESPONSE] = true;
 }
 
 PUBLIC CartesianPoint_t
@@ -546,34 +1201,37 @@ user_interface_reset_tracking_target()
     target_position.y = 0;
     target_position.z = 0;
 
-    eui_send_tracked( "tpos" );    // tell the UI that the value has changed
+    telemetry_dirty[TELEMETRY_TRACK_TARGET] = true;    // tell the UI that the value has changed
 }
 
 PUBLIC void
-user_interface_set_movement_data( uint8_t move_id, uint8_t move_type, uint8_t progress )
+user_interface_set_movement_data( uint16_t move_id, uint8_t move_type, uint8_t progress )
 {
     motion_global.movement_identifier = move_id;
     motion_global.profile_type        = move_type;
     motion_global.move_progress       = progress;
+    telemetry_dirty[TELEMETRY_MOTION] = true;
 }
 
 PUBLIC void
 user_interface_set_pathing_status( uint8_t status )
 {
     motion_global.pathing_state = status;
+    telemetry_dirty[TELEMETRY_MOTION] = true;
 }
 
 PUBLIC void
 user_interface_set_motion_state( uint8_t status )
 {
     motion_global.motion_state = status;
+    telemetry_dirty[TELEMETRY_MOTION] = true;
 }
 
 PUBLIC void
-user_interface_set_motion_queue_depth( uint8_t utilisation )
+user_interface_set_motion_queue_depth( uint16_t utilisation )
 {
     queue_data.movements = utilisation;
-    //    eui_send_tracked("queue");
+    queue_credit_update( false );
 }
 
 /* -------------------------------------------------------------------------- */
@@ -582,30 +1240,35 @@ PUBLIC void
 user_interface_motor_enable( uint8_t servo, bool enable )
 {
     motion_servo[servo].enabled = enable;
+    telemetry_dirty[TELEMETRY_SERVO] = true;
 }
 
 PUBLIC void
 user_interface_motor_state( uint8_t servo, uint8_t state )
 {
     motion_servo[servo].state = state;
+    telemetry_dirty[TELEMETRY_SERVO] = true;
 }
 
 PUBLIC void
 user_interface_motor_feedback( uint8_t servo, float percentage )
 {
     motion_servo[servo].feedback = percentage * 10;
+    telemetry_dirty[TELEMETRY_SERVO] = true;
 }
 
 PUBLIC void
 user_interface_motor_power( uint8_t servo, float watts )
 {
     motion_servo[servo].power = watts;
+    telemetry_dirty[TELEMETRY_SERVO] = true;
 }
 
 PUBLIC void
 user_interface_motor_target_angle( uint8_t servo, float angle )
 {
     motion_servo[servo].target_angle = angle;
+    telemetry_dirty[TELEMETRY_SERVO] = true;
 }
 
 /* -------------------------------------------------------------------------- */
@@ -614,21 +1277,26 @@ PUBLIC void
 user_interface_set_led_status( uint8_t enabled )
 {
     rgb_led_drive.enable = enabled;
+    telemetry_dirty[TELEMETRY_LED] = true;
 }
 
 PUBLIC void
 user_interface_set_led_values( uint16_t red, uint16_t green, uint16_t blue )
 {
-    rgb_led_drive.red   = red;
-    rgb_led_drive.green = green;
-    rgb_led_drive.blue  = blue;
+    if( rgb_led_drive.red != red || rgb_led_drive.green != green || rgb_led_drive.blue != blue )
+    {
+        rgb_led_drive.red   = red;
+        rgb_led_drive.green = green;
+        rgb_led_drive.blue  = blue;
+        telemetry_dirty[TELEMETRY_LED] = true;
+    }
 }
 
 PUBLIC void
-user_interface_set_led_queue_depth( uint8_t utilisation )
+user_interface_set_led_queue_depth( uint16_t utilisation )
 {
     queue_data.lighting = utilisation;
-    //    eui_send_tracked("queue");
+    queue_credit_update( false );
 }
 
 PUBLIC void
@@ -686,16 +1354,283 @@ PRIVATE void home_mech_cb( void )
 
 /* -------------------------------------------------------------------------- */
 
+PRIVATE MotionPlannerEvent *motion_staged  = 0;
+PRIVATE eui_message_t *     motion_tracked = 0;
+
 PRIVATE void movement_generate_event( void )
 {
-    MotionPlannerEvent *motion_request = EVENT_NEW( MotionPlannerEvent, MOVEMENT_REQUEST );
+    queue_credit_consume( 1, 0 );
+
+    if( motion_staged )
+    {
+        // The move was decoded straight into the staged event
+        eventPublish( (StateEvent *)motion_staged );
+        motion_staged = 0;
+    }
+    else
+    {
+        MotionPlannerEvent *motion_request = EVENT_NEW( MotionPlannerEvent, MOVEMENT_REQUEST );
+
+        if( motion_request )
+        {
+            memcpy( &motion_request->move, &motion_inbound, sizeof( motion_inbound ) );
+            eventPublish( (StateEvent *)motion_request );
+            memset( &motion_inbound, 0, sizeof( motion_inbound ) );
+        }
+    }
+
+    movement_stage_event();
+}
+
+// Allocate the event for the next inbound move, and point the tracked variable at it
+// so the parser writes the move directly into the event
+PRIVATE void movement_stage_event( void )
+{
+    // Look up the tracked variable the first time through
+    for( uint8_t i = 0; !motion_tracked && i < DIM( ui_variables ); i++ )
+    {
+        if( strcmp( ui_variables[i].id, "inmv" ) == 0 )
+        {
+            motion_tracked = &ui_variables[i];
+        }
+    }
+
+    if( motion_tracked && !motion_staged )
+    {
+        motion_staged = EVENT_NEW( MotionPlannerEvent, MOVEMENT_REQUEST );
+
+        if( motion_staged )
+        {
+            memset( &motion_staged->move, 0, sizeof( Movement_t ) );
+            motion_tracked->ptr.data = &motion_staged->move;
+        }
+        else
+        {
+            motion_tracked->ptr.data = &motion_inbound;
+        }
+    }
+}
+
+PRIVATE MovementDecoder_t motion_decoder;
+
+// Expand a compact move straight into a new planner event
+PRIVATE void movement_compact_event( uint16_t length )
+{
+    uint16_t               offset = 0;
+    MovementDecodeResult_t result = movement_decoder_begin( &motion_decoder, motion_compact, length, &offset );
+
+    if( result != MOVEMENT_DECODE_DUPLICATE )
+    {
+        queue_credit_consume( 1, 0 );
+    }
+
+    if( result != MOVEMENT_DECODE_DUPLICATE && length >= 2U )
+    {
+        motion_seen = motion_compact[1];
+    }
+
+    if( result == MOVEMENT_DECODE_OK )
+    {
+        MotionPlannerEvent *motion_request = EVENT_NEW( MotionPlannerEvent, MOVEMENT_REQUEST );
+
+        // Still decode when the event couldn't be allocated, so a malformed move is reported as one
+        result = movement_decode( &motion_decoder,
+                                  motion_compact,
+                                  length,
+                                  &offset,
+                                  motion_request ? &motion_request->move : &motion_inbound );
+
+        if( motion_request && result == MOVEMENT_DECODE_OK )
+        {
+            eventPublish( (StateEvent *)motion_request );
+            motion_accepted = motion_compact[1];
+        }
+        else if( motion_request )
+        {
+            EVENT_DELETE( motion_request );
+        }
+        else if( result == MOVEMENT_DECODE_OK )
+        {
+            // Later moves would run without this one, hold them off until the host resends from here
+            motion_decoder.synced = false;
+            user_interface_report_error( "Move dropped" );
+        }
+    }
+
+    switch( result )
+    {
+        case MOVEMENT_DECODE_VERSION:
+            user_interface_report_error( "Move format version" );
+            break;
+        case MOVEMENT_DECODE_UNSYNCED:
+            user_interface_report_error( "Move stream unsynced" );
+            break;
+        case MOVEMENT_DECODE_MALFORMED:
+            user_interface_report_error( "Move malformed" );
+            break;
+        default:
+            break;
+    }
+}
+
+// Queue every move and fade in a batch, or none of them
+PRIVATE void movement_batch_event( uint16_t length )
+{
+    StateEvent *staged[MOVEMENT_BATCH_MAX_MOVES + MOVEMENT_BATCH_MAX_FADES] = { 0 };
+    uint8_t     num_staged = 0;
+    uint8_t     num_moves  = 0;
+    uint8_t     num_fades  = 0;
+    uint16_t    offset     = 0;
+
+    MovementDecodeResult_t result = movement_decoder_begin( &motion_decoder, motion_batch, length, &offset );
+
+    // The host counts every move it sent against its credit, even ones which couldn't be used
+    if( result != MOVEMENT_DECODE_DUPLICATE && length > 2U )
+    {
+        num_moves   = motion_batch[2];
+        motion_seen = motion_batch[1];
+    }
+
+    if( result == MOVEMENT_DECODE_OK )
+    {
+        offset++;
+
+        if( num_moves > MOVEMENT_BATCH_MAX_MOVES )
+        {
+            // The sender has moved on past these moves, so the deltas after them can't be followed
+            motion_decoder.synced = false;
+            result                = MOVEMENT_DECODE_MALFORMED;
+        }
+
+        for( uint8_t i = 0; i < num_moves && result == MOVEMENT_DECODE_OK; i++ )
+        {
+            MotionPlannerEvent *motion_request = EVENT_NEW( MotionPlannerEvent, MOVEMENT_REQUEST );
+            staged[num_staged++]               = (StateEvent *)motion_request;
+
+            // Moves which can't be queued are still decoded, so a malformed batch is reported as one
+            result = movement_decode( &motion_decoder,
+                                      motion_batch,
+                                      length,
+                                      &offset,
+                                      motion_request ? &motion_request->move : &motion_inbound );
+        }
+    }
+
+    // Fades are optional, a batch of moves can end without the count
+    if( result == MOVEMENT_DECODE_OK && offset < length )
+    {
+        result = batch_stage_fades( motion_batch, length, &offset, staged, &num_staged, &num_fades );
+    }
+
+    if( batch_commit( staged, num_staged, result ) )
+    {
+        motion_accepted = motion_batch[1];
+    }
+    else if( result == MOVEMENT_DECODE_OK )
+    {
+        // Later batches would run without this one, hold them off until the host resends from here
+        motion_decoder.synced = false;
+    }
+
+    // Acknowledge with the depths the queues will reach once these are taken in
+    queue_credit_consume( num_moves, num_fades );
+    queue_credit_update( result != MOVEMENT_DECODE_DUPLICATE );
+}
+
+/* -------------------------------------------------------------------------- */
+
+PRIVATE void lighting_batch_event( uint16_t length )
+{
+    StateEvent *staged[MOVEMENT_BATCH_MAX_FADES] = { 0 };
+    uint8_t     num_staged = 0;
+    uint8_t     num_fades  = 0;
+    uint16_t    offset     = 0;
+
+    MovementDecodeResult_t result = batch_stage_fades( light_batch, length, &offset, staged, &num_staged, &num_fades );
+
+    batch_commit( staged, num_staged, result );
+
+    queue_credit_consume( 0, num_fades );
+    queue_credit_update( true );
+}
+
+/* -------------------------------------------------------------------------- */
+
+// Read the fade count and allocate an event for each fade, staged events are appended to the list
+PRIVATE MovementDecodeResult_t
+batch_stage_fades( const uint8_t *data, uint16_t length, uint16_t *offset, StateEvent **staged, uint8_t *num_staged, uint8_t *num_fades )
+{
+    MovementDecodeResult_t result = MOVEMENT_DECODE_OK;
+
+    *num_fades = ( *offset < length ) ? data[( *offset )++] : 0;
+
+    if( *num_fades > MOVEMENT_BATCH_MAX_FADES )
+    {
+        return MOVEMENT_DECODE_MALFORMED;
+    }
+
+    for( uint8_t i = 0; i < *num_fades && result == MOVEMENT_DECODE_OK; i++ )
+    {
+        LightingPlannerEvent *lighting_request = EVENT_NEW( LightingPlannerEvent, LED_QUEUE_ADD );
+        staged[( *num_staged )++]              = (StateEvent *)lighting_request;
+
+        result = movement_decode_fade( data,
+                                       length,
+                                       offset,
+                                       lighting_request ? &lighting_request->animation : &light_fade_inbound );
+    }
+
+    return result;
+}
+
+/* -------------------------------------------------------------------------- */
+
+// Publish the staged events if they all decoded and were allocated, otherwise return them all to the pool.
+// Returns true when they were published.
+PRIVATE bool
+batch_commit( StateEvent **staged, uint8_t num_staged, MovementDecodeResult_t result )
+{
+    bool complete = ( result == MOVEMENT_DECODE_OK );
 
-    if( motion_request )
+    for( uint8_t i = 0; i < num_staged; i++ )
     {
-        memcpy( &motion_request->move, &motion_inbound, sizeof( motion_inbound ) );
-        eventPublish( (StateEvent *)motion_request );
-        memset( &motion_inbound, 0, sizeof( motion_inbound ) );
+        complete &= ( staged[i] != 0 );
     }
+
+    for( uint8_t i = 0; i < num_staged; i++ )
+    {
+        if( complete )
+        {
+            eventPublish( staged[i] );
+        }
+        else if( staged[i] )
+        {
+            EVENT_DELETE( staged[i] );
+        }
+    }
+
+    switch( result )
+    {
+        case MOVEMENT_DECODE_OK:
+            if( !complete )
+            {
+                user_interface_report_error( "Move batch dropped" );
+            }
+            break;
+        case MOVEMENT_DECODE_VERSION:
+            user_interface_report_error( "Move format version" );
+            break;
+        case MOVEMENT_DECODE_UNSYNCED:
+            user_interface_report_error( "Move stream unsynced" );
+            break;
+        case MOVEMENT_DECODE_MALFORMED:
+            user_interface_report_error( "Move malformed" );
+            break;
+        default:
+            break;
+    }
+
+    return complete;
 }
 
 PRIVATE void execute_motion_queue( void )
@@ -705,6 +1640,14 @@ PRIVATE void execute_motion_queue( void )
 
 PRIVATE void clear_all_queue( void )
 {
+    // The host starts its credit counts and the move stream over when it clears
+    motion_received   = 0;
+    lighting_received = 0;
+    motion_accepted   = 0;
+    motion_seen       = 0;
+    memset( &queue_reported, 0, sizeof( queue_reported ) );
+    movement_decoder_reset( &motion_decoder );
+
     eventPublish( EVENT_NEW( StateEvent, MOTION_QUEUE_CLEAR ) );
     eventPublish( EVENT_NEW( StateEvent, LED_CLEAR_QUEUE ) );
 }
@@ -739,6 +1682,8 @@ PRIVATE void tracked_external_servo_request( void )
 
 PRIVATE void lighting_generate_event( void )
 {
+    queue_credit_consume( 0, 1 );
+
     LightingPlannerEvent *lighting_request = EVENT_NEW( LightingPlannerEvent, LED_QUEUE_ADD );
 
     if( lighting_request )
@@ -751,6 +1696,41 @@ PRIVATE void lighting_generate_event( void )
 
 /* -------------------------------------------------------------------------- */
 
+// Items from the host use up its credit, and bump the depth until the task reports it
+PRIVATE void queue_credit_consume( uint8_t moves, uint8_t fades )
+{
+    motion_received += moves;
+    lighting_received += fades;
+    queue_data.movements += moves;
+    queue_data.lighting += fades;
+}
+
+// Grant the host the free part of each window, as a running count of items it may have sent
+PRIVATE void queue_credit_update( bool force )
+{
+    queue_data.movement_credit = motion_received + MOVEMENT_CREDIT_WINDOW - MIN( queue_data.movements, MOVEMENT_CREDIT_WINDOW );
+    queue_data.lighting_credit = lighting_received + LED_CREDIT_WINDOW - MIN( queue_data.lighting, LED_CREDIT_WINDOW );
+    queue_data.motion_received = motion_received;
+    queue_data.motion_synced   = motion_decoder.synced;
+    queue_data.motion_accepted = motion_accepted;
+    queue_data.motion_seen     = motion_seen;
+
+    int16_t motion_returned   = queue_data.movement_credit - queue_reported.movement_credit;
+    int16_t lighting_returned = queue_data.lighting_credit - queue_reported.lighting_credit;
+
+    // Credits go back in groups to keep the link quiet, but an emptied queue always reports
+    bool emptied = ( queue_data.movements == 0 && motion_returned > 0 )
+                   || ( queue_data.lighting == 0 && lighting_returned > 0 );
+
+    if( force || emptied || motion_returned >= QUEUE_CREDIT_BATCH || lighting_returned >= QUEUE_CREDIT_BATCH )
+    {
+        queue_reported = queue_data;
+        user_interface_send_on_route( ROUTE_BULK, "queue" );
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+
 PRIVATE void sync_begin_queues( void )
 {
     BarrierSyncEvent *barrier_ev = EVENT_NEW( BarrierSyncEvent, START_QUEUE_SYNC );
@@ -777,5 +1757,53 @@ trigger_camera_capture( void )
     }
 }
 
+/* -------------------------------------------------------------------------- */
+
+PRIVATE void
+clear_state_profile( void )
+{
+    stateProfileReset();
+}
+
+PRIVATE void
+clear_loop_stats( void )
+{
+    loop_monitor_reset();
+}
+
+PRIVATE void
+clear_job_stats( void )
+{
+    job_scheduler_reset();
+}
+
+/* -------------------------------------------------------------------------- */
+
+#ifdef EVENT_TRACE
+// The UI walks through the trace a chunk at a time by writing the index it wants next.
+// Recording is held off from the first chunk until the last so the ring doesn't move underneath the read.
+PRIVATE void
+trace_read_chunk( void )
+{
+    if( trace_read_index == 0 )
+    {
+        eventTraceFreeze( true );
+    }
+
+    trace_chunk.index    = trace_read_index;
+    trace_chunk.total    = eventTraceCount();
+    trace_chunk.overhead = MIN( eventTraceOverhead(), UINT16_MAX );
+    trace_chunk.cpu_hz   = hal_system_speed_get_speed();
+    trace_chunk.count    = eventTraceRead( trace_read_index, trace_chunk.records, UI_TRACE_CHUNK_RECORDS );
+
+    if( trace_chunk.count < UI_TRACE_CHUNK_RECORDS )
+    {
+        eventTraceFreeze( false );
+    }
+
+    user_interface_send_on_route( ROUTE_TELEMETRY, "trace" );
+}
+#endif
+
 
 /* ----- End ---------------------------------------------------------------- */
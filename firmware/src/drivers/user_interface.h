@@ -7,8 +7,6 @@ extern "C" {
 
 /* ----- System Includes ---------------------------------------------------- */
 
-#include <electricui.h>
-
 /* ----- Local Includes ----------------------------------------------------- */
 
 #include "user_interface_types.h"
@@ -118,6 +116,25 @@ user_interface_set_temp_cpu( float temp );
 PUBLIC void
 user_interface_set_position( int32_t x, int32_t y, int32_t z );
 
+// Called at the control rate, a frame is queued on every decimated tick
+PUBLIC void
+user_interface_stream_position( const CartesianPoint_t *position, const JointAngles_t *angles );
+
+PUBLIC void
+user_interface_get_input_shaper( uint8_t *type, float *frequency, float *damping );
+
+PUBLIC void
+user_interface_get_servo_lag( float *lag_ms );
+
+PUBLIC void
+user_interface_set_resonance_progress( uint8_t axis, uint8_t percent );
+
+PUBLIC void
+user_interface_set_resonance_result( uint8_t axis, float peak_hz, float damping, float peak_response );
+
+PUBLIC void
+user_interface_set_resonance_response( uint8_t axis, float *response, uint8_t count );
+
 PUBLIC CartesianPoint_t
 user_interface_get_tracking_target();
 
@@ -125,7 +142,7 @@ PUBLIC void
 user_interface_reset_tracking_target();
 
 PUBLIC void
-user_interface_set_movement_data( uint8_t move_id, uint8_t move_type, uint8_t progress );
+user_interface_set_movement_data( uint16_t move_id, uint8_t move_type, uint8_t progress );
 
 PUBLIC void
 user_interface_set_pathing_status( uint8_t status );
@@ -134,7 +151,7 @@ PUBLIC void
 user_interface_set_motion_state( uint8_t status );
 
 PUBLIC void
-user_interface_set_motion_queue_depth( uint8_t utilisation );
+user_interface_set_motion_queue_depth( uint16_t utilisation );
 
 
 
@@ -169,7 +186,7 @@ PUBLIC void
 user_interface_get_led_manual( float *h, float *s, float *l, uint8_t *en );
 
 PUBLIC void
-user_interface_set_led_queue_depth( uint8_t utilisation );
+user_interface_set_led_queue_depth( uint16_t utilisation );
 
 /* -------------------------------------------------------------------------- */
 
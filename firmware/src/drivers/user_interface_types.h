@@ -8,6 +8,7 @@ extern "C" {
 /* ----- Local Includes ----------------------------------------------------- */
 
 #include "global.h"
+#include "event_trace.h"
 
 /* ----- Defines ------------------------------------------------------------ */
 
@@ -19,6 +20,7 @@ typedef enum
     CONTROL_TRACK,
     CONTROL_DEMO,
     CONTROL_CHANGING,
+    CONTROL_RESONANCE,
 } ControlModes_t;
 
 typedef struct
@@ -46,13 +48,90 @@ typedef struct
 {
     uint8_t  id;    // index of the task (pseudo priority)
     uint8_t  ready;
-    uint8_t  queue_used;
-    uint8_t  queue_max;
+    uint16_t queue_used;
+    uint16_t queue_max;
     uint32_t waiting_max;
     uint32_t burst_max;
     char     name[12];    // human readable taskname set during app_tasks setup
 } Task_Info_t;
 
+typedef struct
+{
+    uint16_t event_size;    // bytes per event in the pool
+    uint16_t total;
+    uint16_t used;
+    uint16_t high_water;    // most events in use at once
+    uint16_t spilled;       // allocations passed on to a bigger pool
+    uint16_t failed;        // allocations that failed outright
+} Pool_Info_t;
+
+// Kept small so the table fits in the UART TX FIFO in one response
+#define UI_PROFILE_WORST 5U
+
+typedef struct
+{
+    uint32_t handler;     // address of the state handler, look it up in the map file
+    uint32_t count;       // times the handler has run
+    uint32_t last;        // execution times in cpu cycles
+    uint32_t min;
+    uint32_t avg;
+    uint32_t max;
+    uint8_t  instance;    // task id or driver instance
+    uint8_t  state;       // simple state machine state, 255 for hierarchical states
+    char     name[12];    // task or driver name
+} State_Profile_t;
+
+typedef struct
+{
+    uint32_t rx_bytes;          // bytes parsed since boot
+    uint32_t rx_dropped;        // bytes discarded because they weren't parsed in time
+    uint16_t backlog;           // bytes waiting at the start of the latest pass
+    uint16_t backlog_max;       // most bytes waiting at the start of a pass
+    uint32_t budget_hits;       // passes which stopped at the byte budget with data left over
+    uint32_t rx_bytes_per_s;    // parse rate over the last statistics period
+    uint32_t cycles_per_kb;     // cpu cycles spent parsing each kilobyte, including packet callbacks
+    uint32_t tx_bytes;          // bytes queued for sending since boot
+    uint32_t tx_dropped;        // bytes of packets which didn't fit in the transmit fifo
+    uint32_t tx_bytes_per_s;
+} Link_Stats_t;
+
+typedef struct
+{
+    uint32_t timestamp_ms;
+    uint16_t sequence;      // counts every frame taken, gaps are frames which were dropped
+    uint16_t identifier;    // movement being followed
+    int32_t  x;             // shaped effector setpoint in microns
+    int32_t  y;
+    int32_t  z;
+    float    a1;            // joint angles in degrees sent to the servos, lag compensated
+    float    a2;
+    float    a3;
+} Position_Frame_t;
+
+// Sized so a packet of frames fits in a single UI packet
+#define UI_POSITION_FRAMES 3U
+
+typedef struct
+{
+    uint16_t         dropped;       // frames lost to a full ring since the stream was configured
+    uint8_t          count;         // frames in this packet
+    uint8_t          decimation;    // one frame per this many control ticks, zero when stopped
+    Position_Frame_t frames[UI_POSITION_FRAMES];
+} Position_Stream_t;
+
+// Sized so a chunk fits in a single UI packet
+#define UI_TRACE_CHUNK_RECORDS 8U
+
+typedef struct
+{
+    uint16_t         index;       // position of the first record, counted from the oldest in the trace
+    uint16_t         count;       // records in this chunk, short on the last chunk
+    uint16_t         total;       // records held in the trace
+    uint16_t         overhead;    // cycles taken to add one record
+    uint32_t         cpu_hz;      // converts cycle timestamps to time
+    EventTraceRecord records[UI_TRACE_CHUNK_RECORDS];
+} Trace_Chunk_t;
+
 typedef struct
 {
     // Dimensions used in the IK/FK calculations
@@ -103,10 +182,32 @@ typedef struct
 
 typedef struct
 {
-    uint8_t movements;
-    uint8_t lighting;
+    uint16_t movements;
+    uint16_t lighting;
+    uint16_t movement_credit;    // running count of moves the host may have sent
+    uint16_t lighting_credit;    // running count of fades the host may have sent
+    uint16_t motion_received;    // running count of moves which reached the hardware
+    uint8_t  motion_synced;      // the compact move stream has a starting point
+    uint8_t  motion_accepted;    // sequence of the last compact packet whose moves were all queued, 0 for none
+    uint8_t  motion_seen;        // sequence of the last compact packet looked at, 0 for none
+    uint8_t  padding;
 } QueueDepths_t;
 
+typedef struct
+{
+    uint8_t type;         // none, ZV, ZVD, EI
+    float   frequency;    // resonant frequency in Hz
+    float   damping;      // damping ratio 0.0 -> 1.0
+} InputShaperSettings_t;
+
+typedef struct
+{
+    float   peak_hz;          // frequency with the largest torque response
+    float   damping;          // damping ratio from the half-power bandwidth, 0 if the peak is at the edge of the sweep
+    float   peak_response;    // torque % per mm of drive amplitude at the peak
+    uint8_t progress;         // sweep completion percentage
+} ResonanceData_t;
+
 typedef struct
 {
     uint8_t enabled;
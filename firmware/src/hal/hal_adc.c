@@ -12,6 +12,7 @@
 
 #include "app_config.h"
 #include "average_short.h"
+#include "hal_isr_profile.h"
 #include "qassert.h"
 
 /* ---------------- Lower Level Peripheral ---------------------------------- */
@@ -328,6 +329,8 @@ hal_adc_tick( void )
 
 void ADC_IRQHandler( void )
 {
+    HAL_ISR_PROFILE_START();
+
     // ADC group regular overrun caused the ADC interruption
     if( LL_ADC_IsActiveFlag_OVR( ADC1 ) != 0 )
     {
@@ -337,10 +340,14 @@ void ADC_IRQHandler( void )
         // TODO Gracefully recover when ADC overrun error occurs
         asm( "nop" );
     }
+
+    HAL_ISR_PROFILE_END( HAL_ISR_ADC );
 }
 
 void DMA2_Stream0_IRQHandler( void )
 {
+    HAL_ISR_PROFILE_START();
+
     // DMA half transfer caused the DMA interruption
     if( LL_DMA_IsActiveFlag_HT0( DMA2 ) == 1 )
     {
@@ -392,6 +399,8 @@ void DMA2_Stream0_IRQHandler( void )
         // TODO Handle adc DMA errors?
         asm( "nop" );
     }
+
+    HAL_ISR_PROFILE_END( HAL_ISR_ADC_DMA );
 }
 
 /* ----- End ---------------------------------------------------------------- */
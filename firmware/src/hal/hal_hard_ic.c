@@ -11,6 +11,7 @@
 
 #include "hal_gpio.h"
 #include "hal_hard_ic.h"
+#include "hal_isr_profile.h"
 #include "qassert.h"
 
 /* ----- Defines ------------------------------------------------------------ */
@@ -282,35 +283,57 @@ hal_hard_ic_pwmic_irq_handler( InputCaptureSignal_t input, TIM_TypeDef *TIMx )
 // Servo 1 HLFB
 void TIM8_CC_IRQHandler( void )
 {
+    HAL_ISR_PROFILE_START();
+
     hal_hard_ic_pwmic_irq_handler( HAL_HARD_IC_HLFB_SERVO_1, TIM8 );
+
+    HAL_ISR_PROFILE_END( HAL_ISR_HLFB );
 }
 
 void TIM3_IRQHandler( void )
 {
+    HAL_ISR_PROFILE_START();
+
     hal_hard_ic_pwmic_irq_handler( HAL_HARD_IC_HLFB_SERVO_1, TIM3 );
+
+    HAL_ISR_PROFILE_END( HAL_ISR_HLFB );
 }
 
 // Servo 2 HLFB
 void TIM4_IRQHandler( void )
 {
+    HAL_ISR_PROFILE_START();
+
     hal_hard_ic_pwmic_irq_handler( HAL_HARD_IC_HLFB_SERVO_2, TIM4 );
+
+    HAL_ISR_PROFILE_END( HAL_ISR_HLFB );
 }
 
 // Servo 3 HLFB
 void TIM1_CC_IRQHandler( void )
 {
+    HAL_ISR_PROFILE_START();
+
     hal_hard_ic_pwmic_irq_handler( HAL_HARD_IC_HLFB_SERVO_3, TIM1 );
+
+    HAL_ISR_PROFILE_END( HAL_ISR_HLFB );
 }
 
 // Servo 4 HLFB
 void TIM5_IRQHandler( void )
 {
+    HAL_ISR_PROFILE_START();
+
     hal_hard_ic_pwmic_irq_handler( HAL_HARD_IC_HLFB_SERVO_4, TIM5 );
+
+    HAL_ISR_PROFILE_END( HAL_ISR_HLFB );
 }
 
 // Fan Hall sensor
 void TIM1_BRK_TIM9_IRQHandler( void )
 {
+    HAL_ISR_PROFILE_START();
+
     if( LL_TIM_IsActiveFlag_CC1( TIM9 ) )
     {
         LL_TIM_ClearFlag_CC1( TIM9 );
@@ -348,6 +371,8 @@ void TIM1_BRK_TIM9_IRQHandler( void )
             fan_state.first_edge_done = false;
         }
     }
+
+    HAL_ISR_PROFILE_END( HAL_ISR_FAN );
 }
 
 /* ----- End ---------------------------------------------------------------- */
@@ -0,0 +1,93 @@
+/* ----- System Includes ---------------------------------------------------- */
+
+#include <string.h>
+
+/* ----- Local Includes ----------------------------------------------------- */
+
+#include "hal_isr_profile.h"
+
+/* -------------------------------------------------------------------------- */
+
+typedef struct
+{
+    HalIsrStats_t stats;
+    uint32_t      busy_cycles;    // time spent in the handler since the previous read
+} HalIsrProfileEntry_t;
+
+PRIVATE HalIsrProfileEntry_t isr_profile[HAL_ISR_NUM];
+PRIVATE uint32_t             isr_profile_last_read;
+
+/* -------------------------------------------------------------------------- */
+
+PUBLIC void
+hal_isr_profile_init( void )
+{
+    memset( &isr_profile, 0, sizeof( isr_profile ) );
+    isr_profile_last_read = CYCLE_COUNT();
+}
+
+/* -------------------------------------------------------------------------- */
+
+PUBLIC void
+hal_isr_profile_record( HalIsrProfile_t isr, uint32_t start, uint32_t latency )
+{
+    uint32_t duration = CYCLE_COUNT() - start;
+
+    // Find the doubling bucket from the leading zeros, saturating at either end
+    int32_t bucket = ( 31 - __builtin_clz( duration | 1U ) ) - HAL_ISR_HISTOGRAM_SHIFT;
+    bucket         = CLAMP( bucket, 0, (int32_t)HAL_ISR_HISTOGRAM_BUCKETS - 1 );
+
+    HalIsrProfileEntry_t *me = &isr_profile[isr];
+
+    CRITICAL_SECTION_VAR();
+    CRITICAL_SECTION_START();
+
+    me->stats.count++;
+    me->busy_cycles += duration;
+
+    if( duration > me->stats.max_cycles )
+    {
+        me->stats.max_cycles = duration;
+    }
+
+    if( latency > me->stats.max_latency )
+    {
+        me->stats.max_latency = MIN( latency, UINT16_MAX );
+    }
+
+    if( me->stats.histogram[bucket] < UINT16_MAX )
+    {
+        me->stats.histogram[bucket]++;
+    }
+
+    CRITICAL_SECTION_END();
+}
+
+/* -------------------------------------------------------------------------- */
+
+PUBLIC void
+hal_isr_profile_read( HalIsrStats_t stats[HAL_ISR_NUM] )
+{
+    uint32_t now    = CYCLE_COUNT();
+    uint32_t window = now - isr_profile_last_read;
+
+    isr_profile_last_read = now;
+
+    for( uint8_t isr = 0; isr < HAL_ISR_NUM; isr++ )
+    {
+        HalIsrProfileEntry_t *me = &isr_profile[isr];
+
+        CRITICAL_SECTION_VAR();
+        CRITICAL_SECTION_START();
+
+        uint32_t busy = me->busy_cycles;
+        me->busy_cycles = 0;
+        memcpy( &stats[isr], &me->stats, sizeof( HalIsrStats_t ) );
+
+        CRITICAL_SECTION_END();
+
+        stats[isr].load = window ? (uint16_t)( ( (uint64_t)busy * 10000U ) / window ) : 0;
+    }
+}
+
+/* ----- End ---------------------------------------------------------------- */
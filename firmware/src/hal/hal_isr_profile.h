@@ -0,0 +1,75 @@
+#ifndef HAL_ISR_PROFILE_H
+#define HAL_ISR_PROFILE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ----- System Includes ---------------------------------------------------- */
+
+/* ----- Local Includes ----------------------------------------------------- */
+
+#include "global.h"
+
+/* ----- Defines ------------------------------------------------------------ */
+
+// Durations are binned in doubling buckets, starting with everything under 256 cycles
+#define HAL_ISR_HISTOGRAM_BUCKETS 6U
+#define HAL_ISR_HISTOGRAM_SHIFT   7U
+
+typedef enum
+{
+    HAL_ISR_SYSTICK = 0,
+    HAL_ISR_ADC,
+    HAL_ISR_ADC_DMA,
+    HAL_ISR_HLFB,             // servo feedback input capture timers
+    HAL_ISR_FAN,              // fan tacho input capture
+    HAL_ISR_UART_EXTERNAL,    // idle line, rx and tx dma handlers for each port
+    HAL_ISR_UART_INTERNAL,
+    HAL_ISR_UART_MODULE,
+    HAL_ISR_NUM
+} HalIsrProfile_t;
+
+typedef struct
+{
+    uint32_t count;
+    uint32_t max_cycles;
+    uint16_t max_latency;    // cycles from the interrupt firing to the handler starting, 0 when not measurable
+    uint16_t load;           // hundredths of a percent of cpu time since the previous read
+    uint16_t histogram[HAL_ISR_HISTOGRAM_BUCKETS];    // saturates at UINT16_MAX
+} HalIsrStats_t;
+
+// Place at the top of a handler, and call HAL_ISR_PROFILE_END before it returns
+#define HAL_ISR_PROFILE_START()     const uint32_t isr_profile_start = CYCLE_COUNT()
+#define HAL_ISR_PROFILE_END( _isr ) hal_isr_profile_record( ( _isr ), isr_profile_start, 0 )
+
+/* ----- Public Functions --------------------------------------------------- */
+
+PUBLIC void
+hal_isr_profile_init( void );
+
+/* -------------------------------------------------------------------------- */
+
+/** Add a handler run which started at the given cycle count.
+ *  Handlers sharing an entry can preempt each other, so the update is done
+ *  with interrupts masked. Preempted handlers include the time spent in the
+ *  higher priority handler. */
+
+PUBLIC void
+hal_isr_profile_record( HalIsrProfile_t isr, uint32_t start, uint32_t latency );
+
+/* -------------------------------------------------------------------------- */
+
+/** Copy out the statistics for all handlers. The load figures cover the time
+ *  since the previous read. */
+
+PUBLIC void
+hal_isr_profile_read( HalIsrStats_t stats[HAL_ISR_NUM] );
+
+/* ----- End ---------------------------------------------------------------- */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HAL_ISR_PROFILE_H */
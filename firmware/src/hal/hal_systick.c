@@ -5,6 +5,7 @@
 /* -------------------------------------------------------------------------- */
 
 #include "hal_systick.h"
+#include "hal_isr_profile.h"
 #include "qassert.h"
 #include "stm32f4xx_ll_cortex.h"
 #include "stm32f4xx_ll_rcc.h"
@@ -125,8 +126,15 @@ hal_systick_callback( void )
 
 void SysTick_Handler( void )
 {
+    HAL_ISR_PROFILE_START();
+
+    // The counter reloads as the interrupt fires, so the count since then is our entry latency
+    uint32_t latency = SysTick->LOAD - SysTick->VAL;
+
     tick_timer++;
     hal_systick_callback();
+
+    hal_isr_profile_record( HAL_ISR_SYSTICK, isr_profile_start, latency );
 }
 
 /* ----- End ---------------------------------------------------------------- */
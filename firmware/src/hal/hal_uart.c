@@ -17,6 +17,7 @@
 #include "global.h"
 #include "hal_gpio.h"
 #include "hal_uart.h"
+#include "hal_isr_profile.h"
 #include "qassert.h"
 
 /* ----- Private Data ------------------------------------------------------- */
@@ -25,10 +26,15 @@ DEFINE_THIS_FILE; /* Used for ASSERT checks to define __FILE__ only once */
 
 /* ----- Defines ------------------------------------------------------------ */
 
-#define HAL_UART_RX_FIFO_SIZE 250
-#define HAL_UART_TX_FIFO_SIZE 250
+// Received data is parsed straight out of the circular DMA buffer
+#define HAL_UART_RX_DMA_BUFFER_SIZE 512U
+#define HAL_UART_RX_DMA_BUFFER_MASK ( HAL_UART_RX_DMA_BUFFER_SIZE - 1U )
 
-#define HAL_UART_RX_DMA_BUFFER_SIZE 64
+// Unread data within this many bytes of being overwritten is treated as lost,
+// as the DMA keeps writing while the reader parses it. ~1ms at 500kbaud.
+#define HAL_UART_RX_DMA_GUARD 64U
+
+_Static_assert( ( HAL_UART_RX_DMA_BUFFER_SIZE & HAL_UART_RX_DMA_BUFFER_MASK ) == 0, "RX DMA buffer must be a power of two" );
 
 /* ----- Types -------------------------------------------------------------- */
 
@@ -49,12 +55,13 @@ typedef struct
     uint8_t  tx_buffer[HAL_UART_TX_FIFO_SIZE];
     uint16_t tx_sneak_bytes;
 
-    fifo_t  rx_fifo;
-    uint8_t rx_buffer[HAL_UART_RX_FIFO_SIZE];
-
-    // Raw DMA buffer,
-    volatile uint8_t dma_rx_buffer[HAL_UART_RX_DMA_BUFFER_SIZE];
-    uint32_t         dma_rx_pos;
+    // Circular DMA buffer. The head and tail count bytes since init and are
+    // only masked when indexing, so the full buffer is usable.
+    volatile uint8_t  dma_rx_buffer[HAL_UART_RX_DMA_BUFFER_SIZE];
+    uint32_t          dma_rx_pos;    // DMA write position when the head was last advanced
+    volatile uint32_t rx_head;       // advanced by the rx interrupts
+    uint32_t          rx_tail;       // advanced by the reader
+    uint32_t          rx_dropped;    // bytes discarded because they weren't read in time
 
 } HalUart_t;
 
@@ -85,6 +92,9 @@ hal_uart_completed_tx( HalUart_t *h );
 PRIVATE void
 hal_usart_irq_rx_handler( HalUart_t *h );
 
+PRIVATE uint32_t
+hal_uart_rx_check_overrun( HalUart_t *h );
+
 /* ----- USART Interface ---------------------------------------------------- */
 
 PUBLIC void
@@ -106,7 +116,6 @@ hal_uart_init( HalUartPort_t port )
             h->dma_channel_rx = LL_DMA_CHANNEL_4;
 
             fifo_init( &h->tx_fifo, h->tx_buffer, HAL_UART_TX_FIFO_SIZE );
-            fifo_init( &h->rx_fifo, h->rx_buffer, HAL_UART_RX_FIFO_SIZE );
 
             LL_APB1_GRP1_EnableClock( LL_APB1_GRP1_PERIPH_UART5 );
             LL_AHB1_GRP1_EnableClock( LL_AHB1_GRP1_PERIPH_DMA1 );
@@ -132,7 +141,6 @@ hal_uart_init( HalUartPort_t port )
             h->dma_channel_rx = LL_DMA_CHANNEL_4;
 
             fifo_init( &h->tx_fifo, h->tx_buffer, HAL_UART_TX_FIFO_SIZE );
-            fifo_init( &h->rx_fifo, h->rx_buffer, HAL_UART_RX_FIFO_SIZE );
 
             LL_APB2_GRP1_EnableClock( LL_APB2_GRP1_PERIPH_USART1 );
             LL_AHB1_GRP1_EnableClock( LL_AHB1_GRP1_PERIPH_DMA2 );
@@ -157,7 +165,6 @@ hal_uart_init( HalUartPort_t port )
             h->dma_channel_rx = LL_DMA_CHANNEL_4;
 
             fifo_init( &h->tx_fifo, h->tx_buffer, HAL_UART_TX_FIFO_SIZE );
-            fifo_init( &h->rx_fifo, h->rx_buffer, HAL_UART_RX_FIFO_SIZE );
 
             LL_APB1_GRP1_EnableClock( LL_APB1_GRP1_PERIPH_USART2 );
             LL_AHB1_GRP1_EnableClock( LL_AHB1_GRP1_PERIPH_DMA1 );
@@ -205,10 +212,10 @@ hal_uart_put( HalUartPort_t port, uint8_t ch )
 {
     HalUart_t *h = &hal_uart[port];
 
-    uint32_t sent = fifo_write( &h->tx_fifo, &ch, 1 );
+    bool sent = fifo_put( &h->tx_fifo, ch );
 
     hal_uart_start_tx( h );
-    return ( sent == 1 );
+    return sent;
 }
 
 /* -------------------------------------------------------------------------- */
@@ -240,9 +247,9 @@ hal_uart_put_blocking( HalUartPort_t port, uint8_t ch )
 
     uint32_t timeout = 100000;
     while( ( --timeout > 0 ) && ( fifo_free( &h->tx_fifo ) == 0 ) ) {}
-    uint32_t sent = fifo_write( &h->tx_fifo, &ch, 1 );
+    bool sent = fifo_put( &h->tx_fifo, ch );
     hal_uart_start_tx( h );
-    return ( sent == 1 );
+    return sent;
 }
 
 /* -------------------------------------------------------------------------- */
@@ -269,52 +276,117 @@ hal_uart_write( HalUartPort_t port, const uint8_t *data, uint32_t length )
 
 /* -------------------------------------------------------------------------- */
 
-/* Returns number of available characters in the RX FIFO queue. */
+/* Returns the space left in the UART tx FIFO queue. */
+
+PUBLIC uint32_t
+hal_uart_tx_free( HalUartPort_t port )
+{
+    HalUart_t *h = &hal_uart[port];
+
+    return fifo_free( &h->tx_fifo );
+}
+
+/* -------------------------------------------------------------------------- */
+
+/* Returns number of available characters in the RX buffer. */
 
 PUBLIC uint32_t
 hal_uart_rx_data_available( HalUartPort_t port )
 {
     HalUart_t *h = &hal_uart[port];
 
-    return fifo_used( &h->rx_fifo );
+    return hal_uart_rx_check_overrun( h );
 }
 
 /* -------------------------------------------------------------------------- */
 
-/* Retrieve a single byte from the rx FIFO queue.
+/* Retrieve a single byte from the rx buffer.
  * Returns 0 when no data is available
  */
 
 PUBLIC uint8_t
 hal_uart_rx_get( HalUartPort_t port )
 {
-    HalUart_t *h = &hal_uart[port];
-
     uint8_t c = 0;
-    fifo_read( &h->rx_fifo, &c, 1 );
+    hal_uart_read( port, &c, 1 );
 
     return c;
 }
 
 /* -------------------------------------------------------------------------- */
 
-/* Retrieve a number of bytes from the rx FIFO queue up to
+/* Retrieve a number of bytes from the rx buffer up to
  * buffer length. Returns the number of bytes actually read.
  */
 
 PUBLIC uint32_t
 hal_uart_read( HalUartPort_t port, uint8_t *data, uint32_t maxlength )
 {
-    HalUart_t *h = &hal_uart[port];
-    uint32_t   len;
+    const uint8_t *span = 0;
+    uint32_t       len  = 0;
+
+    while( len < maxlength )
+    {
+        uint32_t available = hal_uart_rx_span( port, &span );
+
+        if( !available )
+        {
+            break;
+        }
 
-    len = fifo_read( &h->rx_fifo, data, maxlength );
+        available = MIN( available, maxlength - len );
+        memcpy( &data[len], span, available );
+        hal_uart_rx_consume( port, available );
+        len += available;
+    }
 
     return len;
 }
 
 /* -------------------------------------------------------------------------- */
 
+/* Point at the oldest unread bytes in the rx buffer. Returns how many bytes
+ * can be read contiguously from there, which stops short at the end of the
+ * buffer. Call hal_uart_rx_consume once they have been parsed.
+ */
+
+PUBLIC uint32_t
+hal_uart_rx_span( HalUartPort_t port, const uint8_t **data )
+{
+    HalUart_t *h = &hal_uart[port];
+
+    uint32_t available = hal_uart_rx_check_overrun( h );
+    uint32_t tail      = h->rx_tail & HAL_UART_RX_DMA_BUFFER_MASK;
+
+    *data = (const uint8_t *)&h->dma_rx_buffer[tail];
+
+    return MIN( available, HAL_UART_RX_DMA_BUFFER_SIZE - tail );
+}
+
+/* -------------------------------------------------------------------------- */
+
+PUBLIC void
+hal_uart_rx_consume( HalUartPort_t port, uint32_t length )
+{
+    HalUart_t *h = &hal_uart[port];
+
+    h->rx_tail += length;
+}
+
+/* -------------------------------------------------------------------------- */
+
+/* Returns the number of bytes lost because they weren't read in time. */
+
+PUBLIC uint32_t
+hal_uart_rx_dropped( HalUartPort_t port )
+{
+    HalUart_t *h = &hal_uart[port];
+
+    return h->rx_dropped;
+}
+
+/* -------------------------------------------------------------------------- */
+
 PRIVATE void
 hal_uart_dma_init( HalUartPort_t port )
 {
@@ -568,7 +640,9 @@ hal_uart_start_tx( HalUart_t *h )
     /* If transfer is not on-going */
     if( !LL_DMA_IsEnabledStream( h->dma_peripheral, h->dma_stream_tx ) )
     {
-        h->tx_sneak_bytes = fifo_used_linear( &h->tx_fifo );
+        const uint8_t *ptr = NULL;
+
+        h->tx_sneak_bytes = fifo_peek_span( &h->tx_fifo, &ptr );
 
         // Limit maximum size to transmit at a time
         if( h->tx_sneak_bytes > 32 )
@@ -576,11 +650,9 @@ hal_uart_start_tx( HalUart_t *h )
             h->tx_sneak_bytes = 32;
         }
 
-        // Transmit remaining data
+        // Transmit remaining data, straight out of the fifo until it's skipped on completion
         if( h->tx_sneak_bytes > 0 )
         {
-            void *ptr = fifo_get_tail_ptr( &h->tx_fifo, h->tx_sneak_bytes );
-
             LL_DMA_SetDataLength( h->dma_peripheral, h->dma_stream_tx, h->tx_sneak_bytes );
             LL_DMA_SetMemoryAddress( h->dma_peripheral, h->dma_stream_tx, (uint32_t)ptr );
 
@@ -603,43 +675,50 @@ hal_uart_completed_tx( HalUart_t *h )
 
 /* ------------------------------------------------------------------*/
 
-// Tracks data handled by RX DMA and passes data off for higher-level storage/parsing etc.
-// Called when the RX DMA interrupts for half or full buffer fire, and when line-idle occurs
+// Publishes data written by the RX DMA to the reader, nothing is copied.
+// Called when the RX DMA interrupts for half or full buffer fire, and when line-idle occurs,
+// and by the reader with interrupts masked.
 
 PRIVATE void
 hal_usart_irq_rx_handler( HalUart_t *h )
 {
-    // Calculate current head index
-    uint32_t current_pos = HAL_UART_RX_DMA_BUFFER_SIZE - LL_DMA_GetDataLength( h->dma_peripheral, h->dma_stream_rx );
+    // Calculate current head index, the counter reloads to the full length at the end of the buffer
+    uint32_t current_pos = ( HAL_UART_RX_DMA_BUFFER_SIZE - LL_DMA_GetDataLength( h->dma_peripheral, h->dma_stream_rx ) )
+                           & HAL_UART_RX_DMA_BUFFER_MASK;
 
-    // Has DMA given us new data?
-    if( current_pos != h->dma_rx_pos )
-    {
-        // Data hasn't hit the end yet
-        if( current_pos > h->dma_rx_pos )
-        {
-            fifo_write( &h->rx_fifo, (const uint8_t *)&h->dma_rx_buffer[h->dma_rx_pos], current_pos - h->dma_rx_pos );
-        }
-        else    // circular buffer overflowed
-        {
-            // Read to the end of the buffer
-            fifo_write( &h->rx_fifo, (const uint8_t *)&h->dma_rx_buffer[h->dma_rx_pos], DIM( h->dma_rx_buffer ) - h->dma_rx_pos );
-
-            // Read from the start of the buffer to the current head
-            if( current_pos > 0 )
-            {
-                fifo_write( &h->rx_fifo, (const uint8_t *)&h->dma_rx_buffer[0], current_pos );
-            }
-        }
-    }
-    // Remember the current head position
+    // The half and full transfer interrupts make sure the DMA can't lap a whole buffer between calls
+    h->rx_head += ( current_pos - h->dma_rx_pos ) & HAL_UART_RX_DMA_BUFFER_MASK;
     h->dma_rx_pos = current_pos;
+}
+
+/* -------------------------------------------------------------------------- */
+
+// Returns the number of unread bytes. If the DMA is about to write over data
+// which wasn't read in time, everything pending is discarded and the packet
+// parser resynchronises on the next frame.
+
+PRIVATE uint32_t
+hal_uart_rx_check_overrun( HalUart_t *h )
+{
+    // Pick up bytes received since the last interrupt, rather than waiting for the line to go idle
+    CRITICAL_SECTION_VAR();
+    CRITICAL_SECTION_START();
+    hal_usart_irq_rx_handler( h );
+    CRITICAL_SECTION_END();
+
+    uint32_t available = h->rx_head - h->rx_tail;
+
+    // Don't read buffer contents ahead of the head
+    MEMORY_BARRIER();
 
-    // Check if we've reached the end of the buffer, move the head to the start
-    if( h->dma_rx_pos == HAL_UART_RX_DMA_BUFFER_SIZE )
+    if( available > HAL_UART_RX_DMA_BUFFER_SIZE - HAL_UART_RX_DMA_GUARD )
     {
-        h->dma_rx_pos = 0;
+        h->rx_dropped += available;
+        h->rx_tail += available;
+        available = 0;
     }
+
+    return available;
 }
 
 /* -------------------------------------------------------------------------- */
@@ -647,6 +726,8 @@ hal_usart_irq_rx_handler( HalUart_t *h )
 PUBLIC void
 UART5_IRQHandler( void )
 {
+    HAL_ISR_PROFILE_START();
+
     // Idle line interrupt occurs when the UART RX line has been high for more than one frame
     if( LL_USART_IsEnabledIT_IDLE( UART5 ) && LL_USART_IsActiveFlag_IDLE( UART5 ) )
     {
@@ -656,11 +737,15 @@ UART5_IRQHandler( void )
         // Check for data to process
         hal_usart_irq_rx_handler( &hal_uart[HAL_UART_PORT_EXTERNAL] );
     }
+
+    HAL_ISR_PROFILE_END( HAL_ISR_UART_EXTERNAL );
 }
 
 // RX
 void DMA1_Stream0_IRQHandler( void )
 {
+    HAL_ISR_PROFILE_START();
+
     // Half transfer complete
     if( LL_DMA_IsEnabledIT_HT( DMA1, LL_DMA_STREAM_0 ) && LL_DMA_IsActiveFlag_HT0( DMA1 ) )
     {
@@ -676,11 +761,15 @@ void DMA1_Stream0_IRQHandler( void )
         LL_DMA_ClearFlag_TC0( DMA1 );
         hal_usart_irq_rx_handler( &hal_uart[HAL_UART_PORT_EXTERNAL] );
     }
+
+    HAL_ISR_PROFILE_END( HAL_ISR_UART_EXTERNAL );
 }
 
 // TX
 void DMA1_Stream7_IRQHandler( void )
 {
+    HAL_ISR_PROFILE_START();
+
     // Transfer complete
     if( LL_DMA_IsEnabledIT_TC( DMA1, LL_DMA_STREAM_7 ) && LL_DMA_IsActiveFlag_TC7( DMA1 ) )
     {
@@ -689,22 +778,30 @@ void DMA1_Stream7_IRQHandler( void )
         // Flush the data we just finished transferring, and send more as needed
         hal_uart_completed_tx( &hal_uart[HAL_UART_PORT_EXTERNAL] );
     }
+
+    HAL_ISR_PROFILE_END( HAL_ISR_UART_EXTERNAL );
 }
 
 /* -------------------------------------------------------------------------- */
 
 void USART1_IRQHandler( void )
 {
+    HAL_ISR_PROFILE_START();
+
     if( LL_USART_IsEnabledIT_IDLE( USART1 ) && LL_USART_IsActiveFlag_IDLE( USART1 ) )
     {
         LL_USART_ClearFlag_IDLE( USART1 );
         hal_usart_irq_rx_handler( &hal_uart[HAL_UART_PORT_INTERNAL] );
     }
+
+    HAL_ISR_PROFILE_END( HAL_ISR_UART_INTERNAL );
 }
 
 // RX
 void DMA2_Stream2_IRQHandler( void )
 {
+    HAL_ISR_PROFILE_START();
+
     // Half transfer complete
     if( LL_DMA_IsEnabledIT_HT( DMA2, LL_DMA_STREAM_2 ) && LL_DMA_IsActiveFlag_HT2( DMA2 ) )
     {
@@ -718,33 +815,45 @@ void DMA2_Stream2_IRQHandler( void )
         LL_DMA_ClearFlag_TC2( DMA2 );
         hal_usart_irq_rx_handler( &hal_uart[HAL_UART_PORT_INTERNAL] );
     }
+
+    HAL_ISR_PROFILE_END( HAL_ISR_UART_INTERNAL );
 }
 
 // TX
 void DMA2_Stream7_IRQHandler( void )
 {
+    HAL_ISR_PROFILE_START();
+
     if( LL_DMA_IsEnabledIT_TC( DMA2, LL_DMA_STREAM_7 ) && LL_DMA_IsActiveFlag_TC7( DMA2 ) )
     {
         LL_DMA_ClearFlag_TC7( DMA2 );
         hal_uart_completed_tx( &hal_uart[HAL_UART_PORT_INTERNAL] );
     }
+
+    HAL_ISR_PROFILE_END( HAL_ISR_UART_INTERNAL );
 }
 
 /* -------------------------------------------------------------------------- */
 
 void USART2_IRQHandler( void )
 {
+    HAL_ISR_PROFILE_START();
+
     /* Check for IDLE line interrupt */
     if( LL_USART_IsEnabledIT_IDLE( USART2 ) && LL_USART_IsActiveFlag_IDLE( USART2 ) )
     {
         LL_USART_ClearFlag_IDLE( USART2 );
         hal_usart_irq_rx_handler( &hal_uart[HAL_UART_PORT_MODULE] );
     }
+
+    HAL_ISR_PROFILE_END( HAL_ISR_UART_MODULE );
 }
 
 // RX
 void DMA1_Stream5_IRQHandler( void )
 {
+    HAL_ISR_PROFILE_START();
+
     // Half-transfer complete interrupt
     if( LL_DMA_IsEnabledIT_HT( DMA1, LL_DMA_STREAM_5 ) && LL_DMA_IsActiveFlag_HT5( DMA1 ) )
     {
@@ -758,17 +867,23 @@ void DMA1_Stream5_IRQHandler( void )
         LL_DMA_ClearFlag_TC5( DMA1 );
         hal_usart_irq_rx_handler( &hal_uart[HAL_UART_PORT_MODULE] );
     }
+
+    HAL_ISR_PROFILE_END( HAL_ISR_UART_MODULE );
 }
 
 // TX
 void DMA1_Stream6_IRQHandler( void )
 {
+    HAL_ISR_PROFILE_START();
+
     // Check transfer-complete interrupt
     if( LL_DMA_IsEnabledIT_TC( DMA1, LL_DMA_STREAM_6 ) && LL_DMA_IsActiveFlag_TC6( DMA1 ) )
     {
         LL_DMA_ClearFlag_TC6( DMA1 );
         hal_uart_completed_tx( &hal_uart[HAL_UART_PORT_MODULE] );
     }
+
+    HAL_ISR_PROFILE_END( HAL_ISR_UART_MODULE );
 }
 
 /* ----- End ---------------------------------------------------------------- */
@@ -12,6 +12,10 @@ extern "C" {
 #include "global.h"
 #include "stm32f4xx_ll_gpio.h"
 
+/* ----- Defines ------------------------------------------------------------ */
+
+#define HAL_UART_TX_FIFO_SIZE 256    // a power of two
+
 /* ----- Types ------------------------------------------------------------- */
 
 typedef enum
@@ -75,14 +79,21 @@ hal_uart_write( HalUartPort_t port, const uint8_t *data, uint32_t length );
 
 /* -------------------------------------------------------------------------- */
 
-/* Returns number of available characters in the RX FIFO queue. */
+/* Returns the space left in the UART tx FIFO queue. */
+
+PUBLIC uint32_t
+hal_uart_tx_free( HalUartPort_t port );
+
+/* -------------------------------------------------------------------------- */
+
+/* Returns number of available characters in the RX buffer. */
 
 PUBLIC uint32_t
 hal_uart_rx_data_available( HalUartPort_t port );
 
 /* -------------------------------------------------------------------------- */
 
-/* Retrieve a single byte from the rx FIFO queue.
+/* Retrieve a single byte from the rx buffer.
  * Returns 0 when no data is available or when rx callback is in use.
  */
 
@@ -91,7 +102,7 @@ hal_uart_rx_get( HalUartPort_t port );
 
 /* -------------------------------------------------------------------------- */
 
-/* Retrieve a number of bytes from the rx FIFO queue up to
+/* Retrieve a number of bytes from the rx buffer up to
  * buffer length. Returns the number of bytes actually read.
  */
 
@@ -100,6 +111,31 @@ hal_uart_read( HalUartPort_t port, uint8_t *buffer, uint32_t bufferlen );
 
 /* -------------------------------------------------------------------------- */
 
+/* Point at the oldest unread bytes, which are read in place from the DMA
+ * buffer. Returns how many bytes are contiguous from there, 0 when empty.
+ * The span stops at the end of the buffer, so call again after consuming it
+ * to get any data which wrapped around to the start.
+ */
+
+PUBLIC uint32_t
+hal_uart_rx_span( HalUartPort_t port, const uint8_t **data );
+
+/* -------------------------------------------------------------------------- */
+
+/* Release bytes from the front of the span once they have been parsed. */
+
+PUBLIC void
+hal_uart_rx_consume( HalUartPort_t port, uint32_t length );
+
+/* -------------------------------------------------------------------------- */
+
+/* Returns the number of bytes lost because they weren't read in time. */
+
+PUBLIC uint32_t
+hal_uart_rx_dropped( HalUartPort_t port );
+
+/* -------------------------------------------------------------------------- */
+
 void UART5_IRQHandler( void );
 
 void USART1_IRQHandler( void );
@@ -80,6 +80,7 @@ eventPoolInit( EventPool eventPools[],
 
     REQUIRE( eventPools );
     REQUIRE( numberOfPools > 0 );
+    REQUIRE( numberOfPools <= EVENT_POOL_MAX );
 
     // Init the EventPool structures for the whole array
     for( i = 0; i < numberOfPools; i++ )
@@ -132,7 +133,8 @@ eventPoolAddStorage( StateEvent     *poolStorage,
 PUBLIC StateEvent *
 eventPoolNewEvent( uint16_t eventSize, Signal signal )
 {
-    uint8_t i;
+    uint8_t   i;
+    EventPool *bestFit = 0;
 
     REQUIRE( eventSize > 0 );
 
@@ -144,11 +146,25 @@ eventPoolNewEvent( uint16_t eventSize, Signal signal )
         // for this event?
         if( (p->eventSize > 0) && (p->eventSize >= eventSize) )
         {
+            // Pools are in ascending size, so the first match is the
+            // pool this event type was sized for.
+            if( bestFit == 0 )
+            {
+                bestFit = p;
+            }
+
             // Try allocating one from this pool. If exhausted we
             // allocate from the next pool with bigger events.
             StateEvent *e = eventPoolGet( p );
             if( e )
             {
+                // Keep track of events that didn't fit their own pool
+                // as it means the pool is undersized.
+                if( p != bestFit )
+                {
+                    bestFit->spilledEvents++;
+                }
+
                 // We got an event allocated, so record the details with
                 // the event.
                 e->signal           = signal; // set signal for this event
@@ -163,6 +179,11 @@ eventPoolNewEvent( uint16_t eventSize, Signal signal )
     // of the large pool event size.
     ASSERT( eventSize <= eventPool[eventPoolMax-1].eventSize );
 
+    if( bestFit )
+    {
+        bestFit->failedEvents++;
+    }
+
     // Ran out of memory - either the pools are too small or
     // something is not freeing the events.
     ASSERT( false );
@@ -173,6 +194,18 @@ eventPoolNewEvent( uint16_t eventSize, Signal signal )
 
 /* -------------------------------------------------------------------------- */
 
+PUBLIC const EventPool *
+eventPoolGetPool( uint8_t index )
+{
+    if( ( index < eventPoolMax ) && ( eventPool[index].eventSize > 0 ) )
+    {
+        return &eventPool[index];
+    }
+    return 0;
+}
+
+/* -------------------------------------------------------------------------- */
+
 PUBLIC void
 eventPoolDeleteEvent( StateEvent *e )
 {
@@ -238,6 +271,8 @@ eventPoolCreate( EventPool  *pool,
     pool->freeEvents       = numberOfEvents; // store number of free events
     pool->minimumEvents    = numberOfEvents; // the minimum number of free events
     pool->minimumEventSize = 0;              // the actual used maximum size for events in this pool
+    pool->spilledEvents    = 0;              // no allocations passed on yet
+    pool->failedEvents     = 0;              // no allocations failed yet
 
     block = (char *)poolStorage;
     while (--numberOfEvents != 0)          // chain all blocks in the free-list...
@@ -55,8 +55,13 @@ struct EventPool
   uint16_t freeEvents;       //!< number of free blocks remaining
   uint16_t minimumEvents;    //!< minimum number of free blocks
   uint16_t minimumEventSize; //!< minimum used size for event (in bytes)
+  uint16_t spilledEvents;    //!< allocations passed on to a bigger pool
+  uint16_t failedEvents;     //!< allocations that found no free block at all
 };
 
+//! Maximum number of pools, limited by the size of Event.dynamic.poolId
+#define EVENT_POOL_MAX  7U
+
 /* ----- Public Functions --------------------------------------------------- */
 
 /** Initialise a event pool table.
@@ -106,6 +111,14 @@ eventPoolNewEvent( uint16_t eventSize, Signal signal );
 
 /* -------------------------------------------------------------------------- */
 
+/** Return the pool at the indicated index in the pool table, or NULL when
+ *  there is no such pool. Used to report the pool usage statistics.
+ */
+PUBLIC const EventPool *
+eventPoolGetPool( uint8_t index );
+
+/* -------------------------------------------------------------------------- */
+
 /** Macro to delete a previously allocate but unused event.
  *  Really more for consistency with the EVENT_NEW macros.
  */
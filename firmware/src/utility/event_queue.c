@@ -30,7 +30,7 @@ DEFINE_THIS_FILE; /* Used for ASSERT checks to define __FILE__ only once */
 
 PUBLIC EventQueue *eventQueueInit( EventQueue * restrict me,
                                    StateEvent * restrict queueStorage[],
-                                   uint8_t    num_entries )
+                                   uint16_t   num_entries )
 {
     REQUIRE(me);
 
@@ -70,7 +70,7 @@ PUBLIC EventQueue *eventQueueInit( EventQueue * restrict me,
 //! Return the number events in the queue. 0 when none. The frontEvt
 /// pointer keeps an extra event just outside the queue so we have to
 /// adjust the nUsed count for this.
-PUBLIC uint8_t
+PUBLIC uint16_t
 eventQueueUsed( EventQueue * restrict queue )
 {
     if( queue && queue->front )
@@ -94,9 +94,6 @@ eventQueueGet( EventQueue * restrict queue )
     // Must actually have queue storage
     REQUIRE( (queue->entries) && (queue->size > 0) );
 
-    CRITICAL_SECTION_VAR();
-    CRITICAL_SECTION_START();
-
     // Get the front event
     e = queue->front;
 
@@ -117,8 +114,6 @@ eventQueueGet( EventQueue * restrict queue )
         queue->front = NULL;
     }
 
-    CRITICAL_SECTION_END();
-
     return e;
 }
 
@@ -149,9 +144,6 @@ eventQueuePutFIFO( EventQueue * restrict queue, StateEvent * restrict e )
     REQUIRE( (queue->entries) && (queue->size > 0) );
     REQUIRE( e );
 
-    CRITICAL_SECTION_VAR();
-    CRITICAL_SECTION_START();
-
     // If this is a dynamic allocated event,
     // update the reference count for this event
     if( e->dynamic.poolId != 0 )
@@ -195,7 +187,6 @@ eventQueuePutFIFO( EventQueue * restrict queue, StateEvent * restrict e )
             eventQueued = false;
         }
     }
-    CRITICAL_SECTION_END();
     return eventQueued;
 }
 
@@ -215,9 +206,6 @@ eventQueuePutLIFO( EventQueue * restrict queue, StateEvent * restrict e )
     // Must actually have queue storage
     REQUIRE(queue->entries);
 
-    CRITICAL_SECTION_VAR();
-    CRITICAL_SECTION_START();
-
     // If this is a dynamic allocated event,
     // update the reference count for this event
     if(e->dynamic.poolId != 0)
@@ -266,7 +254,6 @@ eventQueuePutLIFO( EventQueue * restrict queue, StateEvent * restrict e )
             eventQueued = false;
         }
     }
-    CRITICAL_SECTION_END();
     return eventQueued;
 }
 
@@ -282,15 +269,10 @@ eventQueueFlush( EventQueue * restrict queue )
     ASSERT(0);  // TBD This should really recycle the events that are in the
                 // queue instead of just resetting the pointers.
 
-    CRITICAL_SECTION_VAR();
-    CRITICAL_SECTION_START();
-
     queue->head  = 0;
     queue->tail  = 0;
     queue->front = NULL;
     queue->used  = 0;
-
-    CRITICAL_SECTION_END();
 }
 
 /* ----- End ---------------------------------------------------------------- */
@@ -32,16 +32,19 @@ extern "C" {
 
 /* ----- Types -------------------------------------------------------------- */
 
+/** Task event queues are only accessed from the main loop, so they don't
+ *  mask interrupts. Interrupt handlers publish through the lock-free event
+ *  inbox in event_subscribe instead of posting to a queue directly.
+ */
 typedef struct EventQueue EventQueue;
 struct EventQueue
 {
-    uint8_t     size;         ///< pointer to the end of the ring buffer
-    uint8_t     head;         ///< pointer to where next event will be inserted
-    uint8_t     tail;         ///< pointer to where next event will be extracted
+    uint16_t    size;         ///< pointer to the end of the ring buffer
+    uint16_t    head;         ///< pointer to where next event will be inserted
+    uint16_t    tail;         ///< pointer to where next event will be extracted
 
-    uint8_t     nTotal;       ///< total # of entries in the buffer
-    uint8_t     used;         ///< # of elements used in the buffer
-    uint8_t     max;          ///< maximum # of events ever in the buffer
+    uint16_t    used;         ///< # of elements used in the buffer
+    uint16_t    max;          ///< maximum # of events ever in the buffer
     StateEvent  * restrict front;       ///< pointer to event at the front of the queue
     StateEvent  * restrict *entries;    ///< pointer to event pointer array
 };
@@ -52,10 +55,10 @@ struct EventQueue
 PUBLIC EventQueue *
 eventQueueInit( EventQueue * restrict queue,
                 StateEvent * restrict queueStorage[],
-                uint8_t    num_entries );
+                uint16_t   num_entries );
 
 //! Return the number events in the queue. 0 when none
-PUBLIC uint8_t
+PUBLIC uint16_t
 eventQueueUsed( EventQueue * restrict queue );
 
 //! Retrieve an event from the queue
@@ -28,6 +28,27 @@ PRIVATE EventSubscribers *eventSubscribersList; /** pointer to signals subscript
 PRIVATE uint8_t          locMaxSignal;          /** max signals in list */
 PRIVATE StateTask        **eventTaskTable;      /** Table of tasks pointers */
 
+//! Interrupt handlers can't post to the task queues directly, so their events
+/// are passed to the main loop through a ring. Publishing interrupts can run
+/// at any priority, so a put claims its slot by moving the head on with a
+/// compare and swap, retrying if another interrupt got there first, then
+/// fills it. A slot holding an event is ready, so the main loop stops at one
+/// that's claimed but not yet filled, and empties each slot before moving the
+/// tail past it. Neither side masks interrupts.
+#define EVENT_INBOX_SIZE  32U   // must be a power of 2
+
+PRIVATE const StateEvent * volatile eventInbox[EVENT_INBOX_SIZE];
+PRIVATE volatile uint32_t eventInboxHead;   /** claimed by interrupts only */
+PRIVATE volatile uint32_t eventInboxTail;   /** written by the main loop only */
+
+/* ----- Private Prototypes ------------------------------------------------- */
+
+PRIVATE bool
+eventDeliver( const StateEvent *e, bool *success );
+
+PRIVATE bool
+eventInboxPut( const StateEvent *e );
+
 /* ----- Public Functions --------------------------------------------------- */
 
 //! Init the event subscribers table
@@ -45,6 +66,10 @@ eventSubscribeInit( StateTask      **tasksTable,
 
     // Clean out the subscribers table
     memset( eventSubscribersList, 0, sizeof(EventSubscribers) * maxSignals );
+
+    memset( (void *)eventInbox, 0, sizeof(eventInbox) );
+    eventInboxHead = 0;
+    eventInboxTail = 0;
 }
 
 /* -------------------------------------------------------------------------- */
@@ -87,7 +112,8 @@ eventUnsubscribe( StateTask    *t,
 
 //! Publish an event to the subscribers list. When there are no subscribers
 /// to this event, or none of the subscriber queues can take the event, the
-/// event is recycled.
+/// event is recycled. When called from an interrupt handler, the event is
+/// published later from the main loop by eventPublishDeferred.
 /// Without asserts, a NULL event is silently ignored.
 /// Returns true when event is delivered to all subscribers (incl. when
 /// there are no subscribers at all). False when there was a problem with
@@ -96,52 +122,30 @@ PUBLIC bool
 eventPublish( const StateEvent *e )
 {
     register bool fully_delivered = true;
-    EventSubscribers eventSubscribers;
 
     REQUIRE( e );                           // Is this pointing to something
     REQUIRE( e->signal < locMaxSignal );    // Is this a valid signal?
     REQUIRE( e->dynamic.useCount == 0 );    // Don't publish an event that
                                             // is already in use!
 
-    if( e ) // Silently ignore NULL events if asserts are not used.
+    if( e && IN_INTERRUPT() )
     {
-        // Lookup the subscribers list for this event
-        eventSubscribers = eventSubscribersList[e->signal];
-
-        if( eventSubscribers != 0 ) // any subscribers?
+        // Defer to the main loop, see eventPublishDeferred
+        fully_delivered = eventInboxPut( e );
+        if( !fully_delivered )
         {
-            bool success = false;
-
-            while( eventSubscribers > 0 )
-            {
-                register uint8_t p;
-                p = bitsetHighest( &eventSubscribers );
-                bitsetClear( &eventSubscribers, p );
-                ASSERT( eventTaskTable[p] );  // check if task is active
-                                              // check queue can take event
-                if( stateTaskPostFIFO( eventTaskTable[ p ], e ) )
-                {
-                    // Keep track that event is in on a task queue now.
-                    // So we don't have to recycle it below.
-                    success = true;
-                }
-                else
-                {
-                    // Failed to deliver event to subscribed queue
-                    // (queue is full)
-                    fully_delivered = false;
-//                    ASSERT_PRINTF( false, "e=%d, t=%d", e->signal, p );
-                }
-            }
-
-            // None of the publishing queues were able to take the event
-            // so ensure that we recycle it
-            if( !success )
-            {
-                EVENT_DELETE( e );
-            }
+            EVENT_DELETE( e );
         }
-        else // no subscribers, recycle immediately
+    }
+    else if( e ) // Silently ignore NULL events if asserts are not used.
+    {
+        bool success = false;
+
+        fully_delivered = eventDeliver( e, &success );
+
+        // None of the publishing queues were able to take the event
+        // (or there were no subscribers) so ensure that we recycle it
+        if( !success )
         {
             EVENT_DELETE( e );
         }
@@ -149,4 +153,125 @@ eventPublish( const StateEvent *e )
     return fully_delivered;
 }
 
+/* -------------------------------------------------------------------------- */
+
+//! Publish an event that is being handled by the calling task under a new
+/// signal, so the event is passed on by reference instead of copying it into
+/// a new event. The caller must be the only holder of the event. The event
+/// is recycled by the caller's garbage collection when no subscriber took it.
+/// Returns true when event is delivered to all subscribers.
+PUBLIC bool
+eventForward( const StateEvent *e, const Signal signal )
+{
+    bool success = false;
+
+    REQUIRE( e );
+    REQUIRE( signal < locMaxSignal );
+    REQUIRE( e->dynamic.poolId != 0 );      // Static events can't be re-signalled
+    REQUIRE( e->dynamic.useCount == 1 );    // Only held by the calling task
+
+    ((StateEvent *)e)->signal = signal;
+
+    return eventDeliver( e, &success );
+}
+
+/* -------------------------------------------------------------------------- */
+
+//! Publish the events that interrupt handlers passed to eventPublish. To be
+/// called from the main loop before dispatching events.
+PUBLIC void
+eventPublishDeferred( void )
+{
+    uint32_t tail = eventInboxTail;
+
+    for( ;; )
+    {
+        const StateEvent *e = eventInbox[tail & ( EVENT_INBOX_SIZE - 1 )];
+
+        // Claimed slots are filled in order of claiming, so stop at the first
+        // one that isn't filled yet and pick it up next time
+        if( !e )
+        {
+            break;
+        }
+
+        // Don't read the event before seeing the entry that hands it over
+        MEMORY_BARRIER();
+        eventInbox[tail & ( EVENT_INBOX_SIZE - 1 )] = NULL;
+
+        // Release the slot before publishing, as publishing can take a while
+        MEMORY_BARRIER();
+        eventInboxTail = ++tail;
+
+        eventPublish( e );
+    }
+}
+
+/* ----- Private Functions -------------------------------------------------- */
+
+//! Add an event to the inbox from interrupt context. Returns false when full.
+PRIVATE bool
+eventInboxPut( const StateEvent *e )
+{
+    uint32_t head;
+
+    // A higher priority interrupt can claim the slot between reading the head
+    // and moving it on, the swap fails then and the next slot is tried
+    do
+    {
+        head = eventInboxHead;
+
+        if( ( head - eventInboxTail ) >= EVENT_INBOX_SIZE )
+        {
+            return false;
+        }
+    } while( !COMPARE_AND_SWAP( &eventInboxHead, head, head + 1 ) );
+
+    // The event must be complete before the main loop can see the entry
+    MEMORY_BARRIER();
+    eventInbox[head & ( EVENT_INBOX_SIZE - 1 )] = e;
+
+    return true;
+}
+
+/* -------------------------------------------------------------------------- */
+
+//! Post an event onto the queue of every subscriber of its signal. Sets
+/// success when at least one queue took the event.
+/// Returns true when event is delivered to all subscribers (incl. when
+/// there are no subscribers at all).
+PRIVATE bool
+eventDeliver( const StateEvent *e, bool *success )
+{
+    register bool fully_delivered = true;
+    EventSubscribers eventSubscribers;
+
+    // Lookup the subscribers list for this event
+    eventSubscribers = eventSubscribersList[e->signal];
+
+    while( eventSubscribers > 0 )
+    {
+        register uint8_t p;
+        p = bitsetHighest( &eventSubscribers );
+        bitsetClear( &eventSubscribers, p );
+        ASSERT( eventTaskTable[p] );  // check if task is active
+                                      // check queue can take event
+        if( stateTaskPostFIFO( eventTaskTable[ p ], e ) )
+        {
+            // Keep track that event is in on a task queue now.
+            // So we don't have to recycle it.
+            *success = true;
+        }
+        else
+        {
+            // Failed to deliver event to subscribed queue
+            // (queue is full)
+            fully_delivered = false;
+//            ASSERT_PRINTF( false, "e=%d, t=%d", e->signal, p );
+        }
+    }
+
+    return fully_delivered;
+}
+
 /* ----- End ---------------------------------------------------------------- */
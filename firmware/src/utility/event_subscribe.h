@@ -56,7 +56,8 @@ eventUnsubscribe( StateTask         *t,
 
 //! Publish an event to the subscribers list. When there are no subscribers
 /// to this event, or none of the subscriber queues can take the event, the
-/// event is recycled.
+/// event is recycled. When called from an interrupt handler, the event is
+/// published later from the main loop by eventPublishDeferred.
 /// Without asserts, a NULL event is silently ignored.
 /// Returns true when event is delivered to all subscribers (incl. when
 /// there are no subscribers at all). False when there was a problem with
@@ -64,6 +65,19 @@ eventUnsubscribe( StateTask         *t,
 PUBLIC bool
 eventPublish( const StateEvent *e );
 
+//! Publish an event that is being handled by the calling task under a new
+/// signal, so the event is passed on by reference instead of copying it into
+/// a new event. The caller must be the only holder of the event. The event
+/// is recycled by the caller's garbage collection when no subscriber took it.
+/// Returns true when event is delivered to all subscribers.
+PUBLIC bool
+eventForward( const StateEvent *e, const Signal signal );
+
+//! Publish the events that interrupt handlers passed to eventPublish. To be
+/// called from the main loop before dispatching events.
+PUBLIC void
+eventPublishDeferred( void );
+
 /* ----------------------- End --------------------------------------------- */
 
 #ifdef __cplusplus
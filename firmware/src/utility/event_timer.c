@@ -21,6 +21,17 @@
 
 DEFINE_THIS_FILE; /* Used for ASSERT checks to define __FILE__ only once */
 
+/* ----- Defines ------------------------------------------------------------ */
+
+//! Number of slots in the timing wheel. Must be a power of 2.
+/// Timers are hashed into a slot by their expiry tick, so longer timers
+/// just wrap around the wheel and are skipped until their tick comes up.
+#ifndef EVENT_TIMER_WHEEL_SLOTS
+  #define EVENT_TIMER_WHEEL_SLOTS   64U
+#endif
+
+#define EVENT_TIMER_WHEEL_MASK      ( EVENT_TIMER_WHEEL_SLOTS - 1U )
+
 /* ----------------------- Private Functions Declarations ------------------ */
 
 PRIVATE void
@@ -32,9 +43,24 @@ eventTimerAdd( EventTimer              *me,
 PRIVATE void
 eventTimerRemove( EventTimer *me );
 
+PRIVATE void
+eventTimerLink( EventTimer *me, EventTimerCounter expires );
+
+PRIVATE void
+eventTimerUnlink( EventTimer *me );
+
+PRIVATE void
+eventTimerExpire( EventTimerCounter tick );
+
 /* ----------------------- Private Data & Variables ------------------------ */
 
-PRIVATE EventTimer *EventTimerListHead;    // head of linked list of timers
+PRIVATE EventTimer *EventTimerWheel[EVENT_TIMER_WHEEL_SLOTS]; // slot list heads
+
+PRIVATE uint16_t EventTimerActive;             // number of armed timers
+
+PRIVATE volatile EventTimerCounter EventTimerTicks;  // ticks counted by the ISR
+
+PRIVATE EventTimerCounter EventTimerProcessed; // ticks handled by the wheel
 
 /* ----- Public Functions --------------------------------------------------- */
 
@@ -42,7 +68,14 @@ PRIVATE EventTimer *EventTimerListHead;    // head of linked list of timers
 PUBLIC void
 eventTimerInit( void )
 {
-  EventTimerListHead = NULL;
+  for( uint16_t slot = 0; slot < EVENT_TIMER_WHEEL_SLOTS; slot++ )
+  {
+    EventTimerWheel[slot] = NULL;
+  }
+
+  EventTimerActive    = 0;
+  EventTimerTicks     = 0;
+  EventTimerProcessed = 0;
 }
 
 /* -------------------------------------------------------------------------- */
@@ -94,7 +127,6 @@ eventTimerStop( EventTimer *me )
   // check that this timer was actually in use.
   REQUIRE(me->timeoutTask != 0);
 
-  // eventTimerRemove has its own critical section protection
   eventTimerRemove( me );
 }
 
@@ -107,10 +139,12 @@ eventTimerRestart( EventTimer        *me,
 {
     REQUIRE( timeTicks > 0 );
 
-    CRITICAL_SECTION_VAR();
-    CRITICAL_SECTION_START();
-    me->counter = timeTicks;
-    CRITICAL_SECTION_END();
+    if( me->timeoutTask != 0 )
+    {
+        // Move the timer to the wheel slot for its new expiry
+        eventTimerUnlink( me );
+        eventTimerLink( me, EventTimerTicks + timeTicks );
+    }
 }
 
 /* -------------------------------------------------------------------------- */
@@ -136,50 +170,46 @@ eventTimerStopIfActive( EventTimer *me )
 
 /* -------------------------------------------------------------------------- */
 
-//! EventTimerTick to be called usually from ISR context
+//! EventTimerTick to be called from the system tick ISR. Only counts the tick,
+/// the expired timers are handled in eventTimerProcess.
 PUBLIC void
 eventTimerTick( void )
 {
-  EventTimer *t;   //<! Current timer to evaluate
+  EventTimerTicks++;
+}
 
-  t = EventTimerListHead;
-  while( t != 0 )
+/* -------------------------------------------------------------------------- */
+
+//! Catch the timing wheel up with the ticks counted by the ISR and post the
+/// events for any expired timers. Called from the main loop, not the ISR.
+PUBLIC void
+eventTimerProcess( void )
+{
+  EventTimerCounter now = EventTimerTicks;
+
+  while( EventTimerProcessed != now )
   {
-    if( --t->counter == 0 )  // when we reach 0 we fire the event
-    {
-      ASSERT( t->timeoutTask  != 0 );
-      ASSERT( t->timeoutEvent != 0 );
+    EventTimerProcessed++;
 
-      // Fire the event
-      if( stateTaskPostFIFO( (StateTask*)t->timeoutTask,
-                             t->timeoutEvent ) )
-      {
-        if( t->interval != 0 )       // Multishot timer?
-        {
-          t->counter = t->interval;  // Rearm multishot timers
-        }
-        else
-        {
-          eventTimerRemove( t );     // Remove single shot timers
-        }
-      }
-      else
-      {
-        // Failed to queue the timer event. As a fallback measure, bump
-        // the counter up and allow it to be tried again the next tick.
-        t->counter++;
-      }
+    if( EventTimerActive )
+    {
+      eventTimerExpire( EventTimerProcessed );
     }
-
-    // This is safe because the eventTimerRemove leaves
-    // the next and previous timers alone.
-    t = t->next;
   }
 }
 
+/* -------------------------------------------------------------------------- */
+
+//! Return true when there are one or more timers running
+PUBLIC bool
+eventTimersRunning( void )
+{
+  return ( EventTimerActive != 0 );
+}
+
 /* ----------------------- Private Functions ------------------------------- */
 
-//! Create a new timer and link it in the list for servicing.
+//! Setup a new timer and link it in the wheel for servicing.
 PRIVATE void
 eventTimerAdd( EventTimer              *timer,
                const StateTask         *timeoutTask,
@@ -197,56 +227,60 @@ eventTimerAdd( EventTimer              *timer,
     // Setup the timer data
     timer->timeoutTask  = timeoutTask;
     timer->timeoutEvent = timeoutEvent;
-    timer->counter      = timeTicks;
 
-    // Link timer into the list (just at the beginning...)
-    CRITICAL_SECTION_VAR();
-    CRITICAL_SECTION_START();
-    if( EventTimerListHead == 0 )
-    {
-        // New and only event in queue.
+    // Count from the ISR tick so pending unprocessed ticks aren't added
+    eventTimerLink( timer, EventTimerTicks + timeTicks );
+    EventTimerActive++;
+}
 
-        // Make EventTimerListHead point to this event.
-        EventTimerListHead = timer;
+/* -------------------------------------------------------------------------- */
 
-        // Clear the next and previous pointers.
-        timer->next           = 0;
-        timer->previous       = 0;
-    }
-    else
-    {
-        // Existing events in the queue.
+//! Remove an existing timer from the wheel
+PRIVATE void
+eventTimerRemove( EventTimer *timer )
+{
+    // check that this timer was actually in use.
+    REQUIRE( timer->timeoutTask != 0 );
 
-        // Make this event point to the current queue head.
-        timer->next           = EventTimerListHead;
+    eventTimerUnlink( timer );
+    EventTimerActive--;
 
-        // Queue head event point to this event.
-        timer->next->previous = timer;
+    // Flag this timer as inactive.
+    timer->expires      = 0;
+    timer->interval     = 0;
+    timer->timeoutEvent = 0;
+    timer->timeoutTask  = 0;
+}
 
-        // Current queue head event becomes this event.
-        EventTimerListHead = timer;
+/* -------------------------------------------------------------------------- */
 
-        // At the head of the queue, there is no previous.
-        timer->previous       = 0;
+//! Link a timer in at the head of the wheel slot for its expiry tick
+PRIVATE void
+eventTimerLink( EventTimer *timer, EventTimerCounter expires )
+{
+    EventTimer **head = &EventTimerWheel[expires & EVENT_TIMER_WHEEL_MASK];
+
+    timer->expires  = expires;
+    timer->previous = 0;
+    timer->next     = *head;
+
+    if( timer->next != 0 )
+    {
+        timer->next->previous = timer;
     }
-    CRITICAL_SECTION_END();
+
+    *head = timer;
 }
 
 /* -------------------------------------------------------------------------- */
 
-//! Remove an existing timer from the service list
-PRIVATE void eventTimerRemove( EventTimer *timer )
+//! Unlink a timer from its wheel slot
+PRIVATE void
+eventTimerUnlink( EventTimer *timer )
 {
-    // check that this timer was actually in use.
-    REQUIRE( timer->timeoutTask != 0 );
-
-    CRITICAL_SECTION_VAR();
-    CRITICAL_SECTION_START();
-
-    // Remove timer from the tick handler chain
     if( timer->previous == 0 )
     {
-        EventTimerListHead = timer->next;
+        EventTimerWheel[timer->expires & EVENT_TIMER_WHEEL_MASK] = timer->next;
     }
     else
     {
@@ -258,16 +292,55 @@ PRIVATE void eventTimerRemove( EventTimer *timer )
         timer->next->previous = timer->previous;
     }
 
-    // Flag this timer as inactive but leave the next and
-    // previous pointers alone as they are still needed in
-    // eventTimerTick function to traverse the list of timers.
-    // They get re-initialised when the timer is Added again.
-    timer->counter      = 0;
-    timer->interval     = 0;
-    timer->timeoutEvent = 0;
-    timer->timeoutTask  = 0;
+    timer->next     = 0;
+    timer->previous = 0;
+}
+
+/* -------------------------------------------------------------------------- */
 
-    CRITICAL_SECTION_END();
+//! Fire the timers in the wheel slot which expire on this tick
+PRIVATE void
+eventTimerExpire( EventTimerCounter tick )
+{
+  EventTimer *t = EventTimerWheel[tick & EVENT_TIMER_WHEEL_MASK];
+
+  while( t != 0 )
+  {
+    // Grab the next timer first, as firing relinks this one
+    EventTimer *next = t->next;
+
+    // Timers further out than a lap of the wheel share the slot
+    if( t->expires == tick )
+    {
+      ASSERT( t->timeoutTask  != 0 );
+      ASSERT( t->timeoutEvent != 0 );
+
+      // Fire the event
+      if( stateTaskPostFIFO( (StateTask*)t->timeoutTask,
+                             t->timeoutEvent ) )
+      {
+        if( t->interval != 0 )       // Multishot timer?
+        {
+          // Rearm from the expiry tick so repeating timers don't drift
+          eventTimerUnlink( t );
+          eventTimerLink( t, tick + t->interval );
+        }
+        else
+        {
+          eventTimerRemove( t );     // Remove single shot timers
+        }
+      }
+      else
+      {
+        // Failed to queue the timer event. As a fallback measure, move
+        // it on and allow it to be tried again the next tick.
+        eventTimerUnlink( t );
+        eventTimerLink( t, tick + 1 );
+      }
+    }
+
+    t = next;
+  }
 }
 
 /* ----- End ---------------------------------------------------------------- */
@@ -43,9 +43,9 @@ struct EventTimer
 {
   const StateEvent       *timeoutEvent; //<! signal to generate upon timeout
   const StateTask        *timeoutTask;  //<! active task to deliver the event to
-  EventTimer        *next;         //<! link to next timer in the list
-  EventTimer        *previous;     //<! link to previous timer in the list
-  EventTimerCounter counter;       //<! timer counting down to 0 to fire the event
+  EventTimer        *next;         //<! link to next timer in the wheel slot
+  EventTimer        *previous;     //<! link to previous timer in the wheel slot
+  EventTimerCounter expires;       //<! tick count the timer fires at
   EventTimerCounter interval;      //<! reload value for repeating timers. 0 for single shot
 };
 
@@ -102,6 +102,10 @@ eventTimerStopIfActive( EventTimer *me );
 PUBLIC void
 eventTimerTick( void );
 
+//! Post the events for expired timers. Called from the main loop.
+PUBLIC void
+eventTimerProcess( void );
+
 //! Return true when there are one or more timers running
 PUBLIC bool
 eventTimersRunning( void );
@@ -0,0 +1,126 @@
+/**
+ * @file    event_trace.c
+ *
+ * @brief   Timestamped trace of event posts and dispatches.
+ */
+
+/* ----- System Includes ---------------------------------------------------- */
+
+#include <string.h>
+
+/* ----- Local Includes ----------------------------------------------------- */
+
+#include "event_trace.h"
+
+#ifdef EVENT_TRACE
+
+/* ----- Defines ------------------------------------------------------------ */
+
+#define EVENT_TRACE_MASK ( EVENT_TRACE_DEPTH - 1U )
+
+#define EVENT_TRACE_CALIBRATION_RUNS 16U
+
+_Static_assert( ( EVENT_TRACE_DEPTH & EVENT_TRACE_MASK ) == 0, "Trace depth must be a power of two" );
+
+/* ----- Private Variables -------------------------------------------------- */
+
+PRIVATE EventTraceRecord trace_ring[EVENT_TRACE_DEPTH];
+PRIVATE uint32_t         trace_head;        // total records written, wraps into the ring
+PRIVATE bool             trace_frozen;
+PRIVATE uint32_t         trace_overhead;    // cycles per record, measured at init
+
+/* ----- Public Functions --------------------------------------------------- */
+
+PUBLIC void
+eventTraceInit( void )
+{
+    trace_frozen = false;
+    trace_head   = 0;
+
+    /* Time a burst of records so the cost stays visible alongside the trace */
+    uint32_t start = CYCLE_COUNT();
+
+    for( uint8_t i = 0; i < EVENT_TRACE_CALIBRATION_RUNS; i++ )
+    {
+        eventTraceRecord( EVENT_TRACE_POST, 0, 0, 0, start, 0 );
+    }
+
+    trace_overhead = ( CYCLE_COUNT() - start ) / EVENT_TRACE_CALIBRATION_RUNS;
+
+    memset( trace_ring, 0, sizeof( trace_ring ) );
+    trace_head = 0;
+}
+
+/* -------------------------------------------------------------------------- */
+
+PUBLIC void
+eventTraceRecord( EventTraceType type,
+                  uint8_t        signal,
+                  uint8_t        task,
+                  uint16_t       depth,
+                  uint32_t       timestamp,
+                  uint32_t       duration )
+{
+    if( trace_frozen )
+    {
+        return;
+    }
+
+    EventTraceRecord *r = &trace_ring[trace_head & EVENT_TRACE_MASK];
+
+    r->timestamp = timestamp;
+    r->duration  = duration;
+    r->type      = type;
+    r->signal    = signal;
+    r->task      = task;
+    r->depth     = ( depth > UINT8_MAX ) ? UINT8_MAX : depth;
+
+    trace_head++;
+}
+
+/* -------------------------------------------------------------------------- */
+
+PUBLIC void
+eventTraceFreeze( bool freeze )
+{
+    trace_frozen = freeze;
+}
+
+/* -------------------------------------------------------------------------- */
+
+PUBLIC uint16_t
+eventTraceCount( void )
+{
+    return ( trace_head < EVENT_TRACE_DEPTH ) ? trace_head : EVENT_TRACE_DEPTH;
+}
+
+/* -------------------------------------------------------------------------- */
+
+PUBLIC uint16_t
+eventTraceRead( uint16_t index, EventTraceRecord *records, uint16_t count )
+{
+    uint16_t valid  = eventTraceCount();
+    uint32_t oldest = trace_head - valid;
+    uint16_t copied = 0;
+
+    while( copied < count && index < valid )
+    {
+        records[copied] = trace_ring[( oldest + index ) & EVENT_TRACE_MASK];
+        copied++;
+        index++;
+    }
+
+    return copied;
+}
+
+/* -------------------------------------------------------------------------- */
+
+PUBLIC uint32_t
+eventTraceOverhead( void )
+{
+    return trace_overhead;
+}
+
+#endif /* EVENT_TRACE */
+
+/* ----- End ---------------------------------------------------------------- */
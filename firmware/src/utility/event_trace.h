@@ -0,0 +1,108 @@
+/**
+ * @file    event_trace.h
+ *
+ * @brief   Timestamped trace of event posts and dispatches.
+ *
+ *          Each post into a task queue and each dispatch into a task's
+ *          state machine is recorded into a RAM ring, stamped with the
+ *          DWT cycle counter. The ring always holds the most recent
+ *          EVENT_TRACE_DEPTH records, older records are overwritten.
+ *
+ *          Recording is a handful of stores into the ring with no locking,
+ *          so it must only be called from the main loop. Interrupt handlers
+ *          reach task queues through the event inbox, so their events are
+ *          traced when the inbox is drained.
+ *
+ *          The trace compiles away to nothing unless EVENT_TRACE is defined.
+ */
+
+#ifndef EVENT_TRACE_H
+#define EVENT_TRACE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ----- System Includes ---------------------------------------------------- */
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* ----- Local Includes ----------------------------------------------------- */
+
+#include "global.h"
+
+/* ----- Defines ------------------------------------------------------------ */
+
+//! Number of records held in the ring, must be a power of two.
+#define EVENT_TRACE_DEPTH 256U
+
+/* ----- Types -------------------------------------------------------------- */
+
+typedef enum
+{
+    EVENT_TRACE_POST = 0,    //!< event was added to a task queue
+    EVENT_TRACE_DISPATCH,    //!< task state machine handled an event
+} EventTraceType;
+
+typedef struct EventTraceRecord EventTraceRecord;
+struct EventTraceRecord
+{
+    uint32_t timestamp;    //!< DWT cycle count at the post, or the dispatch start
+    uint32_t duration;     //!< cycles spent in the handler, 0 for posts
+    uint8_t  type;         //!< EventTraceType
+    uint8_t  signal;       //!< signal of the event
+    uint8_t  task;         //!< id of the receiving task
+    uint8_t  depth;        //!< task queue depth after the post/dispatch, saturated at 255
+};
+
+/* ----- Public Functions --------------------------------------------------- */
+
+#ifdef EVENT_TRACE
+
+//! Clear the ring and measure the cost of a single record.
+PUBLIC void
+eventTraceInit( void );
+
+//! Add a record to the ring. Main loop only.
+PUBLIC void
+eventTraceRecord( EventTraceType type,
+                  uint8_t        signal,
+                  uint8_t        task,
+                  uint16_t       depth,
+                  uint32_t       timestamp,
+                  uint32_t       duration );
+
+//! Stop or restart recording, used to hold the ring still while it is read out.
+PUBLIC void
+eventTraceFreeze( bool freeze );
+
+//! Number of valid records in the ring.
+PUBLIC uint16_t
+eventTraceCount( void );
+
+//! Copy up to count records, starting at index from the oldest record.
+/// Returns the number of records copied.
+PUBLIC uint16_t
+eventTraceRead( uint16_t index, EventTraceRecord *records, uint16_t count );
+
+//! Cycles taken by one eventTraceRecord call, measured at init.
+PUBLIC uint32_t
+eventTraceOverhead( void );
+
+#define EVENT_TRACE_RECORD( _type, _sig, _task, _depth, _start, _dur ) \
+        eventTraceRecord( _type, _sig, _task, _depth, _start, _dur )
+
+#else
+
+#define EVENT_TRACE_RECORD( _type, _sig, _task, _depth, _start, _dur )
+
+#endif
+
+/* ----- End ---------------------------------------------------------------- */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* EVENT_TRACE_H */
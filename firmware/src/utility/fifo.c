@@ -12,15 +12,24 @@
 
 /* ----- System Includes ---------------------------------------------------- */
 
+#include <string.h>
 
 /* ----- Local Includes ----------------------------------------------------- */
 
 #include "fifo.h"
+#include "qassert.h"
+
+/* ----- Private Data ------------------------------------------------------- */
+
+DEFINE_THIS_FILE; /* Used for ASSERT checks to define __FILE__ only once */
 
 /* ----- Private Prototypes ------------------------------------------------- */
 
-PRIVATE uint32_t
-fifo_next( fifo_t * restrict f, uint32_t index );
+PRIVATE void
+fifo_copy_in( fifo_t * restrict f, uint32_t index, const uint8_t * buf, uint32_t nbytes );
+
+PRIVATE void
+fifo_copy_out( fifo_t * restrict f, uint32_t index, uint8_t * buf, uint32_t nbytes );
 
 /* ----- Public Functions --------------------------------------------------- */
 
@@ -29,69 +38,51 @@ fifo_next( fifo_t * restrict f, uint32_t index );
 PUBLIC void
 fifo_init( fifo_t * restrict f, uint8_t * buf, uint32_t buf_size )
 {
-     f->head     = 0;
-     f->tail     = 0;
-     f->capacity = buf_size;
-     f->buf      = buf;
+    // Indices are masked rather than wrapped, which needs a power of two
+    REQUIRE( buf_size > 0 && ( buf_size & ( buf_size - 1 ) ) == 0 );
+
+    f->head     = 0;
+    f->tail     = 0;
+    f->capacity = buf_size;
+    f->buf      = buf;
 }
 
 /* -------------------------------------------------------------------------- */
 
-/** Returns the amount of data in use in the fifo.
-  * This can be at max the capacity less 1
+/** Returns the capacity of the fifo.
+  * The head and tail count bytes rather than wrapping, so it can be filled
   */
 
 PUBLIC uint32_t
 fifo_size( fifo_t * restrict f )
 {
-    return f->capacity - 1;
+    return f->capacity;
 }
 
 /* -------------------------------------------------------------------------- */
 
 /** Returns the amount of data in use in the fifo.
-  * This can be at max the capacity less 1
+  * Unsigned subtraction keeps this right after the counts wrap
   */
 
 PUBLIC uint32_t
 fifo_used( fifo_t * restrict f )
 {
-    if( f->head != f->tail )
-    {
-        if( f->head > f->tail )
-        {
-            return f->head - f->tail;
-        }
-        else
-        {
-            return f->head - f->tail + f->capacity;
-        }
-    }
-    return 0;
+    return f->head - f->tail;
 }
 
 /* -------------------------------------------------------------------------- */
 
 /** Returns the amount of data in a sequential run in the fifo
   * i.e doesn't count bytes which cross over the overflow boundary
-  * This can be at max the capacity less 1
   */
 
 PUBLIC uint32_t
 fifo_used_linear( fifo_t * restrict f )
 {
-    if( f->head != f->tail )
-    {
-        if( f->head > f->tail )
-        {
-            return f->head - f->tail;
-        }
-        else
-        {
-            return f->capacity - f->tail;   // from tail to end of buffer
-        }
-    }
-    return 0;
+    const uint8_t * data;
+
+    return fifo_peek_span( f, &data );
 }
 
 /* -------------------------------------------------------------------------- */
@@ -101,7 +92,7 @@ fifo_used_linear( fifo_t * restrict f )
 PUBLIC uint32_t
 fifo_free( fifo_t * restrict f )
 {
-    return fifo_size( f ) - fifo_used( f );
+    return f->capacity - fifo_used( f );
 }
 
 /* -------------------------------------------------------------------------- */
@@ -111,11 +102,19 @@ fifo_free( fifo_t * restrict f )
 PUBLIC bool
 fifo_put( fifo_t * restrict f, const uint8_t ch )
 {
-    const uint32_t new_head = fifo_next( f, f->head );
-    if( new_head != f->tail )
+    const uint32_t head = f->head;
+    const uint32_t tail = f->tail;
+
+    // Don't overwrite space until the reader is done with it
+    MEMORY_BARRIER();
+
+    if( head - tail < f->capacity )
     {
-        f->buf[f->head] = ch;
-        f->head = new_head;
+        f->buf[head & ( f->capacity - 1 )] = ch;
+
+        // The data has to land before the reader can see the new head
+        MEMORY_BARRIER();
+        f->head = head + 1;
         return true;    /* successfully added to queue */
     }
     return false; //no more room
@@ -123,18 +122,27 @@ fifo_put( fifo_t * restrict f, const uint8_t ch )
 
 /* -------------------------------------------------------------------------- */
 
-/** Get a byte from the FIFO. Return NULL when empty */
+/** Get a byte from the FIFO. Return false when empty */
 
-PUBLIC uint8_t *
-fifo_get( fifo_t * restrict f )
+PUBLIC bool
+fifo_get( fifo_t * restrict f, uint8_t * ch )
 {
-    if( f->tail != f->head )
+    const uint32_t head = f->head;
+    const uint32_t tail = f->tail;
+
+    // Don't read buffer contents ahead of the head
+    MEMORY_BARRIER();
+
+    if( head != tail )
     {
-        uint8_t * ch = &f->buf[f->tail];
-        f->tail = fifo_next( f, f->tail );
-        return ch;
+        *ch = f->buf[tail & ( f->capacity - 1 )];
+
+        // Finish reading before the writer can reuse the space
+        MEMORY_BARRIER();
+        f->tail = tail + 1;
+        return true;
     }
-    return NULL;
+    return false;
 }
 
 /* -------------------------------------------------------------------------- */
@@ -144,10 +152,15 @@ fifo_get( fifo_t * restrict f )
 PUBLIC uint8_t *
 fifo_peek( fifo_t * restrict f )
 {
-    if( f->tail != f->head )
+    const uint32_t head = f->head;
+    const uint32_t tail = f->tail;
+
+    // Don't read buffer contents ahead of the head
+    MEMORY_BARRIER();
+
+    if( head != tail )
     {
-        uint8_t * ch = &f->buf[f->tail];
-        return ch;
+        return &f->buf[tail & ( f->capacity - 1 )];
     }
     return NULL;
 }
@@ -162,18 +175,20 @@ fifo_peek( fifo_t * restrict f )
 PUBLIC uint32_t
 fifo_write( fifo_t * restrict f, const uint8_t * buf, uint32_t nbytes )
 {
-     uint32_t count = 0;
-     for( uint32_t i = 0; i < nbytes; i++ )
-     {
-         if( fifo_put( f, buf[i] ) )
-         {
-             count++;
-         }
-         else
-         {
-             break;
-         }
-    }
+    const uint32_t head = f->head;
+    const uint32_t tail = f->tail;
+
+    // Don't overwrite space until the reader is done with it
+    MEMORY_BARRIER();
+
+    const uint32_t count = MIN( nbytes, f->capacity - ( head - tail ) );
+
+    fifo_copy_in( f, head, buf, count );
+
+    // The data has to land before the reader can see the new head
+    MEMORY_BARRIER();
+    f->head = head + count;
+
     return count;
 }
 
@@ -184,38 +199,78 @@ fifo_write( fifo_t * restrict f, const uint8_t * buf, uint32_t nbytes )
 PUBLIC uint32_t
 fifo_read( fifo_t * restrict f, uint8_t * buf, uint32_t nbytes )
 {
-     uint32_t count = 0;
-     for( uint32_t i = 0; i < nbytes; i++ )
-     {
-         uint8_t * p = fifo_get( f );
-         if( p )
-         {
-             buf[i] = *p;
-             count++;
-         }
-         else
-         {
-             break;
-         }
-     }
-     return count;
+    const uint32_t head = f->head;
+    const uint32_t tail = f->tail;
+
+    // Don't read buffer contents ahead of the head
+    MEMORY_BARRIER();
+
+    const uint32_t count = MIN( nbytes, head - tail );
+
+    fifo_copy_out( f, tail, buf, count );
+
+    // Finish reading before the writer can reuse the space
+    MEMORY_BARRIER();
+    f->tail = tail + count;
+
+    return count;
 }
 
 /* -------------------------------------------------------------------------- */
 
-/** Returns a pointer to the tail position. If the nbytes length is illegal, returns null */
+/** Points at the oldest data, returns the length which doesn't wrap */
 
-PUBLIC uint32_t*
-fifo_get_tail_ptr( fifo_t * restrict f, uint32_t nbytes )
+PUBLIC uint32_t
+fifo_peek_span( fifo_t * restrict f, const uint8_t ** data )
 {
-    uint32_t *ptr = NULL;
+    const uint32_t head  = f->head;
+    const uint32_t tail  = f->tail;
+    const uint32_t index = tail & ( f->capacity - 1 );
 
-    if( nbytes <= fifo_used_linear(f)  )
+    // Don't read buffer contents ahead of the head
+    MEMORY_BARRIER();
+
+    *data = &f->buf[index];
+
+    return MIN( head - tail, f->capacity - index );
+}
+
+/* -------------------------------------------------------------------------- */
+
+/** Points at the free space after the head, returns the length which doesn't wrap */
+
+PUBLIC uint32_t
+fifo_reserve_span( fifo_t * restrict f, uint8_t ** data )
+{
+    const uint32_t head  = f->head;
+    const uint32_t tail  = f->tail;
+    const uint32_t index = head & ( f->capacity - 1 );
+
+    // Don't overwrite space until the reader is done with it
+    MEMORY_BARRIER();
+
+    *data = &f->buf[index];
+
+    return MIN( f->capacity - ( head - tail ), f->capacity - index );
+}
+
+/* -------------------------------------------------------------------------- */
+
+/** Moves the head forward by nbytes */
+
+PUBLIC uint32_t
+fifo_commit( fifo_t * restrict f, uint32_t nbytes )
+{
+    if( nbytes <= fifo_free( f ) )
     {
-        ptr = &f->buf[f->tail];
+        // The data has to land before the reader can see the new head
+        MEMORY_BARRIER();
+        f->head += nbytes;
+
+        return nbytes;
     }
 
-    return ptr;
+    return 0;
 }
 
 /* -------------------------------------------------------------------------- */
@@ -225,15 +280,12 @@ fifo_get_tail_ptr( fifo_t * restrict f, uint32_t nbytes )
 PUBLIC uint32_t
 fifo_skip( fifo_t * restrict f, uint32_t nbytes )
 {
-    if( nbytes <= fifo_used_linear(f) )
+    if( nbytes <= fifo_used( f ) )
     {
+        // Finish reading before the writer can reuse the space
+        MEMORY_BARRIER();
         f->tail += nbytes;
 
-        if( f->tail >= f->capacity )
-        {
-            f->tail = 0;
-        }
-
         return nbytes;
     }
 
@@ -242,16 +294,36 @@ fifo_skip( fifo_t * restrict f, uint32_t nbytes )
 
 /* ----- Private Functions -------------------------------------------------- */
 
-PRIVATE uint32_t
-fifo_next( fifo_t * restrict f, uint32_t index )
+// Copies in at most two runs, up to the end of the buffer and then from the start
+
+PRIVATE void
+fifo_copy_in( fifo_t * restrict f, uint32_t index, const uint8_t * buf, uint32_t nbytes )
 {
-    uint32_t current = index;
-    current++;
-    if( current >= f->capacity )
+    const uint32_t offset = index & ( f->capacity - 1 );
+    const uint32_t first  = MIN( nbytes, f->capacity - offset );
+
+    memcpy( &f->buf[offset], buf, first );
+
+    if( nbytes > first )
+    {
+        memcpy( f->buf, &buf[first], nbytes - first );
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+
+PRIVATE void
+fifo_copy_out( fifo_t * restrict f, uint32_t index, uint8_t * buf, uint32_t nbytes )
+{
+    const uint32_t offset = index & ( f->capacity - 1 );
+    const uint32_t first  = MIN( nbytes, f->capacity - offset );
+
+    memcpy( buf, &f->buf[offset], first );
+
+    if( nbytes > first )
     {
-        current = 0;
+        memcpy( &buf[first], f->buf, nbytes - first );
     }
-    return current;
 }
 
 /* ----- End ---------------------------------------------------------------- */
@@ -5,6 +5,11 @@
  *
  * @brief     Basic buffer based FIFO capability.
  *
+ *            One writer and one reader can use the FIFO at the same time
+ *            without a critical section, e.g. a task writing and an ISR or
+ *            DMA completion reading. The head is only moved by the writer and
+ *            the tail only by the reader.
+ *
  * @author    Marco Hess <marcoh@applidyne.com.au>
  *
  * @copyright (c) 2015 Applidyne Australia Pty. Ltd. - All rights reserved.
@@ -30,15 +35,17 @@ extern "C" {
 
 typedef struct
 {
-     uint8_t * buf;
-     uint32_t  head;
-     uint32_t  tail;
-     uint32_t  capacity;
+     uint8_t *          buf;
+     volatile uint32_t  head;        // bytes written since init, wraps freely
+     volatile uint32_t  tail;        // bytes read since init, wraps freely
+     uint32_t           capacity;    // a power of two
 } fifo_t;
 
 /* ----- Public Functions --------------------------------------------------- */
 
-/** This initializes the FIFO structure with the given buffer and size */
+/** This initializes the FIFO structure with the given buffer and size.
+ *  The size has to be a power of two, all of it can be filled.
+ */
 
 PUBLIC void
 fifo_init( fifo_t * restrict f, uint8_t * buf, uint32_t buf_size );
@@ -80,10 +87,10 @@ fifo_put( fifo_t * restrict f, const uint8_t ch );
 
 /* -------------------------------------------------------------------------- */
 
-/** Get a byte from the FIFO. Return NULL when empty */
+/** Get a byte from the FIFO. Return false when empty */
 
-PUBLIC uint8_t *
-fifo_get( fifo_t * restrict f );
+PUBLIC bool
+fifo_get( fifo_t * restrict f, uint8_t * ch );
 
 /* -------------------------------------------------------------------------- */
 
@@ -111,12 +118,32 @@ fifo_read( fifo_t * restrict f, uint8_t * buf, uint32_t nbytes );
 
 /* -------------------------------------------------------------------------- */
 
-/** Get the pointer to the tail, if the proposed nbytes is legal
- *  Only use this function while promising that underlying data isn't mutated
+/** Points data at the oldest bytes in the FIFO and returns how many of them
+ *  run on without wrapping, e.g. for a DMA transfer out of the buffer.
+ *  The bytes stay in place until they are released with fifo_skip().
  */
 
-PUBLIC uint32_t*
-fifo_get_tail_ptr( fifo_t * restrict f, uint32_t nbytes );
+PUBLIC uint32_t
+fifo_peek_span( fifo_t * restrict f, const uint8_t ** data );
+
+/* -------------------------------------------------------------------------- */
+
+/** Points data at the free space after the head and returns how much of it
+ *  runs on without wrapping, e.g. for a DMA transfer into the buffer.
+ *  Nothing is visible to the reader until it is published with fifo_commit().
+ */
+
+PUBLIC uint32_t
+fifo_reserve_span( fifo_t * restrict f, uint8_t ** data );
+
+/* -------------------------------------------------------------------------- */
+
+/** Moves the head forwards by nbytes, publishing data placed with
+ *  fifo_reserve_span(). Returns the number of bytes published.
+ */
+
+PUBLIC uint32_t
+fifo_commit( fifo_t * restrict f, uint32_t nbytes );
 
 /* -------------------------------------------------------------------------- */
 
@@ -55,6 +55,10 @@
  *                        break;
  *            }
  *
+ *            Wrapping the switch with STATE_PROFILE_BEGIN and
+ *            STATE_PROFILE_END( my_process, "name", instance ) adds the
+ *            time spent in each state to the state_profile statistics.
+ *
  *
  * @author    Marco Hess <marcoh@applidyne.com.au>
  *
@@ -66,6 +70,10 @@
 
 /* -------------------------------------------------------------------------- */
 
+#include "state_profile.h"
+
+/* -------------------------------------------------------------------------- */
+
 /* ~~~ State Machine Handling Macros ~~~ */
 
 #define STATE_INIT_INITIAL(s)  me->previousState = -1;                     \
@@ -92,6 +100,16 @@
 #define STATE_IS_TRANSITIONING ( ( me->previousState != me->currentState ) \
                                || ( me->currentState != me->nextState ) )
 
+/* ~~~ Execution Time Profiling Macros ~~~ */
+
+#define STATE_PROFILE_BEGIN    const uint32_t profileStart = CYCLE_COUNT();  \
+                               const uint8_t  profileState = me->currentState
+
+#define STATE_PROFILE_END(p, n, i)                                          \
+                               stateProfileRecord( (const void *)(p), (n), \
+                                                   (i), profileState,       \
+                                                   CYCLE_COUNT() - profileStart )
+
 
 /* ----- End ---------------------------------------------------------------- */
 
@@ -41,9 +41,9 @@ typedef uint8_t Signal;
 typedef struct Dynamic Dynamic;
 struct Dynamic
 {
-    unsigned poolId:2;      ///< Pool number from which event was allocated
-                            ///< (allows up to 3 pools to be used)
-    unsigned useCount:6;    ///< Number of times the event was already propagated
+    unsigned poolId:3;      ///< Pool number from which event was allocated
+                            ///< (allows up to 7 pools to be used)
+    unsigned useCount:5;    ///< Number of times the event was already propagated
                             ///< (up to the number of tasks)
 };
 
@@ -0,0 +1,169 @@
+/**
+ * @file    state_profile.c
+ *
+ * @brief   Execution time statistics for state handlers.
+ */
+
+/* ----- System Includes ---------------------------------------------------- */
+
+#include <string.h>
+
+/* ----- Local Includes ----------------------------------------------------- */
+
+#include "state_profile.h"
+
+/* ----- Defines ------------------------------------------------------------ */
+
+#define STATE_PROFILE_MASK ( STATE_PROFILE_SLOTS - 1U )
+
+_Static_assert( ( STATE_PROFILE_SLOTS & STATE_PROFILE_MASK ) == 0, "Profile slots must be a power of two" );
+
+/* ----- Private Variables -------------------------------------------------- */
+
+PRIVATE StateProfile  profile_table[STATE_PROFILE_SLOTS];
+PRIVATE uint32_t      profile_dropped;
+PRIVATE volatile bool profile_reset;
+
+/* ----- Private Prototypes ------------------------------------------------- */
+
+PRIVATE StateProfile *
+stateProfileFind( const void *handler, uint8_t instance, uint8_t state );
+
+/* ----- Public Functions --------------------------------------------------- */
+
+PUBLIC void
+stateProfileInit( void )
+{
+    memset( profile_table, 0, sizeof( profile_table ) );
+    profile_dropped = 0;
+    profile_reset   = false;
+}
+
+/* -------------------------------------------------------------------------- */
+
+PUBLIC void
+stateProfileRecord( const void *handler,
+                    const char *name,
+                    uint8_t     instance,
+                    uint8_t     state,
+                    uint32_t    cycles )
+{
+    if( profile_reset )
+    {
+        stateProfileInit();
+    }
+
+    StateProfile *p = stateProfileFind( handler, instance, state );
+
+    if( !p )
+    {
+        profile_dropped++;
+        return;
+    }
+
+    if( !p->handler )
+    {
+        p->handler  = handler;
+        p->name     = name;
+        p->instance = instance;
+        p->state    = state;
+        p->min      = UINT32_MAX;
+    }
+
+    p->count++;
+    p->total += cycles;
+    p->last = cycles;
+
+    if( cycles < p->min )
+    {
+        p->min = cycles;
+    }
+
+    if( cycles > p->max )
+    {
+        p->max = cycles;
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+
+PUBLIC void
+stateProfileReset( void )
+{
+    profile_reset = true;
+}
+
+/* -------------------------------------------------------------------------- */
+
+PUBLIC uint8_t
+stateProfileWorst( const StateProfile **worst, uint8_t count )
+{
+    uint8_t found = 0;
+
+    /* Insertion into a short sorted list, the table is only walked once */
+    for( uint16_t i = 0; i < STATE_PROFILE_SLOTS; i++ )
+    {
+        const StateProfile *p = &profile_table[i];
+
+        if( !p->handler )
+        {
+            continue;
+        }
+
+        uint8_t pos = found;
+        while( pos > 0 && worst[pos - 1]->max < p->max )
+        {
+            if( pos < count )
+            {
+                worst[pos] = worst[pos - 1];
+            }
+            pos--;
+        }
+
+        if( pos < count )
+        {
+            worst[pos] = p;
+            if( found < count )
+            {
+                found++;
+            }
+        }
+    }
+
+    return found;
+}
+
+/* -------------------------------------------------------------------------- */
+
+PUBLIC uint32_t
+stateProfileDropped( void )
+{
+    return profile_dropped;
+}
+
+/* ----- Private Functions -------------------------------------------------- */
+
+/** Open addressed lookup, returns the matching slot or the empty slot to
+ *  use for a new handler. Returns NULL when the table is full.
+ */
+
+PRIVATE StateProfile *
+stateProfileFind( const void *handler, uint8_t instance, uint8_t state )
+{
+    uint32_t hash = ( (uint32_t)(uintptr_t)handler >> 2 ) ^ ( instance * 31U ) ^ ( state * 7U );
+
+    for( uint16_t probe = 0; probe < STATE_PROFILE_SLOTS; probe++ )
+    {
+        StateProfile *p = &profile_table[( hash + probe ) & STATE_PROFILE_MASK];
+
+        if( !p->handler
+            || ( p->handler == handler && p->instance == instance && p->state == state ) )
+        {
+            return p;
+        }
+    }
+
+    return 0;
+}
+
+/* ----- End ---------------------------------------------------------------- */
@@ -0,0 +1,90 @@
+/**
+ * @file    state_profile.h
+ *
+ * @brief   Execution time statistics for state handlers.
+ *
+ *          Each state handler is timed with the DWT cycle counter and keeps
+ *          count, min, max, last and average cycles. Handlers are keyed by
+ *          the state function for hierarchical state machines, or by the
+ *          process function, instance and state number for the switch based
+ *          simple_state_machine.h drivers.
+ *
+ *          Recording is main loop only. The UI reads back the handlers with
+ *          the worst case execution times.
+ */
+
+#ifndef STATE_PROFILE_H
+#define STATE_PROFILE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ----- System Includes ---------------------------------------------------- */
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* ----- Local Includes ----------------------------------------------------- */
+
+#include "global.h"
+
+/* ----- Defines ------------------------------------------------------------ */
+
+//! Number of distinct handlers that can be tracked, must be a power of two.
+#define STATE_PROFILE_SLOTS 64U
+
+//! State number used for hierarchical state handlers, which are identified by their function.
+#define STATE_PROFILE_HSM 0xFFU
+
+/* ----- Types -------------------------------------------------------------- */
+
+typedef struct StateProfile StateProfile;
+struct StateProfile
+{
+    const void *handler;     //!< state function, or simple state machine process function
+    const char *name;        //!< task or driver name
+    uint8_t     instance;    //!< task id, or driver instance
+    uint8_t     state;       //!< simple state machine state, STATE_PROFILE_HSM otherwise
+    uint32_t    count;
+    uint32_t    last;        //!< cycles
+    uint32_t    min;         //!< cycles
+    uint32_t    max;         //!< cycles
+    uint64_t    total;       //!< cycles, for the average
+};
+
+/* ----- Public Functions --------------------------------------------------- */
+
+//! Clear the statistics for all handlers.
+PUBLIC void
+stateProfileInit( void );
+
+//! Add an execution time for a handler. Main loop only.
+PUBLIC void
+stateProfileRecord( const void *handler,
+                    const char *name,
+                    uint8_t     instance,
+                    uint8_t     state,
+                    uint32_t    cycles );
+
+//! Ask for the statistics to be cleared. Safe from interrupts, the clear
+/// happens on the next record.
+PUBLIC void
+stateProfileReset( void );
+
+//! Fill worst with up to count handlers, ordered by decreasing max time.
+/// Returns the number of handlers provided.
+PUBLIC uint8_t
+stateProfileWorst( const StateProfile **worst, uint8_t count );
+
+//! Handlers that couldn't be tracked as the table was full.
+PUBLIC uint32_t
+stateProfileDropped( void );
+
+/* ----- End ---------------------------------------------------------------- */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* STATE_PROFILE_H */
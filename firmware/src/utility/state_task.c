@@ -14,8 +14,10 @@
 /* ----- Local Includes ----------------------------------------------------- */
 
 #include "state_task.h"
+#include "state_tasker.h"
 #include "qassert.h"
 #include "state_event.h"
+#include "event_trace.h"
 
 /* -------------------------------------------------------------------------- */
 
@@ -23,6 +25,20 @@
 
 /* ----- Private Functions -------------------------------------------------- */
 
+//! Let the tasker know this task has events to process
+PRIVATE void
+stateTaskReady( StateTask *t )
+{
+    if( t->tasker )
+    {
+        stateTaskerMarkReady( (StateTasker_t*)t->tasker, t );
+    }
+    else
+    {
+        t->ready = true;
+    }
+}
+
 /* ----- Public Functions --------------------------------------------------- */
 
 PUBLIC void
@@ -38,9 +54,9 @@ stateTaskCtor( StateTask * restrict me,
 PUBLIC StateTask *
 stateTaskCreate( StateTask    * restrict me,
                  StateEvent   * restrict eventQueueData[],
-                 uint8_t      eventQueueSize,
+                 uint16_t     eventQueueSize,
                  StateEvent   * restrict requestQueueData[],
-                 uint8_t      requestQueueSize )
+                 uint16_t     requestQueueSize )
 {
     // Add the event queues.
     eventQueueInit( &me->eventQueue,   eventQueueData,   eventQueueSize );
@@ -60,7 +76,9 @@ stateTaskPostFIFO( StateTask *t, const StateEvent *e )
         {
             if( eventQueuePutFIFO( &t->eventQueue, (StateEvent*)e ) )
             {
-                t->ready = true;
+                stateTaskReady( t );
+                EVENT_TRACE_RECORD( EVENT_TRACE_POST, e->signal, t->id,
+                                    eventQueueUsed( &t->eventQueue ), CYCLE_COUNT(), 0 );
                 return true;
             }
         }
@@ -79,7 +97,9 @@ stateTaskPostLIFO( StateTask *t, const StateEvent *e )
         {
             if( eventQueuePutLIFO( &t->eventQueue, (StateEvent*)e ) )
             {
-                t->ready = true;
+                stateTaskReady( t );
+                EVENT_TRACE_RECORD( EVENT_TRACE_POST, e->signal, t->id,
+                                    eventQueueUsed( &t->eventQueue ), CYCLE_COUNT(), 0 );
                 return true;
             }
         }
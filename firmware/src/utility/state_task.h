@@ -44,6 +44,7 @@ typedef struct
     uint32_t      waiting;
     uint32_t      burst_max;
     uint32_t      waiting_max;
+    uint32_t      ready_since;          /** tasker run count when last made ready */
     void *        tasker;
     EventQueue    eventQueue;
     EventQueue    requestQueue;
@@ -85,9 +86,9 @@ stateTaskCtor( StateTask * restrict me, State initialState );
 PUBLIC StateTask *
 stateTaskCreate( StateTask    * restrict me,
                  StateEvent   * restrict eventQueueData[],
-                 uint8_t      eventQueueSize,
+                 uint16_t     eventQueueSize,
                  StateEvent   * restrict requestQueueData[],
-                 uint8_t      requestQueueSize );
+                 uint16_t     requestQueueSize );
 
 /* ----- End ---------------------------------------------------------------- */
 
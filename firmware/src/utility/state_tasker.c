@@ -15,9 +15,12 @@
 /* ----- Local Includes ----------------------------------------------------- */
 
 #include "state_tasker.h"
+#include "bitset.h"
 #include "qassert.h"
 #include "event_queue.h"
 #include "state_event.h"
+#include "event_trace.h"
+#include "state_profile.h"
 
 /* -------------------------------------------------------------------------- */
 
@@ -27,7 +30,7 @@ DEFINE_THIS_FILE; /* Used for ASSERT checks to define __FILE__ only once */
 /* ----- Private Prototypes ------------------------------------------------- */
 
 PRIVATE void
-stateTaskerBumpWaiting( StateTasker_t * me );
+stateTaskerUpdateWaiting( StateTasker_t * me, StateTask * task );
 
 PRIVATE StateTask  *
 stateTaskerNext( StateTasker_t * me );
@@ -40,6 +43,9 @@ stateTaskerNext( StateTasker_t * me );
 PUBLIC void
 stateTaskerInit( StateTasker_t * me, StateTask **tasks, uint8_t num_tasks )
 {
+    /* Task ID's are used directly as bit numbers in the ready set */
+    REQUIRE( num_tasks <= ( sizeof( BitSet_t ) * 8 ) + 1 );
+
     memset( me, 0, sizeof( StateTasker_t ) );
     me->max_tasks = num_tasks;
     me->tasks = tasks;
@@ -61,6 +67,9 @@ stateTaskerAddTask( StateTasker_t *me,
     REQUIRE( priority < me->max_tasks );  /* Less than num_task */
     REQUIRE( me->tasks[priority] == (StateTask*)0 ); /* Not init yet */
 
+    /* Events posted before the task was added only flagged the task itself */
+    bool was_ready = task->ready;
+
     task->id          = priority;
     task->ready       = false;
     task->name        = name;
@@ -68,10 +77,16 @@ stateTaskerAddTask( StateTasker_t *me,
     task->waiting     = 0;
     task->burst_max   = 0;
     task->waiting_max = 0;
+    task->ready_since = 0;
 
     task->tasker      = me;     /* Keep reference to tasker */
 
     me->tasks[priority] = task;
+
+    if( was_ready )
+    {
+        stateTaskerMarkReady( me, task );
+    }
 }
 
 /* -------------------------------------------------------------------------- */
@@ -99,18 +114,14 @@ stateTaskerStartTask( StateTasker_t * me __attribute__((__unused__)),
 PUBLIC bool
 stateTaskerRunEvent( StateTasker_t * me )
 {
-    stateTaskerBumpWaiting( me );
+    me->runs++;
     me->current = stateTaskerNext( me );
     if( me->current )
     {
         StateEvent *e;
 
-        {
-            CRITICAL_SECTION_VAR();
-            CRITICAL_SECTION_START();
-            e = eventQueueGet( &me->current->eventQueue );
-            CRITICAL_SECTION_END();
-        }
+        e = eventQueueGet( &me->current->eventQueue );
+        stateTaskerUpdateWaiting( me, me->current );
         me->current->waiting = 0;
         if( me->previous == me->current )
         {
@@ -120,23 +131,50 @@ stateTaskerRunEvent( StateTasker_t * me )
                 me->current->burst_max = me->current->burst;
             }
         }
+        /* Time the handler against the state that was active when the event arrived */
+        State    state = me->current->super.activeState;
+        uint32_t start = CYCLE_COUNT();
         hsmDispatch( (Hsm*)me->current, e );
+        uint32_t cycles = CYCLE_COUNT() - start;
+
+        stateProfileRecord( (const void *)state, me->current->name, me->current->id,
+                            STATE_PROFILE_HSM, cycles );
+        EVENT_TRACE_RECORD( EVENT_TRACE_DISPATCH, e->signal, me->current->id,
+                            eventQueueUsed( &me->current->eventQueue ), start, cycles );
         eventPoolGarbageCollect( e );
 
+        if( eventQueueUsed( &me->current->eventQueue ) == 0 )
         {
-            CRITICAL_SECTION_VAR();
-            CRITICAL_SECTION_START();
-            if( eventQueueUsed( &me->current->eventQueue ) == 0 )
-            {
-                me->current->burst = 0;
-                me->current->ready = false;
-            }
-            CRITICAL_SECTION_END();
+            me->current->burst = 0;
+            me->current->ready = false;
+            bitsetClear( &me->ready_set, me->current->id );
+        }
+        else
+        {
+            /* Still ready, so the wait for the next event starts now */
+            me->current->ready_since = me->runs;
         }
     }
 
     me->previous = me->current;
-    return stateTaskerNext( me ) != NULL;
+    return me->ready_set != 0;
+}
+
+/* -------------------------------------------------------------------------- */
+
+/** Flag a task as having events to process. Called when an event is posted
+ *  to the task queue, which only happens from the main loop.
+ */
+
+PUBLIC void
+stateTaskerMarkReady( StateTasker_t * me, StateTask * task )
+{
+    if( !bitsetIsSet( &me->ready_set, task->id ) )
+    {
+        bitsetSet( &me->ready_set, task->id );
+        task->ready       = true;
+        task->ready_since = me->runs;
+    }
 }
 
 /* -------------------------------------------------------------------------- */
@@ -168,6 +206,21 @@ stateTaskerGetTaskById( StateTasker_t *me, uint8_t id )
 
 /* -------------------------------------------------------------------------- */
 
+PUBLIC void
+stateTaskerUpdateStatistics( StateTasker_t *me )
+{
+    /* Fold in the wait of tasks that are still ready but haven't run yet */
+    for( uint8_t id = me->max_tasks-1; id > 0; id-- )
+    {
+        if( ( me->tasks[id] ) && ( me->tasks[id]->ready ) )
+        {
+            stateTaskerUpdateWaiting( me, me->tasks[id] );
+        }
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+
 PUBLIC void
 stateTaskerClearStatistics( StateTasker_t *me )
 {
@@ -183,39 +236,31 @@ stateTaskerClearStatistics( StateTasker_t *me )
 
 /* ----- Private Functions -------------------------------------------------- */
 
-/** Bump the waiting counter for any ready to run tasks */
+/** Update the waiting statistics for a ready task. Rather than bumping a
+ *  counter in every ready task for each event, the wait is the number of
+ *  tasker runs since the task became ready.
+ */
 
 PRIVATE void
-stateTaskerBumpWaiting( StateTasker_t * me )
+stateTaskerUpdateWaiting( StateTasker_t * me, StateTask * task )
 {
-    for( uint8_t id = me->max_tasks-1; id > 0; id-- )
+    task->waiting = me->runs - task->ready_since;
+    if( task->waiting > task->waiting_max )
     {
-        if( ( me->tasks[id] ) && ( me->tasks[id]->ready ) )
-        {
-            me->tasks[id]->waiting++;
-            if( me->tasks[id]->waiting > me->tasks[id]->waiting_max )
-            {
-                me->tasks[id]->waiting_max = me->tasks[id]->waiting;
-            }
-        }
+        task->waiting_max = task->waiting;
     }
 }
 
 /* -------------------------------------------------------------------------- */
 
-/** Return the task * that is the next to run */
+/** Return the task * that is the next to run. Higher ID's have priority. */
 
 PRIVATE StateTask  *
 stateTaskerNext( StateTasker_t * me )
 {
-    for( uint8_t id = me->max_tasks-1; id > 0; id-- )
-    {
-        if( ( me->tasks[id] ) && ( me->tasks[id]->ready ) )
-        {
-            return me->tasks[id];
-        }
-    }
-    return NULL;
+    uint8_t id = bitsetHighest( &me->ready_set );
+
+    return ( id > 0 ) ? me->tasks[id] : NULL;
 }
 
 /* ----- End ---------------------------------------------------------------- */
@@ -25,6 +25,7 @@ extern "C" {
 
 #include "global.h"
 #include "state_task.h"
+#include "bitset.h"
 
 /* ----- Defines ------------------------------------------------------------ */
 
@@ -37,6 +38,8 @@ extern "C" {
 typedef struct
 {
     uint8_t                max_tasks;       /** maximum number of tasks */
+    BitSet_t               ready_set;       /** bit per task ID with queued events */
+    uint32_t               runs;            /** number of tasker runs, for waiting stats */
     StateTask              *current;        /** current running task */
     StateTask              *previous;       /** previous running task */
     StateTask              **tasks;         /** Table of tasks pointers */
@@ -84,6 +87,15 @@ stateTaskerRunEvent( StateTasker_t * me );
 
 /* -------------------------------------------------------------------------- */
 
+/** Flag a task as having events to process. Called when an event is posted
+ *  to the task queue, which only happens from the main loop.
+ */
+
+PUBLIC void
+stateTaskerMarkReady( StateTasker_t * me, StateTask * task );
+
+/* -------------------------------------------------------------------------- */
+
 /** Return the name of the task with the indicated ID.
  */
 
@@ -97,6 +109,14 @@ stateTaskerGetTaskById( StateTasker_t *me, uint8_t id );
 
 /* -------------------------------------------------------------------------- */
 
+/** Bring the waiting statistics up to date for tasks which are still ready.
+ */
+
+PUBLIC void
+stateTaskerUpdateStatistics( StateTasker_t *me );
+
+/* -------------------------------------------------------------------------- */
+
 PUBLIC void
 stateTaskerClearStatistics( StateTasker_t *me );
 
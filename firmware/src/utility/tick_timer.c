@@ -24,6 +24,15 @@
 
 DEFINE_THIS_FILE; /* Used for ASSERT checks to define __FILE__ only once */
 
+/* ----- Defines ------------------------------------------------------------ */
+
+//! Number of slots in the timing wheel. Must be a power of 2.
+#ifndef TICK_TIMER_WHEEL_SLOTS
+  #define TICK_TIMER_WHEEL_SLOTS    32U
+#endif
+
+#define TICK_TIMER_WHEEL_MASK       ( TICK_TIMER_WHEEL_SLOTS - 1U )
+
 /* ----------------------- Private Functions ------------------------------- */
 
 PRIVATE void tick_timer_add( TickTimer                 *me,
@@ -32,10 +41,26 @@ PRIVATE void tick_timer_add( TickTimer                 *me,
 
 PRIVATE void tick_timer_remove( TickTimer *me );
 
+PRIVATE void tick_timer_link( TickTimer *me, TickTimerCounter expires );
+
+PRIVATE void tick_timer_unlink( TickTimer *me );
+
+PRIVATE void tick_timer_expire( TickTimerCounter tick );
+
 /* ----------------------- Private Data ------------------------------------ */
 
-//! Head of linked list of timers
-PRIVATE TickTimer *TickTimerListHead;
+//! Heads of the linked lists of timers in each wheel slot
+PRIVATE TickTimer *TickTimerWheel[TICK_TIMER_WHEEL_SLOTS];
+
+//! Number of armed timers
+PRIVATE uint16_t TickTimerActive;
+
+//! Ticks counted by the ISR, and ticks handled by the wheel
+PRIVATE volatile TickTimerCounter TickTimerTicks;
+PRIVATE TickTimerCounter          TickTimerProcessed;
+
+//! Timer whose callback is currently running
+PRIVATE TickTimer *TickTimerFiring;
 
 /* ----- Public Functions --------------------------------------------------- */
 
@@ -43,7 +68,15 @@ PRIVATE TickTimer *TickTimerListHead;
 PUBLIC void
 tick_timer_init( void )
 {
-    TickTimerListHead = NULL;
+    for( uint16_t slot = 0; slot < TICK_TIMER_WHEEL_SLOTS; slot++ )
+    {
+        TickTimerWheel[slot] = NULL;
+    }
+
+    TickTimerActive    = 0;
+    TickTimerTicks     = 0;
+    TickTimerProcessed = 0;
+    TickTimerFiring    = NULL;
 }
 
 /* -------------------------------------------------------------------------- */
@@ -88,12 +121,11 @@ tick_timer_stop( TickTimer *me )
 {
     // check that this function was not actually called from within a timer
     // callback function.
-    REQUIRE( me->counter != 0 );
+    REQUIRE( me != TickTimerFiring );
 
     // check that this timer was actually in use.
     REQUIRE( me->callbackOnFire != 0 );
 
-    // tick_timer_Remove has its own critical section protection
     tick_timer_remove( me );
 }
 
@@ -107,9 +139,9 @@ tick_timer_stop( TickTimer *me )
 PUBLIC void
 tick_timer_disable( TickTimer *me )
 {
-    // check that this function was actually called from within a callback
-    // function where the counter is 0.
-    REQUIRE( me->counter == 0 );
+    // check that this function was actually called from within the callback
+    // function of this timer.
+    REQUIRE( me == TickTimerFiring );
 
     // Just clear the interval and let the tick handler clean it up.
     me->interval = 0;
@@ -117,16 +149,19 @@ tick_timer_disable( TickTimer *me )
 
 /* -------------------------------------------------------------------------- */
 
-// rearm a timer to fire in/every nTicks (if 'nTicks'==0 the old
-// value is restored)
+// rearm a timer to fire in/every nTicks
 PUBLIC void
 tick_timer_restart( TickTimer        *me,
                     TickTimerCounter timeTicks )
 {
-    CRITICAL_SECTION_VAR();
-    CRITICAL_SECTION_START();
-    me->counter = timeTicks;
-    CRITICAL_SECTION_END();
+    REQUIRE( timeTicks > 0 );
+
+    if( ( me->callbackOnFire != 0 ) && ( me != TickTimerFiring ) )
+    {
+        // Move the timer to the wheel slot for its new expiry
+        tick_timer_unlink( me );
+        tick_timer_link( me, TickTimerTicks + timeTicks );
+    }
 }
 
 /* -------------------------------------------------------------------------- */
@@ -135,45 +170,42 @@ tick_timer_restart( TickTimer        *me,
 PUBLIC bool
 tick_timer_is_active( TickTimer *me )
 {
-    return ( me->counter != 0 );
+    return ( me->callbackOnFire != 0 ) && ( me != TickTimerFiring );
 }
 
 /* -------------------------------------------------------------------------- */
 
-//! tick_timer_Tick to be called usually from ISR context
+//! tick_timer_tick to be called from the system tick ISR. Only counts the
+/// tick, the callbacks are run from tick_timer_process.
 PUBLIC void
 tick_timer_tick( void )
 {
-    register TickTimer *t;   //<! Current timer to evaluate
+    TickTimerTicks++;
+}
 
-    t = TickTimerListHead;
-    while( t != 0 )
+/* -------------------------------------------------------------------------- */
+
+//! Catch the timing wheel up with the ticks counted by the ISR and run the
+/// callbacks of any expired timers. Called from the main loop, not the ISR.
+PUBLIC void
+tick_timer_process( void )
+{
+    TickTimerCounter now = TickTimerTicks;
+
+    while( TickTimerProcessed != now )
     {
-        if( --t->counter == 0 )  // when we reach 0 we fire the event
+        TickTimerProcessed++;
+
+        if( TickTimerActive )
         {
-            // Fire the event
-            ASSERT( t->callbackOnFire != 0 );
-            (t->callbackOnFire)();
-
-            if( t->interval != 0 )          // Multishot timer?
-            {
-                t->counter = t->interval;   // Rearm multishot timers
-            }
-            else
-            {
-                tick_timer_remove( t );     // Remove single shot timers
-            }
+            tick_timer_expire( TickTimerProcessed );
         }
-
-        // This is safe because the tick_timer_remove leaves
-        // the next and previous timers alone.
-        t = t->next;
     }
 }
 
 /* -------------------------------------------------------------------------- */
 
-//! Create a new timer and link it in the list for servicing.
+//! Setup a new timer and link it in the wheel for servicing.
 PRIVATE void
 tick_timer_add( TickTimer                 *me,
                 const voidTickFireFuncPtr timeoutCallback,
@@ -186,46 +218,62 @@ tick_timer_add( TickTimer                 *me,
     REQUIRE( timeoutCallback != 0 );
     REQUIRE( timeTicks       >  0 );
 
-    // setup the timer data
+    // setup the timer data. Interval is pre-initialised before
+    // the call to this Add function.
     me->callbackOnFire = timeoutCallback;
-    me->counter        = timeTicks; // Interval is pre-initialised before
-                                    // the call to this Add function.
 
-    // link timer into the list (just at the beginning...)
-    CRITICAL_SECTION_VAR();
-    CRITICAL_SECTION_START();
-    if( TickTimerListHead == 0 )
-    {
-        TickTimerListHead = me;
-        me->next           = 0;
-        me->previous       = 0;
-    }
-    else
-    {
-        me->next           = TickTimerListHead;
-        me->next->previous = me;
-        TickTimerListHead  = me;
-        me->previous       = 0;
-    }
-    CRITICAL_SECTION_END();
+    // Count from the ISR tick so pending unprocessed ticks aren't added
+    tick_timer_link( me, TickTimerTicks + timeTicks );
+    TickTimerActive++;
 }
 
 /* -------------------------------------------------------------------------- */
 
-//! Remove an existing timer from the service list
+//! Remove an existing timer from the wheel
 PRIVATE void
 tick_timer_remove( TickTimer *me )
 {
     // check that this timer was actually in use.
     REQUIRE( me->callbackOnFire != 0 );
 
-    // Remove timer from the tick handler chain
-    CRITICAL_SECTION_VAR();
-    CRITICAL_SECTION_START();
+    tick_timer_unlink( me );
+    TickTimerActive--;
+
+    // Flag this timer as inactive.
+    me->expires        = 0;
+    me->interval       = 0;
+    me->callbackOnFire = 0;
+}
+
+/* -------------------------------------------------------------------------- */
+
+//! Link a timer in at the head of the wheel slot for its expiry tick
+PRIVATE void
+tick_timer_link( TickTimer *me, TickTimerCounter expires )
+{
+    TickTimer **head = &TickTimerWheel[expires & TICK_TIMER_WHEEL_MASK];
+
+    me->expires  = expires;
+    me->previous = 0;
+    me->next     = *head;
+
+    if( me->next != 0 )
+    {
+        me->next->previous = me;
+    }
+
+    *head = me;
+}
 
+/* -------------------------------------------------------------------------- */
+
+//! Unlink a timer from its wheel slot
+PRIVATE void
+tick_timer_unlink( TickTimer *me )
+{
     if( me->previous == 0 )
     {
-        TickTimerListHead  = me->next;
+        TickTimerWheel[me->expires & TICK_TIMER_WHEEL_MASK] = me->next;
     }
     else
     {
@@ -237,15 +285,51 @@ tick_timer_remove( TickTimer *me )
         me->next->previous = me->previous;
     }
 
-    // Flag this timer as inactive but leave the next and
-    // previous pointers alone as they are still needed in
-    // tick_timer_Tick function to traverse the list of timers.
-    // They get re initialised when the timer is Added again.
-    me->counter        = 0;
-    me->interval       = 0;
-    me->callbackOnFire = 0;
+    me->next     = 0;
+    me->previous = 0;
+}
 
-    CRITICAL_SECTION_END();
+/* -------------------------------------------------------------------------- */
+
+//! Run the callbacks of timers in the wheel slot which expire on this tick
+PRIVATE void
+tick_timer_expire( TickTimerCounter tick )
+{
+    register TickTimer *t = TickTimerWheel[tick & TICK_TIMER_WHEEL_MASK];
+
+    while( t != 0 )
+    {
+        // Timers further out than a lap of the wheel share the slot
+        if( t->expires != tick )
+        {
+            t = t->next;
+            continue;
+        }
+
+        // Pull the timer out of the slot first, so callbacks are free to
+        // start and stop other timers
+        tick_timer_unlink( t );
+
+        ASSERT( t->callbackOnFire != 0 );
+        TickTimerFiring = t;
+        (t->callbackOnFire)();
+        TickTimerFiring = NULL;
+
+        if( t->interval != 0 )          // Multishot timer?
+        {
+            tick_timer_link( t, tick + t->interval );   // Rearm without drift
+        }
+        else
+        {
+            t->expires        = 0;      // Remove single shot timers
+            t->callbackOnFire = 0;
+            TickTimerActive--;
+        }
+
+        // Other timers in the slot may have changed, so start the slot over.
+        // Timers that fired have moved on to a later tick.
+        t = TickTimerWheel[tick & TICK_TIMER_WHEEL_MASK];
+    }
 }
 
 /* -------------------------------------------------------------------------- */
@@ -256,7 +340,7 @@ tick_timer_running(void)
 {
     // When there are no timers on the active list
     // we can stop the clocks without problems.
-    return TickTimerListHead != 0;
+    return TickTimerActive != 0;
 }
 
 /* ----------------------- End --------------------------------------------- */
@@ -36,14 +36,14 @@ typedef uint32_t TickTimerCounter;
 //! \struct TickTimer
 /// Structure to be declared by the application to support a tick timer. Stores the
 /// relevant call back pointers, timer counters and interval reload counters as well
-/// link pointers for the tick-timer package to maintain chains of active timers.
+/// link pointers for the tick-timer package to maintain the timing wheel slots.
 typedef struct TickTimer TickTimer;
 struct TickTimer
 {
   voidTickFireFuncPtr callbackOnFire; //<! callback function to deliver the event to
-  TickTimer           *next;          //<! link to next timer in the list
-  TickTimer           *previous;      //<! link to previous timer in the list
-  TickTimerCounter    counter;        //<! timer counting down to 0 to fire the event
+  TickTimer           *next;          //<! link to next timer in the wheel slot
+  TickTimer           *previous;      //<! link to previous timer in the wheel slot
+  TickTimerCounter    expires;        //<! tick count the timer fires at
   TickTimerCounter    interval;       //<! reload value for repeating timers. 0 for single shot
 };
 
@@ -83,10 +83,14 @@ tick_timer_restart( TickTimer              *me,
 PUBLIC bool
 tick_timer_is_active( TickTimer *me );
 
-//! timerTick to be called usually from ISR context
+//! timerTick to be called from the system tick ISR
 PUBLIC void
 tick_timer_tick( void );
 
+//! Run the callbacks of expired timers. Called from the main loop.
+PUBLIC void
+tick_timer_process( void );
+
 //! Return TRUE when there are one or more timers running
 PUBLIC bool
 tick_timer_running( void );
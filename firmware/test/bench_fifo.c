@@ -0,0 +1,406 @@
+/* Host benchmark and check of the byte fifo
+ *
+ * Compares throughput of the power-of-two ring against the fifo it replaced,
+ * which wrote and read a byte at a time with a compare-and-wrap on every
+ * index step. Bytes go through a 256 byte fifo in chunks, written then read
+ * back, as the UART TX path uses it.
+ *
+ * Also checks ordering across the wrap with mixed chunk sizes, the DMA span
+ * calls, and a writer thread and reader thread sharing the ring without a
+ * lock.
+ */
+
+/* ----- System Includes ---------------------------------------------------- */
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+/* ----- Local Includes ----------------------------------------------------- */
+
+#include "fifo.h"
+
+/* ----- Defines ------------------------------------------------------------ */
+
+#define BENCH_FIFO_SIZE 256U
+#define BENCH_BYTES     20000000UL
+#define BENCH_MAX_CHUNK 64U
+
+#define WRAP_ROUNDS     100000U
+#define THREAD_BYTES    20000000UL
+
+/* ----- Types -------------------------------------------------------------- */
+
+// The previous fifo, one slot is always left empty
+typedef struct
+{
+    uint8_t *buf;
+    uint32_t head;
+    uint32_t tail;
+    uint32_t capacity;
+} prev_fifo_t;
+
+/* ----- Private Variables -------------------------------------------------- */
+
+PRIVATE uint8_t     storage[BENCH_FIFO_SIZE];
+PRIVATE fifo_t      fifo;
+PRIVATE prev_fifo_t prev_fifo;
+
+PRIVATE volatile uint32_t sink;
+PRIVATE int               failures = 0;
+
+/* ----- Stubs -------------------------------------------------------------- */
+
+void
+onAssert__( const char *file, unsigned line, const char *fmt, ... )
+{
+    printf( "ASSERT %s:%u\n", file, line );
+    failures++;
+}
+
+/* ----- Previous Fifo ------------------------------------------------------ */
+
+PRIVATE uint32_t
+prev_fifo_next( prev_fifo_t *f, uint32_t index )
+{
+    index++;
+    if( index >= f->capacity )
+    {
+        index = 0;
+    }
+    return index;
+}
+
+PRIVATE bool
+prev_fifo_put( prev_fifo_t *f, const uint8_t ch )
+{
+    const uint32_t new_head = prev_fifo_next( f, f->head );
+    if( new_head != f->tail )
+    {
+        f->buf[f->head] = ch;
+        f->head         = new_head;
+        return true;
+    }
+    return false;
+}
+
+PRIVATE uint8_t *
+prev_fifo_get( prev_fifo_t *f )
+{
+    if( f->tail != f->head )
+    {
+        uint8_t *ch = &f->buf[f->tail];
+        f->tail     = prev_fifo_next( f, f->tail );
+        return ch;
+    }
+    return NULL;
+}
+
+// Both of these are marked noinline so they aren't folded into the benchmark
+// loop any more than the real fifo, which is in another translation unit
+
+PRIVATE __attribute__( ( noinline ) ) uint32_t
+prev_fifo_write( prev_fifo_t *f, const uint8_t *buf, uint32_t nbytes )
+{
+    uint32_t count = 0;
+    for( uint32_t i = 0; i < nbytes; i++ )
+    {
+        if( !prev_fifo_put( f, buf[i] ) )
+        {
+            break;
+        }
+        count++;
+    }
+    return count;
+}
+
+PRIVATE __attribute__( ( noinline ) ) uint32_t
+prev_fifo_read( prev_fifo_t *f, uint8_t *buf, uint32_t nbytes )
+{
+    uint32_t count = 0;
+    for( uint32_t i = 0; i < nbytes; i++ )
+    {
+        uint8_t *p = prev_fifo_get( f );
+        if( !p )
+        {
+            break;
+        }
+        buf[i] = *p;
+        count++;
+    }
+    return count;
+}
+
+/* ----- Private Functions -------------------------------------------------- */
+
+PRIVATE void
+check( bool ok, const char *what )
+{
+    if( !ok )
+    {
+        printf( "FAIL: %s\n", what );
+        failures++;
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+
+PRIVATE double
+now_ns( void )
+{
+    struct timespec t;
+    clock_gettime( CLOCK_MONOTONIC, &t );
+    return ( t.tv_sec * 1e9 ) + t.tv_nsec;
+}
+
+/* -------------------------------------------------------------------------- */
+
+// Megabytes a second written and read back in chunks of the given size
+PRIVATE double
+bench_chunks( bool previous, uint32_t chunk )
+{
+    uint8_t  in[BENCH_MAX_CHUNK];
+    uint8_t  out[BENCH_MAX_CHUNK];
+    uint64_t moved = 0;
+
+    memset( in, 0x5A, sizeof( in ) );
+    fifo_init( &fifo, storage, BENCH_FIFO_SIZE );
+    prev_fifo = ( prev_fifo_t ){ .buf = storage, .capacity = BENCH_FIFO_SIZE };
+
+    double start = now_ns();
+
+    while( moved < BENCH_BYTES )
+    {
+        if( previous )
+        {
+            prev_fifo_write( &prev_fifo, in, chunk );
+            moved += prev_fifo_read( &prev_fifo, out, chunk );
+        }
+        else
+        {
+            fifo_write( &fifo, in, chunk );
+            moved += fifo_read( &fifo, out, chunk );
+        }
+        sink += out[0];
+    }
+
+    return moved * 1e3 / ( now_ns() - start );
+}
+
+/* -------------------------------------------------------------------------- */
+
+// Single bytes, as the UART putc path uses it
+PRIVATE double
+bench_bytes( bool previous )
+{
+    uint64_t moved = 0;
+    uint8_t  ch    = 0;
+
+    fifo_init( &fifo, storage, BENCH_FIFO_SIZE );
+    prev_fifo = ( prev_fifo_t ){ .buf = storage, .capacity = BENCH_FIFO_SIZE };
+
+    double start = now_ns();
+
+    while( moved < BENCH_BYTES )
+    {
+        if( previous )
+        {
+            prev_fifo_put( &prev_fifo, (uint8_t)moved );
+            ch = *prev_fifo_get( &prev_fifo );
+        }
+        else
+        {
+            fifo_put( &fifo, (uint8_t)moved );
+            fifo_get( &fifo, &ch );
+        }
+        sink += ch;
+        moved++;
+    }
+
+    return moved * 1e3 / ( now_ns() - start );
+}
+
+/* -------------------------------------------------------------------------- */
+
+// Uneven writes and reads walk the head and tail all the way round the
+// buffer, every byte has to come out in the order it went in
+PRIVATE void
+check_wrap_ordering( void )
+{
+    uint8_t  chunk[100];
+    uint8_t  next_in  = 0;
+    uint8_t  next_out = 0;
+    bool     in_order = true;
+    bool     counted  = true;
+
+    fifo_init( &fifo, storage, BENCH_FIFO_SIZE );
+    check( fifo_size( &fifo ) == BENCH_FIFO_SIZE, "the whole buffer is usable" );
+
+    for( uint32_t r = 0; r < WRAP_ROUNDS; r++ )
+    {
+        uint32_t to_write = ( r * 37U ) % 100U;
+        uint32_t to_read  = ( r * 53U ) % 100U;
+        uint32_t space    = fifo_free( &fifo );
+
+        for( uint32_t i = 0; i < to_write; i++ )
+        {
+            chunk[i] = (uint8_t)( next_in + i );
+        }
+
+        uint32_t written = fifo_write( &fifo, chunk, to_write );
+        counted &= ( written == MIN( to_write, space ) );
+        next_in += written;
+
+        uint32_t used = fifo_used( &fifo );
+        uint32_t read = fifo_read( &fifo, chunk, to_read );
+        counted &= ( read == MIN( to_read, used ) );
+
+        for( uint32_t i = 0; i < read; i++ )
+        {
+            in_order &= ( chunk[i] == next_out++ );
+        }
+    }
+
+    check( counted, "writes and reads stop at full and empty" );
+    check( in_order, "bytes come out in order across the wrap" );
+}
+
+/* -------------------------------------------------------------------------- */
+
+// DMA out takes the run up to the end of the buffer, then the rest from the start
+PRIVATE void
+check_spans( void )
+{
+    uint8_t        chunk[BENCH_FIFO_SIZE];
+    const uint8_t *out;
+    uint8_t       *in;
+
+    fifo_init( &fifo, storage, BENCH_FIFO_SIZE );
+
+    // Leave the head and tail 16 bytes short of the end
+    memset( chunk, 0, sizeof( chunk ) );
+    fifo_write( &fifo, chunk, BENCH_FIFO_SIZE - 16U );
+    fifo_read( &fifo, chunk, BENCH_FIFO_SIZE - 16U );
+
+    for( uint32_t i = 0; i < 40U; i++ )
+    {
+        chunk[i] = (uint8_t)i;
+    }
+    fifo_write( &fifo, chunk, 40U );
+
+    check( fifo_peek_span( &fifo, &out ) == 16U && out[0] == 0 && out[15] == 15,
+           "the first span runs to the end of the buffer" );
+    check( fifo_skip( &fifo, 16U ) == 16U, "a span is released with skip" );
+    check( fifo_peek_span( &fifo, &out ) == 24U && out[0] == 16 && out == storage,
+           "the next span starts at the beginning" );
+    check( fifo_skip( &fifo, 25U ) == 0, "can't skip past the head" );
+    fifo_skip( &fifo, 24U );
+
+    check( fifo_reserve_span( &fifo, &in ) == BENCH_FIFO_SIZE - 24U && in == &storage[24],
+           "reserve runs to the end of the buffer" );
+    in[0] = 0xA5;
+    check( fifo_used( &fifo ) == 0, "reserved bytes aren't visible" );
+    check( fifo_commit( &fifo, 1U ) == 1U && fifo_used( &fifo ) == 1U, "commit publishes them" );
+    check( *fifo_peek( &fifo ) == 0xA5, "the committed byte is read back" );
+    check( fifo_commit( &fifo, BENCH_FIFO_SIZE ) == 0, "can't commit past the tail" );
+}
+
+/* -------------------------------------------------------------------------- */
+
+PRIVATE void *
+writer_thread( void *arg )
+{
+    uint8_t  chunk[BENCH_MAX_CHUNK];
+    uint32_t sent = 0;
+
+    while( sent < THREAD_BYTES )
+    {
+        uint32_t length = 1U + ( sent % BENCH_MAX_CHUNK );
+
+        length = MIN( length, THREAD_BYTES - sent );
+
+        for( uint32_t i = 0; i < length; i++ )
+        {
+            chunk[i] = (uint8_t)( ( sent + i ) * 7U );
+        }
+
+        uint32_t written = fifo_write( &fifo, chunk, length );
+
+        if( written == 0 )
+        {
+            sched_yield();
+        }
+        sent += written;
+    }
+
+    return NULL;
+}
+
+/* -------------------------------------------------------------------------- */
+
+// One writer thread and the main thread reading, with no lock between them
+PRIVATE void
+check_threaded( void )
+{
+    pthread_t writer;
+    uint32_t  received = 0;
+    bool      in_order = true;
+
+    fifo_init( &fifo, storage, BENCH_FIFO_SIZE );
+    pthread_create( &writer, NULL, writer_thread, NULL );
+
+    while( received < THREAD_BYTES )
+    {
+        const uint8_t *data;
+        uint32_t       length = fifo_peek_span( &fifo, &data );
+
+        if( length == 0 )
+        {
+            sched_yield();
+            continue;
+        }
+
+        for( uint32_t i = 0; i < length; i++ )
+        {
+            in_order &= ( data[i] == (uint8_t)( ( received + i ) * 7U ) );
+        }
+
+        fifo_skip( &fifo, length );
+        received += length;
+    }
+
+    pthread_join( writer, NULL );
+    check( in_order, "a reader thread sees the writer's bytes in order" );
+}
+
+/* ----- Public Functions --------------------------------------------------- */
+
+int
+main( void )
+{
+    const uint32_t chunk_sizes[] = { 1, 8, 32, 64 };
+
+    check_wrap_ordering();
+    check_spans();
+    check_threaded();
+
+    printf( "Fifo throughput through %u bytes, MB/s\n", BENCH_FIFO_SIZE );
+    printf( "%10s %10s %10s\n", "chunk", "previous", "ring" );
+
+    for( uint8_t i = 0; i < DIM( chunk_sizes ); i++ )
+    {
+        printf( "%10u %10.0f %10.0f\n",
+                chunk_sizes[i],
+                bench_chunks( true, chunk_sizes[i] ),
+                bench_chunks( false, chunk_sizes[i] ) );
+    }
+
+    printf( "%10s %10.0f %10.0f\n", "put/get", bench_bytes( true ), bench_bytes( false ) );
+
+    printf( "%s\n", failures ? "fifo FAILED" : "fifo OK" );
+    return failures ? 1 : 0;
+}
+
+/* ----- End ---------------------------------------------------------------- */
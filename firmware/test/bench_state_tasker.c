@@ -0,0 +1,206 @@
+/* Host benchmark of the state tasker
+ *
+ * Measures the tasker overhead per dispatched event as the number of tasks
+ * grows, with one task ready at a time, every task ready at once, and a
+ * burst of events queued for one task. The task handlers do nothing, so the
+ * time is the tasker, queue and HSM dispatch cost.
+ */
+
+/* ----- System Includes ---------------------------------------------------- */
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+/* ----- Local Includes ----------------------------------------------------- */
+
+#include "state_task.h"
+#include "state_tasker.h"
+
+/* ----- Defines ------------------------------------------------------------ */
+
+#define BENCH_MAX_TASKS   32U    // ids 1-31 fit in the ready set, 0 is idle
+#define BENCH_QUEUE_DEPTH 64U
+#define BENCH_EVENTS      2000000UL
+
+/* ----- Types -------------------------------------------------------------- */
+
+typedef struct
+{
+    StateTask super;
+    uint32_t  handled;
+} BenchTask;
+
+/* ----- Private Variables -------------------------------------------------- */
+
+PRIVATE StateTasker_t tasker;
+PRIVATE StateTask    *task_table[BENCH_MAX_TASKS];
+PRIVATE BenchTask     tasks[BENCH_MAX_TASKS];
+PRIVATE StateEvent   *queues[BENCH_MAX_TASKS][BENCH_QUEUE_DEPTH];
+
+// Static events aren't returned to a pool after dispatch
+PRIVATE const StateEvent bench_event = { .signal = STATE_USER_SIGNAL };
+
+PRIVATE int failures = 0;
+
+/* ----- Stubs -------------------------------------------------------------- */
+
+void
+onAssert__( const char *file, unsigned line, const char *fmt, ... )
+{
+    printf( "ASSERT %s:%u\n", file, line );
+    failures++;
+}
+
+/* ----- Task --------------------------------------------------------------- */
+
+PRIVATE STATE
+BenchTask_main( BenchTask *me, const StateEvent *e )
+{
+    if( e->signal == STATE_USER_SIGNAL )
+    {
+        me->handled++;
+        return 0;
+    }
+    return (STATE)hsmTop;
+}
+
+PRIVATE void
+BenchTask_initial( BenchTask *me, const StateEvent *e __attribute__( ( __unused__ ) ) )
+{
+    STATE_INIT( &BenchTask_main );
+}
+
+/* ----- Private Functions -------------------------------------------------- */
+
+PRIVATE double
+now_ns( void )
+{
+    struct timespec t;
+    clock_gettime( CLOCK_MONOTONIC, &t );
+    return ( t.tv_sec * 1e9 ) + t.tv_nsec;
+}
+
+/* -------------------------------------------------------------------------- */
+
+PRIVATE void
+create_task( uint8_t id )
+{
+    memset( &tasks[id], 0, sizeof( BenchTask ) );
+    stateTaskCtor( &tasks[id].super, (State)&BenchTask_initial );
+    stateTaskCreate( &tasks[id].super, queues[id], BENCH_QUEUE_DEPTH, NULL, 0 );
+}
+
+/* -------------------------------------------------------------------------- */
+
+PRIVATE void
+setup( uint8_t num_tasks )
+{
+    memset( task_table, 0, sizeof( task_table ) );
+    stateTaskerInit( &tasker, task_table, BENCH_MAX_TASKS );
+
+    for( uint8_t id = 1; id <= num_tasks; id++ )
+    {
+        create_task( id );
+        stateTaskerAddTask( &tasker, &tasks[id].super, id, "bench" );
+        stateTaskerStartTask( &tasker, &tasks[id].super );
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+
+PRIVATE uint32_t
+drain( void )
+{
+    uint32_t dispatched = 0;
+
+    while( stateTaskerRunEvent( &tasker ) )
+    {
+        dispatched++;
+    }
+
+    // The last event run clears the final ready flag
+    return dispatched + 1;
+}
+
+/* -------------------------------------------------------------------------- */
+
+// Post a round of events and run them, returning the nanoseconds per event
+PRIVATE double
+bench( uint8_t num_tasks, uint8_t ready_tasks, uint8_t burst )
+{
+    setup( num_tasks );
+
+    uint32_t dispatched = 0;
+    double   start      = now_ns();
+
+    while( dispatched < BENCH_EVENTS )
+    {
+        // Spread the ready tasks across the ids so lookups don't always find the top bit
+        for( uint8_t r = 0; r < ready_tasks; r++ )
+        {
+            uint8_t id = 1 + ( ( r * 7U ) % num_tasks );
+
+            for( uint8_t b = 0; b < burst; b++ )
+            {
+                stateTaskPostFIFO( &tasks[id].super, &bench_event );
+            }
+        }
+
+        dispatched += drain();
+    }
+
+    return ( now_ns() - start ) / dispatched;
+}
+
+/* -------------------------------------------------------------------------- */
+
+// A task can be posted to before it's added to the tasker, e.g. by a publish during startup
+PRIVATE void
+check_post_before_add( void )
+{
+    memset( task_table, 0, sizeof( task_table ) );
+    stateTaskerInit( &tasker, task_table, BENCH_MAX_TASKS );
+
+    create_task( 3 );
+    stateTaskPostFIFO( &tasks[3].super, &bench_event );
+
+    stateTaskerAddTask( &tasker, &tasks[3].super, 3, "early" );
+    stateTaskerStartTask( &tasker, &tasks[3].super );
+    stateTaskerRunEvent( &tasker );
+
+    if( tasks[3].handled != 1 )
+    {
+        printf( "FAIL: event posted before the task was added never ran\n" );
+        failures++;
+    }
+}
+
+/* ----- Public Functions --------------------------------------------------- */
+
+int
+main( void )
+{
+    const uint8_t task_counts[] = { 1, 2, 4, 8, 16, 31 };
+
+    check_post_before_add();
+
+    printf( "Tasker overhead per event, ns\n" );
+    printf( "%6s %10s %10s %10s\n", "tasks", "one ready", "all ready", "burst 32" );
+
+    for( uint8_t i = 0; i < DIM( task_counts ); i++ )
+    {
+        uint8_t n = task_counts[i];
+
+        printf( "%6u %10.1f %10.1f %10.1f\n",
+                n,
+                bench( n, 1, 1 ),
+                bench( n, n, 1 ),
+                bench( n, 1, 32 ) );
+    }
+
+    printf( "%s\n", failures ? "state tasker FAILED" : "state tasker OK" );
+    return failures ? 1 : 0;
+}
+
+/* ----- End ---------------------------------------------------------------- */
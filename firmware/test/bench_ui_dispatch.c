@@ -0,0 +1,207 @@
+/* Host benchmark of the inbound UI write dispatch
+ *
+ * Compares the hashed handler table against the chain of strcmp calls it
+ * replaced, as the number of message types with a handler grows. Each
+ * lookup is either a write with a handler, or a setting the library has
+ * already stored with nothing more to do, which is the common case. The
+ * strcmp chain tested every ID for every packet, so it runs to the end.
+ */
+
+/* ----- System Includes ---------------------------------------------------- */
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+/* ----- Local Includes ----------------------------------------------------- */
+
+#include "ui_dispatch.h"
+
+/* ----- Defines ------------------------------------------------------------ */
+
+#define BENCH_MAX_HANDLERS 64U
+#define BENCH_MAX_SLOTS    128U
+#define BENCH_LOOKUPS      4000000UL
+
+// Settings written by the UI which have no handler
+#define BENCH_NUM_SETTINGS 8U
+
+/* ----- Private Variables -------------------------------------------------- */
+
+// The firmware's own handler IDs first, then made up ones
+PRIVATE const char *known_ids[] = {
+    "req_mode", "route", "inmv", "mvc", "mvb", "inlt", "ltb", "tpos",
+    "exp_ang", "hsv", "ledset", "capture", "loop_bgt", "pdec", "trace_rd",
+};
+
+PRIVATE const char *setting_ids[BENCH_NUM_SETTINGS] = {
+    "fan_man", "fan_en", "shaper", "lag_ms", "pwr_cal", "tel_per", "cam_cfg", "led_cal",
+};
+
+PRIVATE char        id_names[BENCH_MAX_HANDLERS][12];
+PRIVATE const char *handler_ids[BENCH_MAX_HANDLERS];
+PRIVATE UiHandler_t handlers[BENCH_MAX_HANDLERS];
+PRIVATE uint32_t    hashes[BENCH_MAX_HANDLERS];
+PRIVATE uint8_t     slots[BENCH_MAX_SLOTS];
+
+PRIVATE UiDispatch_t dispatch;
+
+PRIVATE volatile uint32_t handled;
+PRIVATE int               failures = 0;
+
+/* ----- Stubs -------------------------------------------------------------- */
+
+void
+onAssert__( const char *file, unsigned line, const char *fmt, ... )
+{
+    printf( "ASSERT %s:%u\n", file, line );
+    failures++;
+}
+
+/* ----- Private Functions -------------------------------------------------- */
+
+PRIVATE void
+handle_write( uint8_t link, uint16_t length )
+{
+    handled += length;
+}
+
+/* -------------------------------------------------------------------------- */
+
+PRIVATE double
+now_ns( void )
+{
+    struct timespec t;
+    clock_gettime( CLOCK_MONOTONIC, &t );
+    return ( t.tv_sec * 1e9 ) + t.tv_nsec;
+}
+
+/* -------------------------------------------------------------------------- */
+
+PRIVATE void
+setup( uint8_t num_handlers )
+{
+    for( uint8_t i = 0; i < num_handlers; i++ )
+    {
+        if( i < DIM( known_ids ) )
+        {
+            strcpy( id_names[i], known_ids[i] );
+        }
+        else
+        {
+            snprintf( id_names[i], sizeof( id_names[i] ), "msg_%02u", i );
+        }
+
+        handler_ids[i]      = id_names[i];
+        handlers[i].id      = id_names[i];
+        handlers[i].handler = handle_write;
+    }
+
+    // Same sizing rule as the firmware, at least twice the handlers
+    uint16_t num_slots = 32U;
+
+    while( num_slots < num_handlers * 2U )
+    {
+        num_slots *= 2U;
+    }
+
+    ui_dispatch_init( &dispatch, handlers, num_handlers, hashes, slots, num_slots );
+}
+
+/* -------------------------------------------------------------------------- */
+
+// How the callback used to find handlers
+PRIVATE const UiHandler_t *
+strcmp_chain_find( uint8_t num_handlers, const uint8_t *id )
+{
+    const UiHandler_t *found = NULL;
+
+    for( uint8_t i = 0; i < num_handlers; i++ )
+    {
+        if( strcmp( (const char *)id, handlers[i].id ) == 0 )
+        {
+            found = &handlers[i];
+        }
+    }
+
+    return found;
+}
+
+/* -------------------------------------------------------------------------- */
+
+PRIVATE void
+check_lookups( uint8_t num_handlers )
+{
+    for( uint8_t i = 0; i < num_handlers; i++ )
+    {
+        if( ui_dispatch_find( &dispatch, (const uint8_t *)handlers[i].id ) != &handlers[i] )
+        {
+            printf( "FAIL: %s doesn't find its handler with %u handlers\n", handlers[i].id, num_handlers );
+            failures++;
+        }
+    }
+
+    for( uint8_t i = 0; i < BENCH_NUM_SETTINGS; i++ )
+    {
+        if( ui_dispatch_find( &dispatch, (const uint8_t *)setting_ids[i] ) )
+        {
+            printf( "FAIL: %s found a handler it doesn't have\n", setting_ids[i] );
+            failures++;
+        }
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+
+// Nanoseconds per packet, cycling through the IDs
+PRIVATE double
+bench( uint8_t num_handlers, bool hashed, bool with_handler )
+{
+    const char **ids     = with_handler ? handler_ids : setting_ids;
+    uint8_t      num_ids = with_handler ? num_handlers : BENCH_NUM_SETTINGS;
+    double       start   = now_ns();
+
+    for( uint32_t n = 0; n < BENCH_LOOKUPS; n++ )
+    {
+        const uint8_t     *id = (const uint8_t *)ids[n % num_ids];
+        const UiHandler_t *h  = hashed ? ui_dispatch_find( &dispatch, id ) : strcmp_chain_find( num_handlers, id );
+
+        if( h )
+        {
+            h->handler( 0, 1 );
+        }
+    }
+
+    return ( now_ns() - start ) / BENCH_LOOKUPS;
+}
+
+/* ----- Public Functions --------------------------------------------------- */
+
+int
+main( void )
+{
+    const uint8_t handler_counts[] = { 4, 8, 15, 32, 64 };
+
+    printf( "Dispatch cost per packet, ns\n" );
+    printf( "%8s %12s %12s %12s %12s\n", "handlers", "hash write", "chain write", "hash other", "chain other" );
+
+    for( uint8_t i = 0; i < DIM( handler_counts ); i++ )
+    {
+        uint8_t n = handler_counts[i];
+
+        setup( n );
+        check_lookups( n );
+
+        printf( "%8u %12.1f %12.1f %12.1f %12.1f\n",
+                n,
+                bench( n, true, true ),
+                bench( n, false, true ),
+                bench( n, true, false ),
+                bench( n, false, false ) );
+    }
+
+    printf( "%s\n", failures ? "ui dispatch FAILED" : "ui dispatch OK" );
+    return failures ? 1 : 0;
+}
+
+/* ----- End ---------------------------------------------------------------- */
@@ -0,0 +1,33 @@
+/* Host stand-ins for the interrupt macros in global.h
+ *
+ * Threads play the part of interrupt handlers. A thread marks itself as an
+ * interrupt with host_in_interrupt, and a critical section takes a recursive
+ * lock so that it excludes the other "interrupts" the way masking them does
+ * on the target. Memory barriers, and the point just before a compare and
+ * swap, are places where a check can preempt the running code with a higher
+ * priority "interrupt", unless it is masked.
+ * Pulled in ahead of global.h with -include.
+ */
+
+#ifndef HOST_INTERRUPTS_H
+#define HOST_INTERRUPTS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+extern __thread bool host_in_interrupt;
+
+void host_interrupts_disable( void );
+void host_interrupts_restore( void );
+void host_memory_barrier( void );
+bool host_compare_and_swap( volatile uint32_t *ptr, uint32_t expected, uint32_t desired );
+
+#define CRITICAL_SECTION_VAR()
+#define CRITICAL_SECTION_START() host_interrupts_disable()
+#define CRITICAL_SECTION_END()   host_interrupts_restore()
+#define IN_INTERRUPT()           host_in_interrupt
+#define MEMORY_BARRIER()         host_memory_barrier()
+
+#define COMPARE_AND_SWAP( ptr, expected, desired ) host_compare_and_swap( ptr, expected, desired )
+
+#endif /* HOST_INTERRUPTS_H */
@@ -0,0 +1,372 @@
+/* Host stress test of the interrupt event inbox
+ *
+ * Several threads publish as if they were interrupt handlers, while the main
+ * thread drains the inbox with eventPublishDeferred and runs a subscribed
+ * task. Each thread also stands for a higher priority interrupt, which
+ * preempts the thread's own publishing between reading the head and claiming
+ * the slot, and between claiming the slot and filling it. Every event has to
+ * arrive exactly once, and in order for each source.
+ *
+ * Publishing from an interrupt mustn't mask interrupts, so every thread has
+ * to have been preempted at both points, and never held off.
+ */
+
+/* ----- System Includes ---------------------------------------------------- */
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+/* ----- Local Includes ----------------------------------------------------- */
+
+#include "event_subscribe.h"
+#include "state_task.h"
+#include "state_tasker.h"
+
+/* ----- Defines ------------------------------------------------------------ */
+
+#define PRODUCERS        4U
+#define SOURCES          ( PRODUCERS * 2U )    // a low and a high priority source each
+#define EVENTS_PER       100000U
+
+// Events a source can have in flight, keeps the task queue from overflowing
+#define SOURCE_WINDOW    8U
+#define QUEUE_DEPTH      ( SOURCES * SOURCE_WINDOW )
+
+// Chances to preempt between higher priority interrupts
+#define PREEMPT_EVERY    3U
+
+#define SUBSCRIBER_ID    1U
+#define MAX_TASKS        2U
+#define MAX_SIGNALS      ( STATE_USER_SIGNAL + 1U )
+
+#define TIMEOUT_S        20
+
+/* ----- Types -------------------------------------------------------------- */
+
+typedef struct
+{
+    StateTask super;
+} SubscriberTask;
+
+/* ----- Private Variables -------------------------------------------------- */
+
+PRIVATE StateTasker_t    tasker;
+PRIVATE StateTask       *task_table[MAX_TASKS];
+PRIVATE EventSubscribers subscribers[MAX_SIGNALS];
+PRIVATE SubscriberTask   subscriber;
+PRIVATE StateEvent      *queue[QUEUE_DEPTH];
+
+// Static events aren't returned to a pool, so each one stands for itself
+PRIVATE StateEvent events[SOURCES][EVENTS_PER];
+
+PRIVATE uint32_t          sent[SOURCES];       // by the producer threads
+PRIVATE volatile uint32_t received[SOURCES];   // by the main loop
+PRIVATE volatile uint32_t preempted_claim[PRODUCERS];   // between the head read and the swap
+PRIVATE volatile uint32_t preempted_fill[PRODUCERS];    // between the claim and the fill
+PRIVATE volatile uint32_t claims_lost[PRODUCERS];       // swaps which failed and were retried
+PRIVATE volatile uint32_t held_off[PRODUCERS];
+PRIVATE volatile bool     stalled;
+
+PRIVATE int failures = 0;
+
+PRIVATE pthread_mutex_t interrupt_mask;
+
+PRIVATE __thread uint32_t producer_id;
+PRIVATE __thread uint32_t masked;
+PRIVATE __thread uint32_t claim_chances;
+PRIVATE __thread uint32_t fill_chances;
+PRIVATE __thread bool     preempting;   // the higher priority interrupt is running
+
+/* ----- Private Prototypes ------------------------------------------------- */
+
+PRIVATE bool
+publish_next( uint32_t source );
+
+PRIVATE bool
+preempt( uint32_t *chances );
+
+/* ----- Stubs -------------------------------------------------------------- */
+
+__thread bool host_in_interrupt = false;
+
+void
+host_interrupts_disable( void )
+{
+    pthread_mutex_lock( &interrupt_mask );
+    masked++;
+
+    if( host_in_interrupt )
+    {
+        held_off[producer_id]++;
+    }
+}
+
+void
+host_interrupts_restore( void )
+{
+    masked--;
+    pthread_mutex_unlock( &interrupt_mask );
+}
+
+// The only barrier an interrupt passes while publishing sits between
+// claiming a slot and filling it
+void
+host_memory_barrier( void )
+{
+    __sync_synchronize();
+
+    if( preempt( &fill_chances ) )
+    {
+        preempted_fill[producer_id]++;
+    }
+}
+
+// The head has been read, and is about to be moved on
+bool
+host_compare_and_swap( volatile uint32_t *ptr, uint32_t expected, uint32_t desired )
+{
+    if( preempt( &claim_chances ) )
+    {
+        preempted_claim[producer_id]++;
+    }
+
+    if( __sync_bool_compare_and_swap( ptr, expected, desired ) )
+    {
+        return true;
+    }
+
+    claims_lost[producer_id]++;
+    return false;
+}
+
+void
+onAssert__( const char *file, unsigned line, const char *fmt, ... )
+{
+    printf( "ASSERT %s:%u\n", file, line );
+    failures++;
+}
+
+/* ----- Task --------------------------------------------------------------- */
+
+PRIVATE STATE
+SubscriberTask_main( SubscriberTask *me, const StateEvent *e )
+{
+    if( e->signal == STATE_USER_SIGNAL )
+    {
+        uint32_t index    = (uint32_t)( e - &events[0][0] );
+        uint32_t source   = index / EVENTS_PER;
+        uint32_t sequence = index % EVENTS_PER;
+
+        if( sequence != received[source] )
+        {
+            // Only report the first one, a lost event puts every later one out
+            if( !stalled )
+            {
+                printf( "FAIL: source %u sent event %u, expected %u\n",
+                        source, sequence, received[source] );
+                failures++;
+            }
+            stalled = true;
+        }
+
+        __sync_synchronize();
+        received[source] = sequence + 1;
+        return 0;
+    }
+    return (STATE)hsmTop;
+}
+
+PRIVATE void
+SubscriberTask_initial( SubscriberTask *me, const StateEvent *e __attribute__( ( __unused__ ) ) )
+{
+    eventSubscribe( &me->super, STATE_USER_SIGNAL );
+    STATE_INIT( &SubscriberTask_main );
+}
+
+/* ----- Private Functions -------------------------------------------------- */
+
+PRIVATE time_t
+now_s( void )
+{
+    struct timespec t;
+    clock_gettime( CLOCK_MONOTONIC, &t );
+    return t.tv_sec;
+}
+
+/* -------------------------------------------------------------------------- */
+
+// Publish the next event from a source, unless it has a window's worth in
+// flight or the inbox is full. An interrupt can't wait for the main loop.
+PRIVATE bool
+publish_next( uint32_t source )
+{
+    if( sent[source] - received[source] >= SOURCE_WINDOW )
+    {
+        return false;
+    }
+
+    if( eventPublish( &events[source][sent[source]] ) )
+    {
+        sent[source]++;
+        return true;
+    }
+
+    return false;
+}
+
+/* -------------------------------------------------------------------------- */
+
+// Run the thread's higher priority interrupt at every few chances, unless
+// interrupts are masked or it's already running. True when it published.
+PRIVATE bool
+preempt( uint32_t *chances )
+{
+    uint32_t high      = ( producer_id * 2U ) + 1U;
+    bool     published = false;
+
+    if( !host_in_interrupt || preempting || masked || ( ++*chances % PREEMPT_EVERY ) != 0 )
+    {
+        return false;
+    }
+
+    if( sent[high] < EVENTS_PER )
+    {
+        preempting = true;
+        published  = publish_next( high );
+        preempting = false;
+    }
+
+    return published;
+}
+
+/* -------------------------------------------------------------------------- */
+
+PRIVATE void *
+producer_thread( void *arg )
+{
+    time_t deadline = now_s() + TIMEOUT_S;
+
+    producer_id       = (uint32_t)(uintptr_t)arg;
+    host_in_interrupt = true;
+
+    // The low priority source first, then whatever the high one has left
+    for( uint32_t source = producer_id * 2U; source <= ( producer_id * 2U ) + 1U; source++ )
+    {
+        // Nothing preempts the high priority source
+        preempting = ( source & 1U );
+
+        while( sent[source] < EVENTS_PER && !stalled )
+        {
+            if( !publish_next( source ) )
+            {
+                if( now_s() > deadline )
+                {
+                    stalled = true;
+                }
+                sched_yield();
+            }
+        }
+    }
+
+    return NULL;
+}
+
+/* -------------------------------------------------------------------------- */
+
+PRIVATE bool
+all_received( void )
+{
+    for( uint32_t s = 0; s < SOURCES; s++ )
+    {
+        if( received[s] != EVENTS_PER )
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/* ----- Public Functions --------------------------------------------------- */
+
+int
+main( void )
+{
+    pthread_mutexattr_t attr;
+    pthread_t           producers[PRODUCERS];
+    time_t              deadline = now_s() + TIMEOUT_S;
+
+    // Critical sections nest on the target, so the lock has to as well
+    pthread_mutexattr_init( &attr );
+    pthread_mutexattr_settype( &attr, PTHREAD_MUTEX_RECURSIVE );
+    pthread_mutex_init( &interrupt_mask, &attr );
+
+    for( uint32_t s = 0; s < SOURCES; s++ )
+    {
+        for( uint32_t i = 0; i < EVENTS_PER; i++ )
+        {
+            events[s][i].signal = STATE_USER_SIGNAL;
+        }
+    }
+
+    stateTaskerInit( &tasker, task_table, MAX_TASKS );
+    eventSubscribeInit( task_table, subscribers, MAX_SIGNALS );
+
+    stateTaskCtor( &subscriber.super, (State)&SubscriberTask_initial );
+    stateTaskCreate( &subscriber.super, queue, QUEUE_DEPTH, NULL, 0 );
+    stateTaskerAddTask( &tasker, &subscriber.super, SUBSCRIBER_ID, "subscriber" );
+    stateTaskerStartTask( &tasker, &subscriber.super );
+
+    for( uint32_t p = 0; p < PRODUCERS; p++ )
+    {
+        pthread_create( &producers[p], NULL, producer_thread, (void *)(uintptr_t)p );
+    }
+
+    // The main loop
+    while( !all_received() && !stalled )
+    {
+        eventPublishDeferred();
+        while( stateTaskerRunEvent( &tasker ) )
+        {
+        }
+        sched_yield();
+
+        if( now_s() > deadline )
+        {
+            stalled = true;
+        }
+    }
+
+    for( uint32_t p = 0; p < PRODUCERS; p++ )
+    {
+        pthread_join( producers[p], NULL );
+        printf( "producer %u: %u + %u of %u received, preempted %u times claiming (%u claims lost), %u filling, held off %u times\n",
+                p, received[p * 2U], received[( p * 2U ) + 1U], EVENTS_PER,
+                preempted_claim[p], claims_lost[p], preempted_fill[p], held_off[p] );
+
+        if( !preempted_claim[p] || !preempted_fill[p] )
+        {
+            printf( "FAIL: producer %u was never preempted part way through a put\n", p );
+            failures++;
+        }
+
+        if( held_off[p] )
+        {
+            printf( "FAIL: producer %u masked interrupts to publish\n", p );
+            failures++;
+        }
+    }
+
+    if( !all_received() )
+    {
+        printf( "FAIL: events were lost\n" );
+        failures++;
+    }
+
+    printf( "%s\n", failures ? "event inbox FAILED" : "event inbox OK" );
+    return failures ? 1 : 0;
+}
+
+/* ----- End ---------------------------------------------------------------- */
@@ -0,0 +1,253 @@
+/* Host check of the input shaper
+ *
+ * Steps the shaper on a fake millisecond clock and drives a damped second
+ * order model of the arm with the output. Shaping should leave a small
+ * fraction of the ringing an unshaped step leaves behind.
+ */
+
+/* ----- System Includes ---------------------------------------------------- */
+
+#include <math.h>
+#include <stdio.h>
+
+/* ----- Local Includes ----------------------------------------------------- */
+
+#include "input_shaper.h"
+#include "hal_systick.h"
+
+/* ----- Defines ------------------------------------------------------------ */
+
+#define STEP_MICRONS 10000    // 10mm
+
+// Substeps per millisecond for the arm model
+#define MODEL_SUBSTEPS 100
+
+/* ----- Private Variables -------------------------------------------------- */
+
+PRIVATE uint32_t fake_ms  = 1000;
+PRIVATE int      failures = 0;
+
+/* ----- Stubs -------------------------------------------------------------- */
+
+PUBLIC uint32_t
+hal_systick_get_ms( void )
+{
+    return fake_ms;
+}
+
+/* ----- Private Functions -------------------------------------------------- */
+
+PRIVATE void
+check( bool ok, const char *what )
+{
+    if( !ok )
+    {
+        printf( "FAIL: %s\n", what );
+        failures++;
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+
+// Shaped x position for each millisecond of a step from 0 to STEP_MICRONS at t=0
+PRIVATE void
+shaped_step( InputShaperType_t type, float frequency, float damping, int32_t *out, uint32_t length )
+{
+    CartesianPoint_t origin = { 0 };
+    CartesianPoint_t target = { .x = STEP_MICRONS };
+    CartesianPoint_t shaped;
+
+    input_shaper_init();
+    input_shaper_configure( type, frequency, damping );
+    input_shaper_reset( &origin );
+
+    for( uint32_t i = 0; i < length; i++ )
+    {
+        fake_ms++;
+        input_shaper_process( &target, &shaped );
+        out[i] = shaped.x;
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+
+// Peak deviation from the step once the input has stopped changing
+PRIVATE float
+residual_vibration( const int32_t *input, uint32_t length, float frequency, float damping )
+{
+    const float wn = 2.0f * (float)M_PI * frequency;
+    const float dt = 0.001f / MODEL_SUBSTEPS;
+    float       x  = 0.0f;
+    float       v  = 0.0f;
+    float       residual = 0.0f;
+    uint32_t    settled  = 0;
+
+    for( uint32_t i = 1; i < length; i++ )
+    {
+        if( input[i] != input[i - 1] )
+        {
+            settled = i;
+        }
+    }
+
+    for( uint32_t i = 0; i < length; i++ )
+    {
+        for( uint32_t s = 0; s < MODEL_SUBSTEPS; s++ )
+        {
+            float a = ( wn * wn * ( input[i] - x ) ) - ( 2.0f * damping * wn * v );
+            v += a * dt;
+            x += v * dt;
+        }
+
+        if( i > settled )
+        {
+            residual = fmaxf( residual, fabsf( x - STEP_MICRONS ) );
+        }
+    }
+
+    return residual;
+}
+
+/* -------------------------------------------------------------------------- */
+
+PRIVATE void
+check_impulse_sums( void )
+{
+    int32_t response[600];
+    const InputShaperType_t types[] = { SHAPER_ZV, SHAPER_ZVD, SHAPER_EI };
+
+    for( uint8_t t = 0; t < DIM( types ); t++ )
+    {
+        shaped_step( types[t], 12.0f, 0.05f, response, DIM( response ) );
+
+        // Amplitudes sum to one, so the output ends up on the target
+        check( response[DIM( response ) - 1] == STEP_MICRONS, "shaped step reaches the target" );
+
+        // and never overshoots it on the way there
+        for( uint32_t i = 0; i < DIM( response ); i++ )
+        {
+            if( response[i] < 0 || response[i] > STEP_MICRONS )
+            {
+                check( false, "shaped step stays between the endpoints" );
+                break;
+            }
+        }
+    }
+
+    // Undamped ZV is two equal impulses half a period apart
+    shaped_step( SHAPER_ZV, 10.0f, 0.0f, response, DIM( response ) );
+    check( response[10] == STEP_MICRONS / 2, "ZV first impulse is half the step" );
+    check( response[60] == STEP_MICRONS, "ZV second impulse lands after half a period" );
+}
+
+/* -------------------------------------------------------------------------- */
+
+PRIVATE void
+check_gap_holds_previous_sample( void )
+{
+    CartesianPoint_t a = { .x = 0 };
+    CartesianPoint_t b = { .x = STEP_MICRONS };
+    CartesianPoint_t shaped;
+
+    // Undamped 100Hz ZV, two equal impulses 5ms apart
+    input_shaper_init();
+    input_shaper_configure( SHAPER_ZV, 100.0f, 0.0f );
+    input_shaper_reset( &a );
+
+    for( uint8_t i = 0; i < 10; i++ )
+    {
+        fake_ms++;
+        input_shaper_process( &a, &shaped );
+    }
+
+    // The caller misses 10ms, then the target steps
+    fake_ms += 10;
+    input_shaper_process( &b, &shaped );
+
+    check( shaped.x == STEP_MICRONS / 2, "skipped milliseconds hold the previous sample" );
+}
+
+/* -------------------------------------------------------------------------- */
+
+// Stopping part way through a shaped step has to leave the output where it was
+PRIVATE void
+check_hold_keeps_shaped_output( void )
+{
+    CartesianPoint_t a = { .x = 0 };
+    CartesianPoint_t b = { .x = STEP_MICRONS };
+    CartesianPoint_t shaped;
+    CartesianPoint_t held;
+
+    // Undamped 100Hz ZV, two equal impulses 5ms apart
+    input_shaper_init();
+    input_shaper_configure( SHAPER_ZV, 100.0f, 0.0f );
+    input_shaper_reset( &a );
+
+    fake_ms++;
+    input_shaper_process( &b, &shaped );
+
+    held = b;
+    input_shaper_hold( &held );
+    check( held.x == shaped.x, "hold returns the last shaped output" );
+
+    // The next move starts from the held position, so the output doesn't move
+    for( uint8_t i = 0; i < 10; i++ )
+    {
+        fake_ms++;
+        input_shaper_process( &held, &shaped );
+        check( shaped.x == STEP_MICRONS / 2, "held output doesn't step" );
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+
+PRIVATE void
+check_residual_vibration( void )
+{
+    static int32_t response[1000];
+    const char *names[] = { "none", "ZV", "ZVD", "EI" };
+    const float damping = 0.05f;
+
+    printf( "Residual vibration after a %dmm step, %% of unshaped\n", STEP_MICRONS / 1000 );
+    printf( "%-6s %8s %8s %8s\n", "shaper", "exact", "-10%", "+10%" );
+
+    for( uint8_t type = SHAPER_ZV; type <= SHAPER_EI; type++ )
+    {
+        float ratio[3];
+        const float error[3] = { 1.0f, 0.9f, 1.1f };
+
+        for( uint8_t e = 0; e < 3; e++ )
+        {
+            // The shaper is tuned for 12Hz, the arm rings at 12Hz with the modelling error
+            float arm = 12.0f * error[e];
+
+            shaped_step( SHAPER_NONE, 12.0f, damping, response, DIM( response ) );
+            float unshaped = residual_vibration( response, DIM( response ), arm, damping );
+
+            shaped_step( type, 12.0f, damping, response, DIM( response ) );
+            ratio[e] = 100.0f * residual_vibration( response, DIM( response ), arm, damping ) / unshaped;
+        }
+
+        printf( "%-6s %7.1f%% %7.1f%% %7.1f%%\n", names[type], ratio[0], ratio[1], ratio[2] );
+
+        // Millisecond delays put a floor under the exact case
+        check( ratio[0] < 10.0f, "shaping removes most of the ringing" );
+        check( type == SHAPER_ZV || ( ratio[1] < 25.0f && ratio[2] < 25.0f ), "ZVD and EI tolerate 10% frequency error" );
+    }
+}
+
+/* ----- Public Functions --------------------------------------------------- */
+
+int
+main( void )
+{
+    check_impulse_sums();
+    check_gap_holds_previous_sample();
+    check_hold_keeps_shaped_output();
+    check_residual_vibration();
+
+    printf( "%s\n", failures ? "input shaper FAILED" : "input shaper OK" );
+    return failures ? 1 : 0;
+}
+
+/* ----- End ---------------------------------------------------------------- */
@@ -0,0 +1,233 @@
+/* Host check of the compact move stream decoder
+ *
+ * Walks the packet headers through a full wrap of the sequence numbers, then
+ * checks that retries are ignored, that a gap leaves the decoder unsynced,
+ * and that only a reset packet brings it back.
+ *
+ * Moves are decoded from byte vectors worked out by hand from the format in
+ * movement_codec.h, covering the zig-zag varints, the chained first point,
+ * following identifiers and relative moves, then truncated and malformed
+ * input, which has to leave the decoder where it was and unsynced.
+ */
+
+/* ----- System Includes ---------------------------------------------------- */
+
+#include <stdio.h>
+#include <string.h>
+
+/* ----- Local Includes ----------------------------------------------------- */
+
+#include "movement_codec.h"
+
+/* ----- Private Variables -------------------------------------------------- */
+
+PRIVATE MovementDecoder_t decoder;
+PRIVATE int               failures = 0;
+
+/* ----- Private Functions -------------------------------------------------- */
+
+PRIVATE void
+check( bool ok, const char *what )
+{
+    if( !ok )
+    {
+        printf( "FAIL: %s\n", what );
+        failures++;
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+
+PRIVATE MovementDecodeResult_t
+header( uint8_t sequence, bool reset )
+{
+    uint8_t  packet[2] = { MOVEMENT_COMPACT_VERSION | ( reset ? MOVEMENT_COMPACT_FLAG_RESET : 0U ), sequence };
+    uint16_t offset    = 0;
+
+    return movement_decoder_begin( &decoder, packet, sizeof( packet ), &offset );
+}
+
+/* -------------------------------------------------------------------------- */
+
+PRIVATE void
+check_sequence_wrap( void )
+{
+    bool in_order = true;
+
+    movement_decoder_reset( &decoder );
+    check( header( 1, false ) == MOVEMENT_DECODE_UNSYNCED, "deltas need a reset packet first" );
+    check( header( 1, true ) == MOVEMENT_DECODE_OK, "a reset packet starts the stream" );
+
+    // Zero is skipped on the way round
+    for( uint16_t i = 2; i <= 255 + 1; i++ )
+    {
+        uint8_t sequence = ( i > 255 ) ? 1U : (uint8_t)i;
+
+        in_order &= ( header( sequence, false ) == MOVEMENT_DECODE_OK );
+    }
+
+    check( in_order, "sequence numbers wrap from 255 to 1" );
+
+    movement_decoder_reset( &decoder );
+    header( 255, true );
+    check( header( 0, false ) == MOVEMENT_DECODE_UNSYNCED, "zero isn't a sequence number" );
+}
+
+/* -------------------------------------------------------------------------- */
+
+PRIVATE void
+check_lost_packets( void )
+{
+    movement_decoder_reset( &decoder );
+    header( 10, true );
+    header( 11, false );
+
+    check( header( 11, false ) == MOVEMENT_DECODE_DUPLICATE, "a retry is ignored" );
+    check( header( 9, false ) == MOVEMENT_DECODE_DUPLICATE, "a late retry is ignored" );
+
+    check( header( 13, false ) == MOVEMENT_DECODE_UNSYNCED, "a gap unsyncs the stream" );
+    check( header( 12, false ) == MOVEMENT_DECODE_UNSYNCED, "the missing packet can't follow the gap" );
+    check( header( 14, false ) == MOVEMENT_DECODE_UNSYNCED, "later packets wait for a reset" );
+
+    // The host sends the lost packets again, from a reset
+    check( header( 15, true ) == MOVEMENT_DECODE_OK, "a reset packet resyncs the stream" );
+    check( header( 16, false ) == MOVEMENT_DECODE_OK, "packets follow on from the reset" );
+}
+
+/* -------------------------------------------------------------------------- */
+
+PRIVATE bool
+point_is( CartesianPoint_t *point, int32_t x, int32_t y, int32_t z )
+{
+    return point->x == x && point->y == y && point->z == z;
+}
+
+/* -------------------------------------------------------------------------- */
+
+PRIVATE void
+check_decode_moves( void )
+{
+    const uint8_t packet[] = {
+        MOVEMENT_COMPACT_VERSION | MOVEMENT_COMPACT_FLAG_RESET, 1,
+
+        // Absolute line, identifier 300, 1000ms
+        0x11, 0xAC, 0x02, 0xE8, 0x07,
+        0x01, 0x02, 0x7F,          // -1, 1, -64
+        0x80, 0x01, 0xDF, 0xA7, 0x12, 0x00,    // 64, -150000, 0
+
+        // Line chained from the previous endpoint, identifier follows on, 200ms
+        0xD1, 0xC8, 0x01,
+        0x02, 0x01, 0xC8, 0x01,    // 1, -1, 100
+
+        // Relative transit, identifier follows on, 5ms
+        0x88, 0x05,
+        0x14, 0x00, 0x09,          // 10, 0, -5
+    };
+
+    Movement_t move;
+    uint16_t   offset = 0;
+
+    movement_decoder_reset( &decoder );
+    check( movement_decoder_begin( &decoder, packet, sizeof( packet ), &offset ) == MOVEMENT_DECODE_OK,
+           "a reset packet header is accepted" );
+
+    memset( &move, 0xA5, sizeof( move ) );
+    check( movement_decode( &decoder, packet, sizeof( packet ), &offset, &move ) == MOVEMENT_DECODE_OK,
+           "an absolute line decodes" );
+    check( move.type == _LINE && move.ref == _POS_ABSOLUTE && move.num_pts == 2,
+           "the header byte gives the type, reference and number of points" );
+    check( move.identifier == 300 && move.duration == 1000, "two byte varints decode" );
+    check( point_is( &move.points[0], -1, 1, -64 ), "zig-zag deltas start from the origin after a reset" );
+    check( point_is( &move.points[1], 63, -149999, -64 ), "three byte zig-zag deltas add up" );
+    check( point_is( &move.points[2], 0, 0, 0 ) && point_is( &move.points[3], 0, 0, 0 ),
+           "unused points are zeroed" );
+    check( offset == 16, "the offset steps past the first move" );
+
+    check( movement_decode( &decoder, packet, sizeof( packet ), &offset, &move ) == MOVEMENT_DECODE_OK,
+           "a chained line decodes" );
+    check( move.identifier == 301 && move.duration == 200, "the next identifier follows on" );
+    check( point_is( &move.points[0], 63, -149999, -64 ), "a chained move starts at the previous endpoint" );
+    check( point_is( &move.points[1], 64, -150000, 36 ), "the chained move's end follows on" );
+
+    check( movement_decode( &decoder, packet, sizeof( packet ), &offset, &move ) == MOVEMENT_DECODE_OK,
+           "a relative transit decodes" );
+    check( move.type == _POINT_TRANSIT && move.ref == _POS_RELATIVE && move.num_pts == 1,
+           "the relative flag is read" );
+    check( move.identifier == 302 && move.duration == 5, "identifiers keep following on" );
+    check( point_is( &move.points[0], 74, -150000, 31 ),
+           "relative points are stepped from the previous point like any other" );
+
+    check( offset == sizeof( packet ), "the whole packet was read" );
+    check( movement_decode( &decoder, packet, sizeof( packet ), &offset, &move ) == MOVEMENT_DECODE_MALFORMED,
+           "there's nothing to read past the end" );
+}
+
+/* -------------------------------------------------------------------------- */
+
+// Decode a single move after a reset packet at the origin, the decoder is left
+// as the move leaves it
+PRIVATE MovementDecodeResult_t
+decode_one( const uint8_t *data, uint16_t length, uint16_t *offset, Movement_t *move )
+{
+    movement_decoder_reset( &decoder );
+    header( 1, true );
+
+    *offset = 0;
+    return movement_decode( &decoder, data, length, offset, move );
+}
+
+/* -------------------------------------------------------------------------- */
+
+PRIVATE void
+check_decode_malformed( void )
+{
+    Movement_t move;
+    uint16_t   offset;
+
+    const uint8_t bad_type[]        = { 0x05, 0x01, 0x01, 0x00, 0x00, 0x00 };
+    const uint8_t short_point[]     = { 0x11, 0x01, 0x64, 0x02, 0x02, 0x02, 0x02, 0x02 };
+    const uint8_t short_varint[]    = { 0x01, 0x01, 0x64, 0x02, 0x02, 0x82 };
+    const uint8_t long_varint[]     = { 0x00, 0x80, 0x80, 0x80, 0x80, 0x80, 0x01, 0x64, 0x00, 0x00, 0x00 };
+    const uint8_t long_duration[]   = { 0x80, 0x80, 0x80, 0x04, 0x00, 0x00, 0x00 };
+    const uint8_t five_byte_delta[] = { 0x80, 0x01, 0xFF, 0xFF, 0xFF, 0xFF, 0x0F, 0xFE, 0xFF, 0xFF, 0xFF, 0x0F, 0x00 };
+
+    check( decode_one( bad_type, 0, &offset, &move ) == MOVEMENT_DECODE_MALFORMED, "an empty move is malformed" );
+    check( decode_one( bad_type, sizeof( bad_type ), &offset, &move ) == MOVEMENT_DECODE_MALFORMED,
+           "an unknown move type is malformed" );
+
+    check( decode_one( short_point, sizeof( short_point ), &offset, &move ) == MOVEMENT_DECODE_MALFORMED,
+           "a move cut off part way through a point is malformed" );
+    check( offset == 0, "the offset isn't moved past a malformed move" );
+    check( !decoder.synced, "a malformed move unsyncs the decoder" );
+    check( point_is( &decoder.last_point, 0, 0, 0 ) && decoder.last_id == 0,
+           "a malformed move doesn't move the decoder on" );
+    check( header( 2, false ) == MOVEMENT_DECODE_UNSYNCED, "the next packet waits for a reset" );
+
+    check( decode_one( short_varint, sizeof( short_varint ), &offset, &move ) == MOVEMENT_DECODE_MALFORMED,
+           "a varint cut off by the end of the packet is malformed" );
+    check( decode_one( long_varint, sizeof( long_varint ), &offset, &move ) == MOVEMENT_DECODE_MALFORMED,
+           "a varint longer than five bytes is malformed" );
+    check( decode_one( long_duration, sizeof( long_duration ), &offset, &move ) == MOVEMENT_DECODE_MALFORMED,
+           "a duration past 16 bits is malformed" );
+
+    check( decode_one( five_byte_delta, sizeof( five_byte_delta ), &offset, &move ) == MOVEMENT_DECODE_OK,
+           "five byte varints decode" );
+    check( point_is( &move.points[0], INT32_MIN, INT32_MAX, 0 ), "zig-zag reaches both ends of 32 bits" );
+    check( move.identifier == 1 && offset == sizeof( five_byte_delta ), "the move after a reset is identifier 1" );
+}
+
+/* ----- Public Functions --------------------------------------------------- */
+
+int
+main( void )
+{
+    check_sequence_wrap();
+    check_lost_packets();
+    check_decode_moves();
+    check_decode_malformed();
+
+    printf( "%s\n", failures ? "movement codec FAILED" : "movement codec OK" );
+    return failures ? 1 : 0;
+}
+
+/* ----- End ---------------------------------------------------------------- */
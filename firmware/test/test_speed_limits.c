@@ -0,0 +1,193 @@
+/* Host check of the position-dependent speed limits
+ *
+ * Builds the speed grid the way the firmware does at boot, then replays the
+ * demonstration sequence through the same feasibility check the motion task
+ * applies when a move is queued. Every demo move has to pass, as they are
+ * what the machine runs in demo mode with no host attached.
+ */
+
+/* ----- System Includes ---------------------------------------------------- */
+
+#include <stdio.h>
+#include <string.h>
+
+/* ----- Local Includes ----------------------------------------------------- */
+
+#include "app_events.h"
+#include "app_times.h"
+#include "demonstration.h"
+#include "kinematics.h"
+#include "motion_types.h"
+
+/* ----- Private Variables -------------------------------------------------- */
+
+PRIVATE MotionPlannerEvent event_slot;
+
+// Where the queue leaves the effector, the demo starts at home
+PRIVATE CartesianPoint_t tail = { 0, 0, 0 };
+
+PRIVATE uint32_t moves     = 0;
+PRIVATE float    worst     = 0.0f;
+PRIVATE int      failures  = 0;
+
+/* ----- Stubs -------------------------------------------------------------- */
+
+PUBLIC float
+configuration_get_rotation_z()
+{
+    return 0.0f;
+}
+
+PUBLIC void
+user_interface_set_kinematics_mechanism_info( float shoulder_radius, float bicep_len, float forearm_len, float effector_radius )
+{
+}
+
+PUBLIC void
+user_interface_set_kinematics_limits( int32_t radius, int32_t zmin, int32_t zmax )
+{
+}
+
+PUBLIC void
+user_interface_set_kinematics_flips( int8_t x, int8_t y, int8_t z )
+{
+}
+
+PUBLIC StateEvent *
+eventPoolNewEvent( uint16_t eventSize, Signal signal )
+{
+    memset( &event_slot, 0, sizeof( event_slot ) );
+    event_slot.super.signal = signal;
+    return &event_slot.super;
+}
+
+void
+onAssert__( const char *file, unsigned line, const char *fmt, ... )
+{
+    printf( "ASSERT %s:%u\n", file, line );
+    failures++;
+}
+
+/* ----- Private Functions -------------------------------------------------- */
+
+// Highest fraction of the local limit any slice of a resolved move runs at
+PRIVATE float
+peak_fraction( Movement_t *move )
+{
+    float            slice_ms = (float)move->duration / SPEED_SAMPLE_RESOLUTION;
+    float            peak     = 0.0f;
+    CartesianPoint_t previous = { 0, 0, 0 };
+
+    cartesian_point_on_movement( move, 0.0f, &previous );
+
+    for( uint8_t i = 1; i <= SPEED_SAMPLE_RESOLUTION; i++ )
+    {
+        CartesianPoint_t sample = { 0, 0, 0 };
+        cartesian_point_on_movement( move, (float)i / SPEED_SAMPLE_RESOLUTION, &sample );
+
+        float limit = MIN( kinematics_speed_limit( &previous ), kinematics_speed_limit( &sample ) );
+        float speed = cartesian_distance_between( &previous, &sample ) / slice_ms;
+
+        peak     = MAX( peak, speed / limit );
+        previous = sample;
+    }
+
+    return peak;
+}
+
+/* -------------------------------------------------------------------------- */
+
+// Place the move from the end of the queue, as the motion task does
+PRIVATE void
+resolve( Movement_t *move )
+{
+    if( move->ref == _POS_RELATIVE )
+    {
+        for( uint8_t i = 0; i < move->num_pts; i++ )
+        {
+            move->points[i].x += tail.x;
+            move->points[i].y += tail.y;
+            move->points[i].z += tail.z;
+        }
+    }
+
+    if( move->type == _POINT_TRANSIT )
+    {
+        if( move->num_pts == 1 )
+        {
+            move->points[1] = move->points[0];
+            move->num_pts   = 2;
+        }
+
+        move->points[0] = tail;
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+
+// The demonstration publishes each move to the motion task, check it instead
+PUBLIC bool
+eventPublish( const StateEvent *e )
+{
+    MotionPlannerEvent *mpe      = (MotionPlannerEvent *)e;
+    Movement_t          resolved = mpe->move;
+
+    resolve( &resolved );
+
+    float peak = peak_fraction( &resolved );
+    worst      = MAX( worst, peak );
+
+    if( !kinematics_move_is_feasible( &resolved, true ) )
+    {
+        printf( "FAIL: demo move %u runs at %.2fx the local speed limit\n", mpe->move.identifier, peak );
+        failures++;
+    }
+
+    cartesian_point_on_movement( &resolved, 1.0f, &tail );
+    moves++;
+    return true;
+}
+
+/* -------------------------------------------------------------------------- */
+
+PRIVATE void
+check_grid( void )
+{
+    CartesianPoint_t centre = { 0, 0, MM_TO_MICRONS( 100 ) };
+    CartesianPoint_t edge   = { MM_TO_MICRONS( 225 ), 0, MM_TO_MICRONS( 200 ) };
+
+    mm_per_second_t minimum = kinematics_speed_limit_minimum();
+
+    if( minimum == 0 || kinematics_speed_limit( &edge ) < minimum )
+    {
+        printf( "FAIL: grid minimum %u isn't the slowest point\n", minimum );
+        failures++;
+    }
+
+    if( kinematics_speed_limit( &centre ) <= kinematics_speed_limit( &edge ) )
+    {
+        printf( "FAIL: the middle of the volume isn't faster than the edge\n" );
+        failures++;
+    }
+
+    printf( "speed limit: %u mm/s minimum, %u mm/s in the middle, ceiling %u mm/s\n",
+            minimum, kinematics_speed_limit( &centre ), EFFECTOR_SPEED_LIMIT );
+}
+
+/* ----- Public Functions --------------------------------------------------- */
+
+int
+main( void )
+{
+    kinematics_init();
+    check_grid();
+
+    demonstration_prepare_sequence();
+
+    printf( "demo: %u moves, fastest at %.2fx the local limit\n", moves, worst );
+
+    printf( "%s\n", failures ? "speed limits FAILED" : "speed limits OK" );
+    return failures ? 1 : 0;
+}
+
+/* ----- End ---------------------------------------------------------------- */
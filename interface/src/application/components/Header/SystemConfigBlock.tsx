@@ -345,7 +345,87 @@ const LEDCalibrationCard = () => {
   )
 }
 
-import { ServoInfo } from '../../typedState'
+import { InputShaperType, ServoInfo } from '../../typedState'
+
+const InputShaperCard = () => {
+  const shaperType: InputShaperType | null = useHardwareState(
+    state => state.shaper.type,
+  )
+
+  const types: Array<[InputShaperType, string]> = [
+    [InputShaperType.NONE, 'Off'],
+    [InputShaperType.ZV, 'ZV'],
+    [InputShaperType.ZVD, 'ZVD'],
+    [InputShaperType.EI, 'EI'],
+  ]
+
+  return (
+    <Composition templateCols="1fr" justifyItems="center">
+      <Box>
+        <h2>Input Shaping</h2>
+      </Box>
+      <Box>
+        <ButtonGroup fill>
+          {types.map(([type, label]) => (
+            <Button
+              key={type}
+              active={shaperType === type}
+              writer={state => {
+                state.shaper.type = type
+              }}
+            >
+              {label}
+            </Button>
+          ))}
+        </ButtonGroup>
+        <br />
+        <HTMLTable striped style={{ minWidth: '100%' }}>
+          <tbody>
+            <tr>
+              <td>
+                <b>Frequency</b>
+              </td>
+              <td>
+                <NumberInput
+                  accessor={state => state.shaper.frequency}
+                  writer={value => ({
+                    shaper: {
+                      frequency: value,
+                    },
+                  })}
+                  min={0}
+                  stepSize={0.5}
+                  style={{ maxWidth: '150px' }}
+                />
+              </td>
+              <td>Hz</td>
+            </tr>
+            <tr>
+              <td>
+                <b>Damping</b>
+              </td>
+              <td>
+                <NumberInput
+                  accessor={state => state.shaper.damping}
+                  writer={value => ({
+                    shaper: {
+                      damping: value,
+                    },
+                  })}
+                  min={0}
+                  max={0.99}
+                  stepSize={0.01}
+                  style={{ maxWidth: '150px' }}
+                />
+              </td>
+              <td>ratio</td>
+            </tr>
+          </tbody>
+        </HTMLTable>
+      </Box>
+    </Composition>
+  )
+}
 
 const PowerCalibrationCard = () => {
   const servo4: ServoInfo | null = useHardwareState(state => state.servo[3])
@@ -358,7 +438,7 @@ const PowerCalibrationCard = () => {
         <h2>Power Calibration</h2>
       </Box>
       <Box>
-        <IntervalRequester variables={['sys', 'servo']} interval={250} />
+        <IntervalRequester variables={['sys']} interval={250} />
         <HTMLTable striped style={{ minWidth: '100%' }}>
           <thead>
             <tr>
@@ -490,6 +570,9 @@ export const SystemSettingsCard = () => {
         <Box>
           <PowerCalibrationCard />
         </Box>
+        <Box>
+          <InputShaperCard />
+        </Box>
         <Box>
           <Button large fill intent="success" callback="save">
             Store Calibration Values
@@ -1,13 +1,32 @@
-import { HTMLTable, Icon, Intent } from '@blueprintjs/core'
+import {
+  Button as BlueprintButton,
+  HTMLTable,
+  Icon,
+  Intent,
+} from '@blueprintjs/core'
 import {
   IntervalRequester,
   useHardwareState,
 } from '@electricui/components-core'
 
-import React from 'react'
+import React, { useState } from 'react'
 import { Composition, Box } from 'atomic-layout'
-import { Statistic } from '@electricui/components-desktop-blueprint'
+import {
+  Button,
+  NumberInput,
+  Statistic,
+} from '@electricui/components-desktop-blueprint'
 import { Printer } from '@electricui/components-desktop'
+import { useTriggerAction } from '@electricui/core-actions'
+import { useSaveDialogCallFunction } from '../../hooks/useOpenDialog'
+import {
+  IsrStatistics,
+  JobStatistics,
+  LinkStatistics,
+  StateProfile,
+  UiLink,
+  UiRoute,
+} from '../../typedState'
 
 const SensorsActive = () => {
   const sensorEnabledState =
@@ -49,16 +68,163 @@ const CPUClockText = () => {
   return <div>Error getting CPU clockspeed</div>
 }
 
+// Saves the firmware's event trace as Chrome trace JSON for chrome://tracing or Perfetto
+const SaveTraceButton = () => {
+  const triggerAction = useTriggerAction()!
+
+  const cb = (selectedFilePath: string) => {
+    triggerAction('dump_trace', selectedFilePath)
+  }
+
+  const selectFile = useSaveDialogCallFunction(
+    'json',
+    'Save the event trace',
+    cb,
+  )
+
+  return (
+    <BlueprintButton onClick={selectFile} icon="timeline-events">
+      Save Event Trace
+    </BlueprintButton>
+  )
+}
+
+// 250 frames a second at the 1kHz control rate
+const POSITION_DECIMATION = 4
+
+const RecordPositionsButton = () => {
+  const triggerAction = useTriggerAction()!
+  const [recording, setRecording] = useState(false)
+
+  const cb = (selectedFilePath: string) => {
+    triggerAction('save_positions', selectedFilePath)
+    setRecording(false)
+  }
+
+  const selectFile = useSaveDialogCallFunction(
+    'csv',
+    'Save the recorded trajectory',
+    cb,
+  )
+
+  if (recording) {
+    return (
+      <BlueprintButton onClick={selectFile} icon="stop" intent={Intent.DANGER}>
+        Save Trajectory
+      </BlueprintButton>
+    )
+  }
+
+  return (
+    <BlueprintButton
+      onClick={() => {
+        triggerAction('record_positions', POSITION_DECIMATION)
+        setRecording(true)
+      }}
+      icon="record"
+    >
+      Record Trajectory
+    </BlueprintButton>
+  )
+}
+
 const SystemInfoLayout = `
 Stats Build
 Tasks Tasks
+Pools Pools
+Profile Profile
+Interrupts Interrupts
+Loop Loop
+Jobs Jobs
 `
 
+// Execution times arrive in cpu cycles, cpu_clock is in MHz
+const CyclesText = (props: { cycles: number }) => {
+  const cpu_clock = useHardwareState(state => state.sys.cpu_clock)
+
+  if (cpu_clock) {
+    return <span>{(props.cycles / cpu_clock).toFixed(1)}us</span>
+  }
+
+  return <span>{props.cycles} cycles</span>
+}
+
+const HandlerText = (props: { profile: StateProfile }) => {
+  const { profile } = props
+  const address = `0x${profile.handler.toString(16).padStart(8, '0')}`
+
+  // Hierarchical states are only known by their handler, look them up in the map file
+  if (profile.state === 255) {
+    return (
+      <span>
+        {profile.name} {address}
+      </span>
+    )
+  }
+
+  return (
+    <span>
+      {profile.name} {profile.instance} state {profile.state}
+    </span>
+  )
+}
+
+// Superloop period budgets are written as a pair, [warning, limit] in microseconds
+const LoopBudgetInput = (props: { index: number }) => {
+  const budgets: number[] = useHardwareState(state => state.loop_bgt) || [0, 0]
+
+  return (
+    <NumberInput
+      accessor={state => state.loop_bgt[props.index]}
+      writer={value => ({
+        loop_bgt: budgets.map((budget, i) =>
+          i === props.index ? value : budget,
+        ),
+      })}
+      min={0}
+      max={65535}
+    />
+  )
+}
+
+// Matches the order of HalIsrProfile_t in the firmware
+const ISR_NAMES = [
+  'SysTick',
+  'ADC',
+  'ADC DMA',
+  'Servo HLFB',
+  'Fan Tacho',
+  'UART External',
+  'UART Internal',
+  'UART Module',
+]
+
+const ISR_BUCKETS = ['<256', '<512', '<1k', '<2k', '<4k', '4k+']
+
+// Matches the order of AppEventPoolID in the firmware
+const POOL_NAMES = ['Small', 'Medium', 'Lighting', 'Motion']
+
 export const CoreSystemsInfoCard = () => {
   const num_tasks: number | null = useHardwareState(
     state => (state.tasks || []).length,
   )
 
+  const num_pools: number | null = useHardwareState(
+    state => (state.pools || []).length,
+  )
+
+  const profiles: StateProfile[] =
+    useHardwareState(state => state.profile) || []
+
+  const interrupts: IsrStatistics[] =
+    useHardwareState(state => state.isr) || []
+
+  const jobs: JobStatistics[] = useHardwareState(state => state.jobs) || []
+
+  const links: LinkStatistics[] = useHardwareState(state => state.links) || []
+
+  const routes: number[] = useHardwareState(state => state.route) || []
+
   return (
     <Composition
       areas={SystemInfoLayout}
@@ -69,7 +235,20 @@ export const CoreSystemsInfoCard = () => {
       {Areas => (
         <React.Fragment>
           <Areas.Stats>
-            <IntervalRequester interval={200} variables={['sys', 'tasks']} />
+            <IntervalRequester
+              interval={200}
+              variables={[
+                'sys',
+                'tasks',
+                'pools',
+                'profile',
+                'isr',
+                'loop',
+                'jobs',
+                'links',
+                'route',
+              ]}
+            />
             <h3>System Configuration</h3>
             <SensorsActive />
             <br />
@@ -78,6 +257,10 @@ export const CoreSystemsInfoCard = () => {
             <LastResetReason />
             <br />
             <CPUClockText />
+            <br />
+            <SaveTraceButton />
+            <br />
+            <RecordPositionsButton />
           </Areas.Stats>
           <Areas.Build>
             <HTMLTable striped style={{ minWidth: '100%' }}>
@@ -187,6 +370,265 @@ export const CoreSystemsInfoCard = () => {
               </tbody>
             </HTMLTable>
           </Areas.Tasks>
+          <Areas.Pools>
+            <HTMLTable striped style={{ minWidth: '100%' }}>
+              <thead>
+                <tr>
+                  <th>Event Pool</th>
+                  <th>Event Size</th>
+                  <th>Usage</th>
+                  <th>High Water</th>
+                  <th>Spilled</th>
+                  <th>Failed</th>
+                </tr>
+              </thead>
+              <tbody>
+                {Array.from(new Array(num_pools)).map((_, index) => (
+                  <tr key={index}>
+                    <td>
+                      <b>{POOL_NAMES[index] || index}</b>
+                    </td>
+                    <td>
+                      <Printer
+                        accessor={state => state.pools[index].event_size}
+                      />
+                      B
+                    </td>
+                    <td>
+                      <Printer accessor={state => state.pools[index].used} /> /{' '}
+                      <Printer accessor={state => state.pools[index].total} />
+                    </td>
+                    <td>
+                      <Printer
+                        accessor={state => state.pools[index].high_water}
+                      />
+                    </td>
+                    <td>
+                      <Printer accessor={state => state.pools[index].spilled} />
+                    </td>
+                    <td>
+                      <Printer accessor={state => state.pools[index].failed} />
+                    </td>
+                  </tr>
+                ))}
+              </tbody>
+            </HTMLTable>
+          </Areas.Pools>
+          <Areas.Profile>
+            <HTMLTable striped style={{ minWidth: '100%' }}>
+              <thead>
+                <tr>
+                  <th>Slowest Handlers</th>
+                  <th>Runs</th>
+                  <th>Last</th>
+                  <th>Min</th>
+                  <th>Avg</th>
+                  <th>Max</th>
+                </tr>
+              </thead>
+              <tbody>
+                {profiles.map((profile, index) => (
+                  <tr key={index}>
+                    <td>
+                      <b>
+                        <HandlerText profile={profile} />
+                      </b>
+                    </td>
+                    <td>{profile.count}</td>
+                    <td>
+                      <CyclesText cycles={profile.last} />
+                    </td>
+                    <td>
+                      <CyclesText cycles={profile.min} />
+                    </td>
+                    <td>
+                      <CyclesText cycles={profile.avg} />
+                    </td>
+                    <td>
+                      <CyclesText cycles={profile.max} />
+                    </td>
+                  </tr>
+                ))}
+              </tbody>
+            </HTMLTable>
+            <Button callback="prof_clr">Reset Timings</Button>
+          </Areas.Profile>
+          <Areas.Interrupts>
+            <HTMLTable striped style={{ minWidth: '100%' }}>
+              <thead>
+                <tr>
+                  <th>Interrupt</th>
+                  <th>Runs</th>
+                  <th>Load</th>
+                  <th>Max</th>
+                  <th>Max Latency</th>
+                  {ISR_BUCKETS.map(bucket => (
+                    <th key={bucket}>{bucket} cycles</th>
+                  ))}
+                </tr>
+              </thead>
+              <tbody>
+                {interrupts.map((isr, index) => (
+                  <tr key={index}>
+                    <td>
+                      <b>{ISR_NAMES[index] || index}</b>
+                    </td>
+                    <td>{isr.count}</td>
+                    <td>{isr.load.toFixed(2)}%</td>
+                    <td>
+                      <CyclesText cycles={isr.max_cycles} />
+                    </td>
+                    <td>
+                      {isr.max_latency ? (
+                        <CyclesText cycles={isr.max_latency} />
+                      ) : (
+                        '-'
+                      )}
+                    </td>
+                    {isr.histogram.map((bucket, b) => (
+                      <td key={b}>{bucket}</td>
+                    ))}
+                  </tr>
+                ))}
+              </tbody>
+            </HTMLTable>
+          </Areas.Interrupts>
+          <Areas.Loop>
+            <HTMLTable striped style={{ minWidth: '100%' }}>
+              <thead>
+                <tr>
+                  <th>Superloop Passes</th>
+                  <th>Min</th>
+                  <th>p50</th>
+                  <th>p99</th>
+                  <th>Max</th>
+                  <th>Over Warning</th>
+                  <th>Over Limit</th>
+                </tr>
+              </thead>
+              <tbody>
+                <tr>
+                  <td>
+                    <Printer accessor={state => state.loop.passes} />
+                  </td>
+                  <td>
+                    <Printer accessor={state => state.loop.min_us} />
+                    us
+                  </td>
+                  <td>
+                    <Printer accessor={state => state.loop.p50_us} />
+                    us
+                  </td>
+                  <td>
+                    <Printer accessor={state => state.loop.p99_us} />
+                    us
+                  </td>
+                  <td>
+                    <Printer accessor={state => state.loop.max_us} />
+                    us
+                  </td>
+                  <td>
+                    <Printer accessor={state => state.loop.over_warning} />
+                  </td>
+                  <td>
+                    <Printer accessor={state => state.loop.over_limit} />
+                  </td>
+                </tr>
+                <tr>
+                  <td colSpan={5}>
+                    <Button callback="loop_clr">Reset Loop Timing</Button>
+                  </td>
+                  <td>
+                    <LoopBudgetInput index={0} />
+                  </td>
+                  <td>
+                    <LoopBudgetInput index={1} />
+                  </td>
+                </tr>
+              </tbody>
+            </HTMLTable>
+          </Areas.Loop>
+          <Areas.Jobs>
+            <HTMLTable striped style={{ minWidth: '100%' }}>
+              <thead>
+                <tr>
+                  <th>Background Job</th>
+                  <th>Period</th>
+                  <th>Runs</th>
+                  <th>Max</th>
+                  <th>Budget</th>
+                  <th>Over Budget</th>
+                  <th>Deferred</th>
+                  <th>Late</th>
+                </tr>
+              </thead>
+              <tbody>
+                {jobs.map((job, index) => (
+                  <tr key={index}>
+                    <td>
+                      <b>{job.name}</b>
+                    </td>
+                    <td>
+                      {job.period_ms ? `${job.period_ms}ms` : 'every pass'}
+                    </td>
+                    <td>{job.runs}</td>
+                    <td>{job.max_us}us</td>
+                    <td>{job.budget_us}us</td>
+                    <td>{job.overruns}</td>
+                    <td>{job.deferred}</td>
+                    <td>{job.late}</td>
+                  </tr>
+                ))}
+              </tbody>
+            </HTMLTable>
+            <Button callback="jobs_clr">Reset Job Timing</Button>
+            <HTMLTable striped style={{ minWidth: '100%' }}>
+              <thead>
+                <tr>
+                  <th>UI Link</th>
+                  <th>Carries</th>
+                  <th>Received</th>
+                  <th>Dropped</th>
+                  <th>Backlog</th>
+                  <th>Max Backlog</th>
+                  <th>Passes Over Budget</th>
+                  <th>Rate</th>
+                  <th>CPU per kB</th>
+                  <th>Sent</th>
+                  <th>Dropped</th>
+                  <th>Rate</th>
+                </tr>
+              </thead>
+              <tbody>
+                {links.map((link, index) => (
+                  <tr key={index}>
+                    <td>
+                      <b>{UiLink[index]}</b>
+                    </td>
+                    <td>
+                      {routes
+                        .map((route, name) => (route === index ? name : -1))
+                        .filter(name => name >= 0)
+                        .map(name => UiRoute[name])
+                        .join(', ') || '-'}
+                    </td>
+                    <td>{link.rx_bytes}</td>
+                    <td>{link.rx_dropped}</td>
+                    <td>{link.backlog}</td>
+                    <td>{link.backlog_max}</td>
+                    <td>{link.budget_hits}</td>
+                    <td>{link.rx_bytes_per_s}B/s</td>
+                    <td>
+                      <CyclesText cycles={link.cycles_per_kb} />
+                    </td>
+                    <td>{link.tx_bytes}</td>
+                    <td>{link.tx_dropped}</td>
+                    <td>{link.tx_bytes_per_s}B/s</td>
+                  </tr>
+                ))}
+              </tbody>
+            </HTMLTable>
+          </Areas.Jobs>
         </React.Fragment>
       )}
     </Composition>
@@ -1,4 +1,4 @@
-import { OpenDialogOptions, remote } from 'electron'
+import { OpenDialogOptions, SaveDialogOptions, remote } from 'electron'
 import React, { useCallback, useState } from 'react'
 
 const useOpenDialog = (
@@ -58,4 +58,25 @@ const useOpenDialogCallFunction = (
   }, [])
 }
 
-export { useOpenDialog, useOpenDialogCallFunction }
+const useSaveDialogCallFunction = (
+  extension: string,
+  message: string,
+  func: (filePath: string) => void,
+) => {
+  return useCallback(() => {
+    const options: SaveDialogOptions = {
+      message,
+      filters: [{ name: `.${extension}`, extensions: [extension] }],
+    }
+
+    remote.dialog.showSaveDialog(options, (filepath?: string) => {
+      if (typeof filepath === 'undefined') {
+        return
+      }
+
+      func(filepath)
+    })
+  }, [])
+}
+
+export { useOpenDialog, useOpenDialogCallFunction, useSaveDialogCallFunction }
@@ -2,7 +2,6 @@ import React from 'react'
 
 import {
   useDeviceMetadataKey,
-  IntervalRequester,
   useHardwareState,
 } from '@electricui/components-core'
 
@@ -77,7 +76,6 @@ const EventPalette = () => {
 
   return (
     <>
-      <IntervalRequester interval={100} variables={['rgb']} />
       <h3>Load Event Sequence from File</h3>
       <SceneController key={sceneFilePath} />
       <CurrentRGB />
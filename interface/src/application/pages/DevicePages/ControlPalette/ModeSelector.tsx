@@ -59,6 +59,17 @@ const ModeSelectButtons = () => {
         >
           Run Program
         </Button>
+        <Button
+          minimal
+          large
+          icon="pulse"
+          writer={state => {
+            state.req_mode = 6
+          }}
+          active={control_mode == CONTROL_MODES[CONTROL_MODES.RESONANCE]}
+        >
+          Resonance
+        </Button>
       </ButtonGroup>
     </React.Fragment>
   )
@@ -93,6 +104,13 @@ const ControlSurfaceFromMode = () => {
     )
   } else if (control_mode == CONTROL_MODES[CONTROL_MODES.TRACK]) {
     return <TrackPalette />
+  } else if (control_mode == CONTROL_MODES[CONTROL_MODES.RESONANCE]) {
+    return (
+      <NonIdealState
+        title="Resonance Identification"
+        description="Sweeps each axis once armed, then returns home"
+      />
+    )
   }
 
   return <NonIdealState title="Changing Mode" description="Please wait" />
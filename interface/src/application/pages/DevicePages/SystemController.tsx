@@ -5,10 +5,7 @@ import {
 } from '@electricui/components-desktop-blueprint'
 import { CONTROL_MODES, SUPERVISOR_STATES } from '../../typedState'
 
-import {
-  IntervalRequester,
-  useHardwareState,
-} from '@electricui/components-core'
+import { useHardwareState } from '@electricui/components-core'
 
 import { Composition, Box } from 'atomic-layout'
 import React from 'react'
@@ -76,7 +73,6 @@ const SystemController = () => {
 
   return (
     <div>
-      <IntervalRequester variables={['cpos']} interval={50} />
       <Composition areas={systemOverviewAreas} gap={20} templateCols="4fr 3fr">
         {Areas => (
           <>
@@ -34,6 +34,125 @@ export type TaskStatistics = {
   name: string
 }
 
+export type PoolStatistics = {
+  event_size: number
+  total: number
+  used: number
+  high_water: number
+  spilled: number
+  failed: number
+}
+
+export type StateProfile = {
+  handler: number // state function address
+  count: number
+  last: number // execution times in cpu cycles
+  min: number
+  avg: number
+  max: number
+  instance: number
+  state: number // 255 for hierarchical state machine states
+  name: string
+}
+
+export type IsrStatistics = {
+  count: number
+  max_cycles: number
+  max_latency: number // cycles, 0 when not measurable
+  load: number // percent of cpu time
+  histogram: number[] // durations in doubling buckets from 256 cycles
+}
+
+export type LoopStatistics = {
+  passes: number
+  min_us: number
+  p50_us: number
+  p99_us: number
+  max_us: number
+  over_warning: number
+  over_limit: number
+}
+
+// Serial links to the UI, in the order the firmware reports them
+export enum UiLink {
+  MODULE = 0,
+  INTERNAL,
+  EXTERNAL,
+}
+
+// Indices into the firmware's 'route' array, each holds the UiLink it uses
+export enum UiRoute {
+  CONTROL = 0, // state changes and errors
+  BULK, // queue credit, follows the link moves are streamed on
+  TELEMETRY, // position, resonance and trace data
+}
+
+export type LinkStatistics = {
+  rx_bytes: number
+  rx_dropped: number // discarded because they weren't parsed in time
+  backlog: number // bytes waiting at the start of the latest pass
+  backlog_max: number
+  budget_hits: number // passes which left data for the next pass
+  rx_bytes_per_s: number
+  cycles_per_kb: number // parsing cost, including packet callbacks
+  tx_bytes: number
+  tx_dropped: number // packets which didn't fit in the transmit fifo
+  tx_bytes_per_s: number
+}
+
+export type JobStatistics = {
+  name: string
+  runs: number
+  period_ms: number // 0 for jobs which run every pass
+  budget_us: number
+  max_us: number
+  overruns: number // runs longer than the budget
+  deferred: number // passes without enough slack for a housekeeping job
+  late: number // runs starting a full period after they were due
+}
+
+export enum TraceRecordType {
+  POST = 0,
+  DISPATCH,
+}
+
+export type TraceRecord = {
+  timestamp: number // DWT cycle count, wraps at 2^32
+  duration: number // cycles, 0 for posts
+  type: TraceRecordType
+  signal: number
+  task: number
+  depth: number
+}
+
+export type TraceChunk = {
+  index: number
+  count: number
+  total: number
+  overhead: number // cycles per record
+  cpu_hz: number
+  records: TraceRecord[]
+}
+
+export type PositionFrame = {
+  timestamp_ms: number
+  sequence: number // gaps are frames the firmware dropped
+  identifier: number // movement being followed
+  x: number // shaped setpoint in microns
+  y: number
+  z: number
+  a1: number // joint angles in degrees sent to the servos, lag compensated
+  a2: number
+  a3: number
+}
+
+export type PositionStream = {
+  dropped: number
+  count: number
+  decimation: number // control ticks per frame, 0 when stopped
+  frames: PositionFrame[]
+}
+
 export type FirmwareBuildInfo = {
   branch: string
   info: string
@@ -78,6 +197,12 @@ export type FanStatus = {
 export type QueueDepthInfo = {
   movements: number
   lighting: number
+  movement_credit: number // running count of moves the host may have sent
+  lighting_credit: number // running count of fades the host may have sent
+  motion_received: number // running count of moves which reached the hardware
+  motion_synced: boolean // the compact move stream has a starting point
+  motion_accepted: number // last packet whose moves were all queued
+  motion_seen: number // last packet the hardware looked at
 }
 
 
@@ -117,6 +242,7 @@ export enum CONTROL_MODES {
   TRACK,
   DEMO,
   CHANGING,
+  RESONANCE,
 }
 
 export type SupervisorState = {
@@ -146,6 +272,8 @@ export type CartesianPoint = {
   z: number
 }
 
+export type RotaryMovement = [number, number] // start/end angle in degrees
+
 export type MovementMove = {
   id: number
   duration: number
@@ -153,6 +281,7 @@ export type MovementMove = {
   reference: MovementMoveReference
   points: Array<MovementPoint>
   num_points?: number
+  rotary?: RotaryMovement // only used by EXPANSION_SERVO firmware
 }
 
 export enum LightMoveType {
@@ -174,6 +303,12 @@ export type LightMove = {
   num_points?: number
 }
 
+// Moves and fades which the hardware queues together
+export type MovementBatch = {
+  moves: Array<MovementMove>
+  fades: Array<LightMove>
+}
+
 export type LedStatus = {
   red: number
   green: number
@@ -181,6 +316,37 @@ export type LedStatus = {
   enable: boolean
 }
 
+export enum InputShaperType {
+  NONE = 0,
+  ZV,
+  ZVD,
+  EI,
+}
+
+export type InputShaperSettings = {
+  type: InputShaperType
+  frequency: number // Hz
+  damping: number // ratio
+}
+
+export enum RESONANCE_AXIS {
+  X = 0,
+  Y,
+  Z,
+}
+
+export type ResonanceResult = {
+  peak_hz: number
+  damping: number // ratio, 0 when the peak is at the edge of the sweep
+  peak_response: number // torque % per mm of drive amplitude
+  progress: number // percent
+}
+
+export type ResonancePoint = {
+  frequency: number // Hz
+  response: number // torque % per mm of drive amplitude
+}
+
 export type ManualHSVControl = {
   hue: number
   saturation: number
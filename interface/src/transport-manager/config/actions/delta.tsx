@@ -8,7 +8,11 @@ import {
 
 import fs from 'fs'
 import { getDelta } from './utils'
-import { movementQueueSequencer } from './../sequence-senders'
+import {
+  movementQueueSequencer,
+  lightQueueSequencer,
+} from './../sequence-senders'
+import { compactMotionCodec } from './../codecs'
 import os from 'os'
 import path from 'path'
 
@@ -210,6 +214,7 @@ const clearUIMovementQueue = new Action(
     paused: boolean,
   ) => {
     movementQueueSequencer.clear()
+    compactMotionCodec.reset()
   },
 )
 const clearQueues = new Action(
@@ -225,10 +230,16 @@ const clearQueues = new Action(
       return
     }
 
+    // The hardware starts its credit counts again when it clears
+    movementQueueSequencer.resetCredit()
+    lightQueueSequencer.resetCredit()
+
     const clearQueueMessage = new Message('clmv', null)
     clearQueueMessage.metadata.type = 0 // TYPES.CALLBACK
 
     await delta.write(clearQueueMessage)
+
+    compactMotionCodec.reset()
   },
 )
 
@@ -24,6 +24,8 @@ import {
   stopSceneExecution,
 } from './sceneControl'
 
+import { dumpTrace } from './trace'
+import { recordPositions, savePositions } from './positions'
 import { loadCollection } from './loadCollection'
 
 export type WaitOptions = number
@@ -44,7 +46,10 @@ const actions = [
   clearQueues,
   clearUILightQueue,
   clearUIMovementQueue,
+  dumpTrace,
   loadCollection,
+  recordPositions,
+  savePositions,
   wait,
   setFrame,
   queueLight,
@@ -0,0 +1,130 @@
+import { Action, RunActionFunction } from '@electricui/core-actions'
+import {
+  Device,
+  DeviceManager,
+  MANAGER_EVENTS,
+  Message,
+} from '@electricui/core'
+import { PositionFrame, PositionStream } from '../../../application/typedState'
+
+import fs from 'fs'
+import { getDelta } from './utils'
+
+type PositionRecording = {
+  frames: PositionFrame[]
+  lastSequence: number | null
+  dropped: number
+  onMessage: (device: Device, message: Message) => void
+}
+
+let recording: PositionRecording | null = null
+
+async function writeDecimation(delta: Device, decimation: number) {
+  const request = new Message('pdec', decimation)
+  request.metadata.ack = true
+  await delta.write(request)
+}
+
+/**
+ * Collect the commanded trajectory, one frame per `decimation` control ticks
+ */
+const recordPositions = new Action(
+  'record_positions',
+  async (
+    deviceManager: DeviceManager,
+    runAction: RunActionFunction,
+    decimation: number,
+  ) => {
+    const delta = getDelta(deviceManager)
+
+    if (recording) {
+      deviceManager.removeListener(MANAGER_EVENTS.DATA, recording.onMessage)
+    }
+
+    const current: PositionRecording = {
+      frames: [],
+      lastSequence: null,
+      dropped: 0,
+      onMessage: (device: Device, message: Message) => {
+        if (
+          message.deviceID !== delta.deviceID ||
+          message.messageID !== 'pstream'
+        ) {
+          return
+        }
+
+        const stream: PositionStream = message.payload
+        current.dropped = stream.dropped
+
+        for (const frame of stream.frames) {
+          // A query repeats the last packet, sequence numbers wrap at 16 bits
+          const step =
+            current.lastSequence === null
+              ? 1
+              : (frame.sequence - current.lastSequence) & 0xffff
+
+          if (step === 0 || step >= 0x8000) {
+            continue
+          }
+
+          current.frames.push(frame)
+          current.lastSequence = frame.sequence
+        }
+      },
+    }
+
+    recording = current
+    deviceManager.on(MANAGER_EVENTS.DATA, current.onMessage)
+
+    await writeDecimation(delta, decimation)
+  },
+)
+
+/**
+ * Stop the stream and write what was collected out as CSV
+ */
+const savePositions = new Action(
+  'save_positions',
+  async (
+    deviceManager: DeviceManager,
+    runAction: RunActionFunction,
+    filePath: string,
+  ) => {
+    const delta = getDelta(deviceManager)
+
+    await writeDecimation(delta, 0)
+
+    if (!recording) {
+      throw new Error('No position recording to save')
+    }
+
+    const { frames, dropped, onMessage } = recording
+    deviceManager.removeListener(MANAGER_EVENTS.DATA, onMessage)
+    recording = null
+
+    const rows = frames.map(f =>
+      [
+        f.timestamp_ms,
+        f.sequence,
+        f.identifier,
+        f.x,
+        f.y,
+        f.z,
+        f.a1,
+        f.a2,
+        f.a3,
+      ].join(','),
+    )
+
+    fs.writeFileSync(
+      filePath,
+      ['timestamp_ms,sequence,move,x,y,z,a1,a2,a3', ...rows].join('\n'),
+    )
+
+    console.log(
+      `Wrote ${frames.length} position frames to ${filePath}, ${dropped} dropped by the firmware`,
+    )
+  },
+)
+
+export { recordPositions, savePositions }
@@ -0,0 +1,204 @@
+import { Action, RunActionFunction } from '@electricui/core-actions'
+import {
+  Device,
+  DeviceManager,
+  MANAGER_EVENTS,
+  Message,
+} from '@electricui/core'
+import {
+  TaskStatistics,
+  TraceChunk,
+  TraceRecord,
+  TraceRecordType,
+} from '../../../application/typedState'
+
+import fs from 'fs'
+import { getDelta } from './utils'
+
+// Matches UI_TRACE_CHUNK_RECORDS in the firmware
+const TRACE_CHUNK_RECORDS = 8
+
+const TRACE_CHUNK_TIMEOUT_MS = 1000
+
+/**
+ * Resolves with the payload of the next message from the delta with the given ID
+ */
+function waitForMessage<T>(
+  deviceManager: DeviceManager,
+  delta: Device,
+  messageID: string,
+): Promise<T> {
+  return new Promise((resolve, reject) => {
+    const onMessage = (device: Device, message: Message) => {
+      if (
+        message.deviceID === delta.deviceID &&
+        message.messageID === messageID
+      ) {
+        cleanup()
+        resolve(message.payload)
+      }
+    }
+
+    const timeout = setTimeout(() => {
+      cleanup()
+      reject(new Error(`Timed out waiting for ${messageID}`))
+    }, TRACE_CHUNK_TIMEOUT_MS)
+
+    const cleanup = () => {
+      clearTimeout(timeout)
+      deviceManager.removeListener(MANAGER_EVENTS.DATA, onMessage)
+    }
+
+    deviceManager.on(MANAGER_EVENTS.DATA, onMessage)
+  })
+}
+
+/**
+ * Walk the firmware's trace ring a chunk at a time, oldest record first
+ */
+async function readTrace(deviceManager: DeviceManager, delta: Device) {
+  const records: TraceRecord[] = []
+  let header: TraceChunk | null = null
+  let index = 0
+
+  while (true) {
+    const reply = waitForMessage<TraceChunk>(deviceManager, delta, 'trace')
+
+    const request = new Message('trace_rd', index)
+    request.metadata.ack = true
+    await delta.write(request)
+
+    const chunk = await reply
+    header = chunk
+    records.push(...chunk.records)
+    index += chunk.count
+
+    if (chunk.count < TRACE_CHUNK_RECORDS || index >= chunk.total) {
+      break
+    }
+  }
+
+  // The firmware resumes recording after a short chunk, so read past a trace ending on a chunk boundary
+  if (header && header.count === TRACE_CHUNK_RECORDS) {
+    const reply = waitForMessage<TraceChunk>(deviceManager, delta, 'trace')
+    const request = new Message('trace_rd', index)
+    request.metadata.ack = true
+    await delta.write(request)
+    await reply
+  }
+
+  return { header: header!, records }
+}
+
+/**
+ * Convert trace records into the Chrome trace event format, viewable in chrome://tracing or Perfetto.
+ * Each task is shown as a thread, dispatches as slices and posts as instant events.
+ */
+export function traceToChromeJSON(
+  records: TraceRecord[],
+  cpu_hz: number,
+  overhead: number,
+  taskNames: string[],
+) {
+  const usPerCycle = 1e6 / cpu_hz
+  const events: any[] = []
+
+  // The cycle counter wraps every few seconds, so accumulate signed differences between records.
+  // Dispatch records are stamped at their start, so can be slightly older than the posts before them.
+  let previous = records.length ? records[0].timestamp : 0
+  let elapsed = 0
+
+  for (const record of records) {
+    elapsed += (record.timestamp - previous) | 0
+    previous = record.timestamp
+
+    const common = {
+      name: `signal ${record.signal}`,
+      pid: 0,
+      tid: record.task,
+      ts: elapsed * usPerCycle,
+      args: { signal: record.signal, depth: record.depth },
+    }
+
+    if (record.type === TraceRecordType.DISPATCH) {
+      events.push({
+        ...common,
+        cat: 'dispatch',
+        ph: 'X',
+        dur: record.duration * usPerCycle,
+      })
+    } else {
+      events.push({ ...common, cat: 'post', ph: 'i', s: 't' })
+    }
+
+    events.push({
+      name: `queue ${taskNames[record.task] || record.task}`,
+      pid: 0,
+      ph: 'C',
+      ts: common.ts,
+      args: { depth: record.depth },
+    })
+  }
+
+  taskNames.forEach((name, tid) => {
+    events.push({
+      name: 'thread_name',
+      ph: 'M',
+      pid: 0,
+      tid,
+      args: { name },
+    })
+  })
+
+  return {
+    traceEvents: events,
+    displayTimeUnit: 'ns',
+    otherData: {
+      cpu_hz,
+      record_overhead_cycles: overhead,
+    },
+  }
+}
+
+const dumpTrace = new Action(
+  'dump_trace',
+  async (
+    deviceManager: DeviceManager,
+    runAction: RunActionFunction,
+    filePath: string,
+  ) => {
+    const delta = getDelta(deviceManager)
+
+    // Task names label the timeline rows, tasks are indexed by their id
+    const tasksReply = waitForMessage<TaskStatistics[]>(
+      deviceManager,
+      delta,
+      'tasks',
+    )
+    const tasksRequest = new Message('tasks', null)
+    tasksRequest.metadata.query = true
+    await delta.write(tasksRequest)
+
+    const taskNames: string[] = []
+    for (const task of await tasksReply) {
+      taskNames[task.id] = task.name
+    }
+
+    const { header, records } = await readTrace(deviceManager, delta)
+
+    const trace = traceToChromeJSON(
+      records,
+      header.cpu_hz,
+      header.overhead,
+      taskNames,
+    )
+
+    fs.writeFileSync(filePath, JSON.stringify(trace))
+
+    console.log(
+      `Wrote ${records.length} trace records to ${filePath}, ${header.overhead} cycles per record`,
+    )
+  },
+)
+
+export { dumpTrace }
@@ -3,6 +3,16 @@ import { Codec, Message } from '@electricui/core'
 import {
   SystemStatus,
   TaskStatistics,
+  PoolStatistics,
+  IsrStatistics,
+  LoopStatistics,
+  JobStatistics,
+  LinkStatistics,
+  StateProfile,
+  TraceChunk,
+  TraceRecord,
+  PositionFrame,
+  PositionStream,
   KinematicsInfo,
   FirmwareBuildInfo,
   TemperatureSensors,
@@ -18,13 +28,18 @@ import {
   MovementPoint,
   CartesianPoint,
   MovementMove,
+  RotaryMovement,
   LightMoveType,
   LightMove,
   LightPoint,
+  MovementBatch,
   ManualHSVControl,
   LedStatus,
   LedSettings,
   PowerCalibration,
+  InputShaperSettings,
+  ResonanceResult,
+  ResonancePoint,
 } from '../../application/typedState'
 import { SmartBuffer } from 'smart-buffer'
 
@@ -65,11 +80,17 @@ export class TaskStatisticsCodec extends Codec {
     const taskStats: TaskStatistics[] = []
 
     while (reader.remaining() > 0) {
+      const id = reader.readUInt8()
+      const ready = reader.readUInt8() === 0x01 ? true : false
+      const queue_used = reader.readUInt16LE()
+      const queue_max = reader.readUInt16LE()
+      reader.readUInt16LE() // padding
+
       const task: TaskStatistics = {
-        id: reader.readUInt8(),
-        ready: reader.readUInt8() === 0x01 ? true : false,
-        queue_used: reader.readUInt8(),
-        queue_max: reader.readUInt8(),
+        id,
+        ready,
+        queue_used,
+        queue_max,
         waiting_max: reader.readUInt32LE(),
         burst_max: reader.readUInt32LE(),
         name: reader.readString(12, 'utf8'),
@@ -81,6 +102,284 @@ export class TaskStatisticsCodec extends Codec {
   }
 }
 
+export class PoolStatisticsCodec extends Codec {
+  filter(message: Message): boolean {
+    return message.messageID === 'pools'
+  }
+
+  encode(payload: PoolStatistics): Buffer {
+    throw new Error('Pool statistics are read-only')
+  }
+
+  decode(payload: Buffer): PoolStatistics[] {
+    const reader = SmartBuffer.fromBuffer(payload)
+
+    const poolStats: PoolStatistics[] = []
+
+    while (reader.remaining() > 0) {
+      const pool: PoolStatistics = {
+        event_size: reader.readUInt16LE(),
+        total: reader.readUInt16LE(),
+        used: reader.readUInt16LE(),
+        high_water: reader.readUInt16LE(),
+        spilled: reader.readUInt16LE(),
+        failed: reader.readUInt16LE(),
+      }
+      poolStats.push(pool)
+    }
+
+    return poolStats
+  }
+}
+
+// Matches HAL_ISR_HISTOGRAM_BUCKETS in the firmware
+const ISR_HISTOGRAM_BUCKETS = 6
+
+export class IsrStatisticsCodec extends Codec {
+  filter(message: Message): boolean {
+    return message.messageID === 'isr'
+  }
+
+  encode(payload: IsrStatistics): Buffer {
+    throw new Error('Interrupt statistics are read-only')
+  }
+
+  decode(payload: Buffer): IsrStatistics[] {
+    const reader = SmartBuffer.fromBuffer(payload)
+
+    const isrStats: IsrStatistics[] = []
+
+    while (reader.remaining() > 0) {
+      const count = reader.readUInt32LE()
+      const max_cycles = reader.readUInt32LE()
+      const max_latency = reader.readUInt16LE()
+      const load = reader.readUInt16LE() / 100
+
+      const histogram: number[] = []
+      for (let i = 0; i < ISR_HISTOGRAM_BUCKETS; i++) {
+        histogram.push(reader.readUInt16LE())
+      }
+
+      isrStats.push({ count, max_cycles, max_latency, load, histogram })
+    }
+
+    return isrStats
+  }
+}
+
+export class LoopStatisticsCodec extends Codec {
+  filter(message: Message): boolean {
+    return message.messageID === 'loop'
+  }
+
+  encode(payload: LoopStatistics): Buffer {
+    throw new Error('Loop statistics are read-only')
+  }
+
+  decode(payload: Buffer): LoopStatistics {
+    const reader = SmartBuffer.fromBuffer(payload)
+
+    return {
+      passes: reader.readUInt32LE(),
+      min_us: reader.readUInt16LE(),
+      p50_us: reader.readUInt16LE(),
+      p99_us: reader.readUInt16LE(),
+      max_us: reader.readUInt16LE(),
+      over_warning: reader.readUInt32LE(),
+      over_limit: reader.readUInt32LE(),
+    }
+  }
+}
+
+export class LinkStatisticsCodec extends Codec {
+  filter(message: Message): boolean {
+    return message.messageID === 'links'
+  }
+
+  encode(payload: LinkStatistics[]): Buffer {
+    throw new Error('Link statistics are read-only')
+  }
+
+  decode(payload: Buffer): LinkStatistics[] {
+    const reader = SmartBuffer.fromBuffer(payload)
+    const links: LinkStatistics[] = []
+
+    while (reader.remaining() > 0) {
+      links.push({
+        rx_bytes: reader.readUInt32LE(),
+        rx_dropped: reader.readUInt32LE(),
+        backlog: reader.readUInt16LE(),
+        backlog_max: reader.readUInt16LE(),
+        budget_hits: reader.readUInt32LE(),
+        rx_bytes_per_s: reader.readUInt32LE(),
+        cycles_per_kb: reader.readUInt32LE(),
+        tx_bytes: reader.readUInt32LE(),
+        tx_dropped: reader.readUInt32LE(),
+        tx_bytes_per_s: reader.readUInt32LE(),
+      })
+    }
+
+    return links
+  }
+}
+
+export class PositionStreamCodec extends Codec {
+  filter(message: Message): boolean {
+    return message.messageID === 'pstream'
+  }
+
+  encode(payload: PositionStream): Buffer {
+    throw new Error('The position stream is read-only')
+  }
+
+  decode(payload: Buffer): PositionStream {
+    const reader = SmartBuffer.fromBuffer(payload)
+
+    const dropped = reader.readUInt16LE()
+    const count = reader.readUInt8()
+    const decimation = reader.readUInt8()
+
+    // The packet is fixed size, only the first count frames are valid
+    const frames: PositionFrame[] = []
+
+    for (let i = 0; i < count; i++) {
+      frames.push({
+        timestamp_ms: reader.readUInt32LE(),
+        sequence: reader.readUInt16LE(),
+        identifier: reader.readUInt16LE(),
+        x: reader.readInt32LE(),
+        y: reader.readInt32LE(),
+        z: reader.readInt32LE(),
+        a1: reader.readFloatLE(),
+        a2: reader.readFloatLE(),
+        a3: reader.readFloatLE(),
+      })
+    }
+
+    return { dropped, count, decimation, frames }
+  }
+}
+
+// Matches JOB_NAME_LENGTH in the firmware
+const JOB_NAME_LENGTH = 8
+
+export class JobStatisticsCodec extends Codec {
+  filter(message: Message): boolean {
+    return message.messageID === 'jobs'
+  }
+
+  encode(payload: JobStatistics): Buffer {
+    throw new Error('Job statistics are read-only')
+  }
+
+  decode(payload: Buffer): JobStatistics[] {
+    const reader = SmartBuffer.fromBuffer(payload)
+
+    const jobStats: JobStatistics[] = []
+
+    while (reader.remaining() > 0) {
+      const job: JobStatistics = {
+        name: reader.readString(JOB_NAME_LENGTH, 'utf8').replace(/\0/g, ''),
+        runs: reader.readUInt32LE(),
+        period_ms: reader.readUInt16LE(),
+        budget_us: reader.readUInt16LE(),
+        max_us: reader.readUInt16LE(),
+        overruns: reader.readUInt16LE(),
+        deferred: reader.readUInt16LE(),
+        late: reader.readUInt16LE(),
+      }
+
+      // Unused slots in the job table are sent as zeros
+      if (job.name) {
+        jobStats.push(job)
+      }
+    }
+
+    return jobStats
+  }
+}
+
+export class StateProfileCodec extends Codec {
+  filter(message: Message): boolean {
+    return message.messageID === 'profile'
+  }
+
+  encode(payload: StateProfile): Buffer {
+    throw new Error('State profiles are read-only')
+  }
+
+  decode(payload: Buffer): StateProfile[] {
+    const reader = SmartBuffer.fromBuffer(payload)
+
+    const profiles: StateProfile[] = []
+
+    while (reader.remaining() > 0) {
+      const profile: StateProfile = {
+        handler: reader.readUInt32LE(),
+        count: reader.readUInt32LE(),
+        last: reader.readUInt32LE(),
+        min: reader.readUInt32LE(),
+        avg: reader.readUInt32LE(),
+        max: reader.readUInt32LE(),
+        instance: reader.readUInt8(),
+        state: reader.readUInt8(),
+        name: reader.readString(12, 'utf8').replace(/\0/g, ''),
+      }
+      reader.readUInt16LE() // padding
+
+      // Unused rows are zeroed
+      if (profile.count > 0) {
+        profiles.push(profile)
+      }
+    }
+
+    return profiles
+  }
+}
+
+export class TraceChunkCodec extends Codec {
+  filter(message: Message): boolean {
+    return message.messageID === 'trace'
+  }
+
+  encode(payload: TraceChunk): Buffer {
+    throw new Error('The event trace is read-only')
+  }
+
+  decode(payload: Buffer): TraceChunk {
+    const reader = SmartBuffer.fromBuffer(payload)
+
+    const index = reader.readUInt16LE()
+    const count = reader.readUInt16LE()
+    const total = reader.readUInt16LE()
+    const overhead = reader.readUInt16LE()
+    const cpu_hz = reader.readUInt32LE()
+
+    // The chunk is fixed size, only the first count records are valid
+    const records: TraceRecord[] = []
+
+    for (let i = 0; i < count; i++) {
+      records.push({
+        timestamp: reader.readUInt32LE(),
+        duration: reader.readUInt32LE(),
+        type: reader.readUInt8(),
+        signal: reader.readUInt8(),
+        task: reader.readUInt8(),
+        depth: reader.readUInt8(),
+      })
+    }
+
+    return {
+      index,
+      count,
+      total,
+      overhead,
+      cpu_hz,
+      records,
+    }
+  }
+}
+
 export function splitBufferByLength(toSplit: Buffer, splitLength: number) {
   const chunks = []
   const n = toSplit.length
@@ -210,8 +509,14 @@ export class QueueDepthCodec extends Codec {
     const reader = SmartBuffer.fromBuffer(payload)
 
     return {
-      movements: reader.readUInt8(),
-      lighting: reader.readUInt8(),
+      movements: reader.readUInt16LE(),
+      lighting: reader.readUInt16LE(),
+      movement_credit: reader.readUInt16LE(),
+      lighting_credit: reader.readUInt16LE(),
+      motion_received: reader.readUInt16LE(),
+      motion_synced: reader.readUInt8() === 1,
+      motion_accepted: reader.readUInt8(),
+      motion_seen: reader.readUInt8(),
     }
   }
 }
@@ -344,6 +649,15 @@ export class InboundMotionCodec extends Codec {
       }
     }
 
+    // Expansion axis channel is only sent when the move drives the rotary stage
+    if (typeof payload.rotary !== 'undefined') {
+      packet.writeFloatLE(payload.rotary[0])
+      packet.writeFloatLE(payload.rotary[1])
+      packet.writeUInt8(1)
+      packet.writeUInt8(0) // padding
+      packet.writeUInt16LE(0)
+    }
+
     return packet.toBuffer()
   }
 
@@ -370,10 +684,341 @@ export class InboundMotionCodec extends Codec {
       points_decoded.push(pointData)
     }
 
+    if (reader.remaining() >= 9) {
+      const rotary: RotaryMovement = [reader.readFloatLE(), reader.readFloatLE()]
+
+      if (reader.readUInt8()) {
+        movement.rotary = rotary
+      }
+    }
+
     return movement
   }
 }
 
+// Matches movement_codec.h in the firmware
+const COMPACT_MOVE_VERSION = 1
+const COMPACT_FLAG_RESET = 0x80
+const COMPACT_RELATIVE = 0x08
+const COMPACT_PTS_SHIFT = 4
+const COMPACT_CHAINED = 0x40
+const COMPACT_NEXT_ID = 0x80
+
+function writeVarint(packet: SmartBuffer, value: number) {
+  let remaining = value >>> 0
+
+  while (remaining >= 0x80) {
+    packet.writeUInt8((remaining & 0x7f) | 0x80)
+    remaining >>>= 7
+  }
+
+  packet.writeUInt8(remaining)
+}
+
+// Zig-zag keeps small steps in either direction to a single byte
+function writeSignedVarint(packet: SmartBuffer, value: number) {
+  writeVarint(packet, ((value << 1) ^ (value >> 31)) >>> 0)
+}
+
+/**
+ * Moves are sent as the change from the previous point, so the encoder keeps
+ * the same running state as the firmware decoder. Every message has to reach
+ * the hardware in order, retries reuse the bytes from the first attempt.
+ */
+export class CompactMotionCodec extends Codec {
+  private lastPoint: MovementPoint = [0, 0, 0] // microns
+  private lastId = 0
+  private sequence = 0
+  private needsReset = true
+  private unseenReset: number | null = null // reset not reported on yet
+  private encoded = new WeakMap<object, Buffer>()
+
+  // Restart the next packet from the origin, if the hardware lost track
+  reset() {
+    this.needsReset = true
+  }
+
+  // Sequence number of the last packet encoded
+  lastSequence() {
+    return this.sequence
+  }
+
+  /**
+   * Whether a queue report shows the hardware lost its place in the stream.
+   * Reports sent before it reached the last reset packet are out of date, so
+   * they can't ask for another restart.
+   */
+  lostSync(synced: boolean, seen: number) {
+    if (this.unseenReset !== null) {
+      const behind = (this.unseenReset - seen) & 0xff
+
+      if (behind > 0 && behind < 0x80) {
+        return false
+      }
+
+      this.unseenReset = null
+    }
+
+    return !synced && !this.needsReset
+  }
+
+  filter(message: Message): boolean {
+    return message.messageID === 'mvc'
+  }
+
+  encode(payload: MovementMove): Buffer {
+    return this.encodePacket(payload, packet =>
+      this.writeMove(packet, payload),
+    )
+  }
+
+  decode(payload: Buffer): Buffer {
+    // Only sent to the hardware, it needs the running state to expand
+    return payload
+  }
+
+  /**
+   * Writes the packet header, then the body. Batches share the sequence
+   * numbers and running state with single moves.
+   */
+  encodePacket(payload: object, writeBody: (packet: SmartBuffer) => void) {
+    const cached = this.encoded.get(payload)
+    if (cached) {
+      return cached
+    }
+
+    // Zero is skipped, the hardware reports it when it has seen no packets
+    this.sequence = (this.sequence % 255) + 1
+
+    const reset = this.needsReset
+    if (reset) {
+      this.lastPoint = [0, 0, 0]
+      this.lastId = 0
+      this.needsReset = false
+      this.unseenReset = this.sequence
+    }
+
+    const packet = new SmartBuffer()
+    packet.writeUInt8(COMPACT_MOVE_VERSION | (reset ? COMPACT_FLAG_RESET : 0))
+    packet.writeUInt8(this.sequence)
+
+    writeBody(packet)
+
+    const buffer = packet.toBuffer()
+    this.encoded.set(payload, buffer)
+
+    return buffer
+  }
+
+  writeMove(packet: SmartBuffer, payload: MovementMove) {
+    const points: MovementPoint[] = payload.points.map(
+      point => point.map(axis => Math.round(axis * 1000)) as MovementPoint,
+    )
+
+    const chained = points[0].every(
+      (axis, index) => axis === this.lastPoint[index],
+    )
+    const nextId = payload.id === ((this.lastId + 1) & 0xffff)
+
+    let header = payload.type & 0x07
+    header |=
+      payload.reference === MovementMoveReference.RELATIVE
+        ? COMPACT_RELATIVE
+        : 0
+    header |= ((points.length - 1) & 0x03) << COMPACT_PTS_SHIFT
+    header |= chained ? COMPACT_CHAINED : 0
+    header |= nextId ? COMPACT_NEXT_ID : 0
+
+    packet.writeUInt8(header)
+
+    if (!nextId) {
+      writeVarint(packet, payload.id)
+    }
+    writeVarint(packet, payload.duration)
+
+    for (const point of chained ? points.slice(1) : points) {
+      for (let axis = 0; axis < 3; axis++) {
+        writeSignedVarint(packet, point[axis] - this.lastPoint[axis])
+      }
+      this.lastPoint = point
+    }
+
+    this.lastId = payload.id
+  }
+
+  /**
+   * Counts how many of the leading moves fit in `budget` bytes of the next
+   * packet, without moving the running state on.
+   */
+  countMovesThatFit(moves: MovementMove[], budget: number) {
+    const lastPoint = this.lastPoint
+    const lastId = this.lastId
+
+    if (this.needsReset) {
+      this.lastPoint = [0, 0, 0]
+      this.lastId = 0
+    }
+
+    const scratch = new SmartBuffer()
+    let count = 0
+
+    for (const move of moves) {
+      this.writeMove(scratch, move)
+
+      if (scratch.length > budget) {
+        break
+      }
+      count++
+    }
+
+    this.lastPoint = lastPoint
+    this.lastId = lastId
+
+    return count
+  }
+}
+
+export const compactMotionCodec = new CompactMotionCodec()
+
+// Matches MOVEMENT_BATCH_* in movement_codec.h
+const BATCH_MAX_BYTES = 120
+const BATCH_MAX_MOVES = 32
+const BATCH_MAX_FADES = 8
+
+// Packet header, plus the move and fade counts
+const BATCH_OVERHEAD_BYTES = 4
+
+function writeFade(packet: SmartBuffer, fade: LightMove) {
+  packet.writeUInt16LE(fade.id)
+  packet.writeUInt16LE(fade.duration)
+  packet.writeUInt8(fade.type)
+  packet.writeUInt8(fade.points.length)
+
+  for (const point of fade.points) {
+    packet.writeFloatLE(point[0])
+    packet.writeFloatLE(point[1])
+    packet.writeFloatLE(point[2])
+  }
+}
+
+/**
+ * Several moves and fades in one packet, the hardware queues all of them or
+ * none. Moves are written with the compact encoder and share its state.
+ */
+export class MovementBatchCodec extends Codec {
+  constructor(private motion: CompactMotionCodec) {
+    super()
+  }
+
+  filter(message: Message): boolean {
+    return message.messageID === 'mvb'
+  }
+
+  encode(payload: MovementBatch): Buffer {
+    return this.motion.encodePacket(payload, packet => {
+      packet.writeUInt8(payload.moves.length)
+
+      for (const move of payload.moves) {
+        this.motion.writeMove(packet, move)
+      }
+
+      packet.writeUInt8(payload.fades.length)
+
+      for (const fade of payload.fades) {
+        writeFade(packet, fade)
+      }
+    })
+  }
+
+  decode(payload: Buffer): Buffer {
+    return payload
+  }
+
+  /**
+   * How many of the leading moves go in the next batch. Moves for the
+   * expansion axis aren't in the compact format, so they go one at a time.
+   */
+  countMoves(moves: Array<MovementMove>) {
+    if (moves.length > 0 && moves[0].rotary) {
+      return 1
+    }
+
+    const end = moves.findIndex(move => move.rotary)
+    const candidates = moves.slice(
+      0,
+      Math.min(end === -1 ? moves.length : end, BATCH_MAX_MOVES),
+    )
+
+    return this.motion.countMovesThatFit(
+      candidates,
+      BATCH_MAX_BYTES - BATCH_OVERHEAD_BYTES,
+    )
+  }
+
+  /**
+   * Takes the leading moves that fit in the next batch and encodes it
+   * straight away. The size depends on the running state, so it has to move
+   * on in the order batches are formed, not when the writes go out. Encoding
+   * the batch again returns the same bytes.
+   */
+  formBatch(moves: Array<MovementMove>): MovementBatch {
+    const count = Math.max(1, this.countMoves(moves))
+    const batch: MovementBatch = { moves: moves.slice(0, count), fades: [] }
+
+    this.encode(batch)
+
+    return batch
+  }
+}
+
+export const movementBatchCodec = new MovementBatchCodec(compactMotionCodec)
+
+/**
+ * Several fades in one packet, without the move stream header. Fades don't
+ * depend on earlier packets, so the light queue can stream them on its own.
+ */
+export class FadeBatchCodec extends Codec {
+  filter(message: Message): boolean {
+    return message.messageID === 'ltb'
+  }
+
+  encode(payload: Array<LightMove>): Buffer {
+    const packet = new SmartBuffer()
+
+    packet.writeUInt8(payload.length)
+
+    for (const fade of payload) {
+      writeFade(packet, fade)
+    }
+
+    return packet.toBuffer()
+  }
+
+  decode(payload: Buffer): Buffer {
+    return payload
+  }
+
+  // How many of the leading fades go in the next batch
+  countFades(fades: Array<LightMove>) {
+    let bytes = 1
+    let count = 0
+
+    for (const fade of fades.slice(0, BATCH_MAX_FADES)) {
+      // identifier, duration, type and count, then three floats per colour
+      bytes += 6 + fade.points.length * 12
+
+      if (bytes > BATCH_MAX_BYTES) {
+        break
+      }
+      count++
+    }
+
+    return count
+  }
+}
+
+export const fadeBatchCodec = new FadeBatchCodec()
+
 export class InboundFadeCodec extends Codec {
   filter(message: Message): boolean {
     return message.messageID === 'inlt'
@@ -554,10 +1199,119 @@ export class PowerCalibrationCodec extends Codec {
   }
 }
 
+export class InputShaperCodec extends Codec {
+  filter(message: Message): boolean {
+    return message.messageID === 'shaper'
+  }
+
+  encode(payload: InputShaperSettings) {
+    const packet = new SmartBuffer()
+
+    packet.writeUInt8(payload.type)
+    packet.writeUInt8(0) // padding
+    packet.writeUInt16LE(0)
+    packet.writeFloatLE(payload.frequency)
+    packet.writeFloatLE(payload.damping)
+
+    return packet.toBuffer()
+  }
+
+  decode(payload: Buffer): InputShaperSettings {
+    const reader = SmartBuffer.fromBuffer(payload)
+
+    const type = reader.readUInt8()
+    reader.readUInt8() // padding
+    reader.readUInt16LE()
+
+    return {
+      type: type,
+      frequency: reader.readFloatLE(),
+      damping: reader.readFloatLE(),
+    }
+  }
+}
+
+export class ResonanceResultCodec extends Codec {
+  filter(message: Message): boolean {
+    return message.messageID === 'resonance'
+  }
+
+  encode(payload: ResonanceResult): Buffer {
+    throw new Error('Resonance results are read-only')
+  }
+
+  decode(payload: Buffer): ResonanceResult[] {
+    const reader = SmartBuffer.fromBuffer(payload)
+
+    const results: ResonanceResult[] = []
+
+    while (reader.remaining() > 0) {
+      const result: ResonanceResult = {
+        peak_hz: reader.readFloatLE(),
+        damping: reader.readFloatLE(),
+        peak_response: reader.readFloatLE(),
+        progress: reader.readUInt8(),
+      }
+      reader.readUInt8() // padding
+      reader.readUInt16LE()
+
+      results.push(result)
+    }
+
+    return results
+  }
+}
+
+// Matches the sweep range in the firmware's ResonanceDefines
+const RESONANCE_START_HZ = 2
+const RESONANCE_STEP_HZ = 1
+const RESONANCE_AXES = 3
+
+export class ResonanceResponseCodec extends Codec {
+  filter(message: Message): boolean {
+    return message.messageID === 'res_resp'
+  }
+
+  encode(payload: ResonancePoint[][]): Buffer {
+    throw new Error('Resonance response is read-only')
+  }
+
+  decode(payload: Buffer): ResonancePoint[][] {
+    const reader = SmartBuffer.fromBuffer(payload)
+
+    // One row of float magnitudes per axis
+    const steps = payload.length / 4 / RESONANCE_AXES
+    const axes: ResonancePoint[][] = []
+
+    for (let axis = 0; axis < RESONANCE_AXES; axis++) {
+      const points: ResonancePoint[] = []
+
+      for (let i = 0; i < steps; i++) {
+        points.push({
+          frequency: RESONANCE_START_HZ + i * RESONANCE_STEP_HZ,
+          response: reader.readFloatLE(),
+        })
+      }
+
+      axes.push(points)
+    }
+
+    return axes
+  }
+}
+
 // Create the instances of the codecs
 export const customCodecs = [
   new SystemDataCodec(),
   new TaskStatisticsCodec(),
+  new PoolStatisticsCodec(),
+  new StateProfileCodec(),
+  new IsrStatisticsCodec(),
+  new LoopStatisticsCodec(),
+  new JobStatisticsCodec(),
+  new LinkStatisticsCodec(),
+  new TraceChunkCodec(),
+  new PositionStreamCodec(),
   new FirmwareInfoCodec(),
   new KinematicsInfoCodec(),
   new TempSensorCodec(),
@@ -568,9 +1322,15 @@ export const customCodecs = [
   new TargetPositionCodec(),
   new SupervisorInfoCodec(),
   new InboundMotionCodec(),
+  compactMotionCodec,
+  movementBatchCodec,
   new InboundFadeCodec(),
+  fadeBatchCodec,
   new LEDCodec(),
   new HSVManualControl(),
   new RGBSettingsCodec(),
   new PowerCalibrationCodec(),
+  new InputShaperCodec(),
+  new ResonanceResultCodec(),
+  new ResonanceResponseCodec(),
 ]
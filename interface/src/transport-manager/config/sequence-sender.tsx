@@ -14,6 +14,14 @@ export type DeviceManagerChunkWriter = (
   chunk: any,
 ) => Promise<any>
 
+export type ChunkBatch = {
+  count: number // how many of the leading chunks went in
+  chunk: any // what to write
+  id?: any // names the write in the device's acknowledgements
+}
+
+export type ChunkBatcher = (chunks: Array<any>) => ChunkBatch
+
 export type IncomingQueueDepthMessageFilter = (
   deviceManager: DeviceManager,
   message: Message,
@@ -24,11 +32,43 @@ export type IncomingQueueDepthMessageTransform = (
   message: Message,
 ) => number
 
+export type IncomingQueueDepthMessageCallback = (
+  deviceManager: DeviceManager,
+  message: Message,
+) => void
+
 export type QueueDepthChangeCallback = (
   deviceManager: DeviceManager,
   depth: number,
 ) => void
 
+export type WriteAcknowledgement = {
+  accepted: any // id of the last write the device took in
+  seen: any // id of the last write that reached the device
+  received: number // running count of chunks that reached the device
+  lost: boolean // writes after the accepted one have to be sent again
+}
+
+export type IncomingAcknowledgementMessageTransform = (
+  deviceManager: DeviceManager,
+  message: Message,
+) => WriteAcknowledgement
+
+export type ResendCallback = (deviceManager: DeviceManager) => void
+
+type UnacknowledgedWrite = {
+  id: any
+  items: Array<any>
+}
+
+type WriteRecord = {
+  id: any
+  writtenAfter: number // the written count once this write went out
+}
+
+// Credit keeps fewer writes than this in flight, and ids are expected to wrap
+const UNACKNOWLEDGED_LIMIT = 128
+
 export interface SequenceSenderPluginOptions {
   /**
    * A function that writes a chunk to the device
@@ -36,9 +76,11 @@ export interface SequenceSenderPluginOptions {
   deviceManagerChunkWriter: DeviceManagerChunkWriter
 
   /**
-   * The statically defined maximum queue depth
+   * Forms one write from the leading chunks. Batches are formed in order, but
+   * their writes overlap, so anything that depends on the previous batch has
+   * to be settled here rather than in the chunk writer.
    */
-  maxQueueDepth: number
+  chunkBatcher?: ChunkBatcher
 
   /**
    * Returns if a message is the correct one to be transformed into our queue depth
@@ -50,6 +92,35 @@ export interface SequenceSenderPluginOptions {
    */
   incomingQueueDepthMessageTransform: IncomingQueueDepthMessageTransform
 
+  /**
+   * Transforms a message into the device's credit, the running count of
+   * chunks it has room for since the last reset
+   */
+  incomingCreditMessageTransform: IncomingQueueDepthMessageTransform
+
+  /**
+   * Called with each queue depth message, before any writes it allows
+   */
+  incomingQueueDepthMessageCallback?: IncomingQueueDepthMessageCallback
+
+  /**
+   * Reads which writes the device has taken in from a queue depth message.
+   * Batches with an id are kept until they're accepted, and sent again when
+   * the device reports losing any. The sent count is corrected from what
+   * reached the device, so writes lost on the way don't use up credit.
+   */
+  incomingAcknowledgementMessageTransform?: IncomingAcknowledgementMessageTransform
+
+  /**
+   * Called before lost writes are sent again, e.g. to restart a delta encoder
+   */
+  resendCallback?: ResendCallback
+
+  /**
+   * Asks the device for its queue depth, when there's no credit to write with
+   */
+  queueDepthRequester?: QueueDepthRequester
+
   /**
    * Do something with the device manager when the queue depth changes
    */
@@ -65,11 +136,21 @@ export type SubscribeCallback = (depth: number) => void
 
 export class SequenceSenderPlugin extends DeviceManagerProxyPlugin {
   queue: Array<any> = []
-  maxQueueDepth: number
+  unacknowledged: Array<UnacknowledgedWrite> = []
+  recentWrites: Array<WriteRecord> = []
   currentQueueDepth: number = 0
+  sent: number = 0 // running count of chunks written, wraps with the credit
+  written: number = 0 // same, but never corrected from the device's count
+  credit: number = 0
   deviceManagerChunkWriter: DeviceManagerChunkWriter
+  chunkBatcher?: ChunkBatcher
   incomingQueueDepthMessageFilter: IncomingQueueDepthMessageFilter
   incomingQueueDepthMessageTransform: IncomingQueueDepthMessageTransform
+  incomingCreditMessageTransform: IncomingQueueDepthMessageTransform
+  incomingQueueDepthMessageCallback?: IncomingQueueDepthMessageCallback
+  incomingAcknowledgementMessageTransform?: IncomingAcknowledgementMessageTransform
+  resendCallback?: ResendCallback
+  queueDepthRequester?: QueueDepthRequester
   queueDepthChangeCallback: QueueDepthChangeCallback
   paused: boolean = true
   name: string
@@ -81,10 +162,15 @@ export class SequenceSenderPlugin extends DeviceManagerProxyPlugin {
   constructor(options: SequenceSenderPluginOptions) {
     super()
 
-    this.maxQueueDepth = options.maxQueueDepth
     this.deviceManagerChunkWriter = options.deviceManagerChunkWriter
+    this.chunkBatcher = options.chunkBatcher
     this.incomingQueueDepthMessageFilter = options.incomingQueueDepthMessageFilter // prettier-ignore
     this.incomingQueueDepthMessageTransform = options.incomingQueueDepthMessageTransform // prettier-ignore
+    this.incomingCreditMessageTransform = options.incomingCreditMessageTransform // prettier-ignore
+    this.incomingQueueDepthMessageCallback = options.incomingQueueDepthMessageCallback // prettier-ignore
+    this.incomingAcknowledgementMessageTransform = options.incomingAcknowledgementMessageTransform // prettier-ignore
+    this.resendCallback = options.resendCallback
+    this.queueDepthRequester = options.queueDepthRequester
     this.queueDepthChangeCallback = options.queueDepthChangeCallback
 
     this.name = options.name || '?'
@@ -100,6 +186,28 @@ export class SequenceSenderPlugin extends DeviceManagerProxyPlugin {
       )
 
       this.currentQueueDepth = currentQueueDepth
+      this.credit = this.incomingCreditMessageTransform(
+        this.deviceManager!,
+        message,
+      )
+
+      if (this.incomingQueueDepthMessageCallback) {
+        this.incomingQueueDepthMessageCallback(this.deviceManager!, message)
+      }
+
+      if (this.incomingAcknowledgementMessageTransform) {
+        const acknowledgement = this.incomingAcknowledgementMessageTransform(
+          this.deviceManager!,
+          message,
+        )
+
+        this.acknowledge(acknowledgement.accepted)
+        this.resyncSent(acknowledgement.seen, acknowledgement.received)
+
+        if (acknowledgement.lost) {
+          this.resendUnacknowledged()
+        }
+      }
 
       this.writeSomethingIfWeCan()
     }
@@ -125,30 +233,131 @@ export class SequenceSenderPlugin extends DeviceManagerProxyPlugin {
   }
 
   /**
-   * Checks if we can write anything
+   * How many more chunks the device has granted room for
    */
-  private writeSomethingIfWeCan = async () => {
-    // If we have allowable queue depth and there's something in the queue, write it
-    if (
-      this.currentQueueDepth < this.maxQueueDepth &&
+  private availableCredit = () => {
+    // Both counts wrap at 16 bits, a credit behind what we've sent means none
+    return Math.max(0, (((this.credit - this.sent) & 0xffff) << 16) >> 16)
+  }
+
+  /**
+   * Writes as much as the device has granted room for. Writes aren't waited
+   * on, so the link stays busy while earlier chunks are acknowledged.
+   */
+  private writeSomethingIfWeCan = () => {
+    while (
+      this.availableCredit() > 0 &&
       this.queue.length > 0 &&
       !this.paused
     ) {
-      const item = this.queue.shift()
+      // Batches fill the granted space
+      const space = this.availableCredit()
+      const batch = this.chunkBatcher
+        ? this.chunkBatcher(this.queue.slice(0, space))
+        : { count: 1, chunk: this.queue[0] }
+
+      const items = this.queue.splice(0, Math.max(1, batch.count))
+
+      this.sent = (this.sent + items.length) & 0xffff
+      this.written = (this.written + items.length) & 0xffff
+
+      if (typeof batch.id !== 'undefined') {
+        this.unacknowledged.push({ id: batch.id, items })
+        this.recentWrites.push({ id: batch.id, writtenAfter: this.written })
+
+        if (this.unacknowledged.length > UNACKNOWLEDGED_LIMIT) {
+          this.unacknowledged.shift()
+        }
+
+        if (this.recentWrites.length > UNACKNOWLEDGED_LIMIT) {
+          this.recentWrites.shift()
+        }
+      }
 
       // optimistically increase the queue depth, it'll get reset quickly
-      this.currentQueueDepth += 1
+      this.currentQueueDepth += items.length
 
       // tell the UI how much is left in _our_ queue
       this.setQueueRemaining(this.queue.length)
 
       this.debug(
-        `Writing item, UI queue length: ${this.queue.length}, HW queue depth: ${this.currentQueueDepth}`,
+        `Writing ${items.length} items, UI queue length: ${this.queue.length}, HW queue depth: ${this.currentQueueDepth}, credit: ${this.availableCredit()}`,
       )
 
-      await this.deviceManagerChunkWriter(this.deviceManager!, item)
+      this.deviceManagerChunkWriter(
+        this.deviceManager!,
+        batch.chunk,
+      ).catch(err => {
+        console.warn(
+          'The sequence sender for',
+          this.name,
+          'failed a write',
+          err,
+        )
+      })
+    }
+  }
+
+  /**
+   * Forget the writes up to and including the accepted one, the device takes
+   * them in order
+   */
+  private acknowledge = (accepted: any) => {
+    const index = this.unacknowledged.findIndex(write => write.id === accepted)
+
+    if (index !== -1) {
+      this.unacknowledged.splice(0, index + 1)
+    }
+  }
 
-      this.writeSomethingIfWeCan()
+  /**
+   * The device only counts the chunks that reach it. Everything written
+   * after the last write it saw is still on the way, anything before that it
+   * didn't count was lost, and is taken back out of the sent count.
+   *
+   * Writes are placed with the uncorrected count, and kept through resends,
+   * as reports about them can still arrive after the batches are requeued.
+   */
+  private resyncSent = (seen: any, received: number) => {
+    let write: WriteRecord | undefined
+
+    // Ids wrap, the newest write with the id is the one the device means
+    for (let i = this.recentWrites.length - 1; i >= 0; i--) {
+      if (this.recentWrites[i].id === seen) {
+        write = this.recentWrites[i]
+        break
+      }
+    }
+
+    // Reports about writes from before a reset can't be placed
+    if (!write) {
+      return
+    }
+
+    const inFlight = (this.written - write.writtenAfter) & 0xffff
+
+    this.sent = (received + inFlight) & 0xffff
+  }
+
+  /**
+   * Put the writes the device lost back at the front of the queue. Writes
+   * without an id aren't kept, so they aren't sent again.
+   */
+  private resendUnacknowledged = () => {
+    const items = ([] as Array<any>).concat(
+      ...this.unacknowledged.map(write => write.items),
+    )
+
+    this.unacknowledged = []
+
+    if (items.length > 0) {
+      this.debug(`Resending ${items.length} items the device lost`)
+      this.queue.unshift(...items)
+      this.setQueueRemaining(this.queue.length)
+    }
+
+    if (this.resendCallback) {
+      this.resendCallback(this.deviceManager!)
     }
   }
 
@@ -187,10 +396,28 @@ export class SequenceSenderPlugin extends DeviceManagerProxyPlugin {
   public setPaused = (paused: boolean) => {
     this.paused = paused
     if (!paused) {
+      // Nothing more can be written until the device grants credit, so ask
+      if (this.availableCredit() === 0 && this.queueDepthRequester) {
+        this.queueDepthRequester(this.deviceManager!).catch(err => {
+          console.warn('No credit for the sequence sender', this.name, err)
+        })
+      }
+
       this.writeSomethingIfWeCan()
     }
   }
 
+  /**
+   * Start the credit count again, the device does the same when its queues
+   * are cleared. Nothing is written until it grants new credit.
+   */
+  public resetCredit = () => {
+    this.sent = 0
+    this.credit = 0
+    this.unacknowledged = []
+    this.recentWrites = []
+  }
+
   /**
    * Clear the queue
    */
@@ -198,6 +425,8 @@ export class SequenceSenderPlugin extends DeviceManagerProxyPlugin {
     console.log('The sequence sender for', this.name, 'has cleared')
 
     this.queue = []
+    this.unacknowledged = []
+    this.recentWrites = []
 
     // Tell the UI the queue has been cleared
     this.setQueueRemaining(this.queue.length)
@@ -8,18 +8,38 @@ import {
 import { DeviceManagerProxyPlugin } from '@electricui/components-core'
 import { SequenceSenderPlugin } from './sequence-sender'
 import { getDelta } from './actions/utils'
+import {
+  compactMotionCodec,
+  movementBatchCodec,
+  fadeBatchCodec,
+} from './codecs'
 
 export const movementQueueSequencer = new SequenceSenderPlugin({
-  maxQueueDepth: 75,
   name: 'mv',
+  chunkBatcher: chunks => {
+    // The compact format doesn't carry the expansion axis
+    if (chunks[0].rotary) {
+      return { count: 1, chunk: chunks[0] }
+    }
+
+    const batch = movementBatchCodec.formBatch(chunks)
+
+    return {
+      count: batch.moves.length,
+      chunk: batch,
+      id: compactMotionCodec.lastSequence(),
+    }
+  },
   deviceManagerChunkWriter: async (
     deviceManager: DeviceManager,
     chunk: any,
   ) => {
-    // chunk is a momement
+    // chunk is an encoded batch, or a single move for the expansion axis
     const delta = getDelta(deviceManager)
 
-    const message = new Message('inmv', chunk)
+    const message = chunk.rotary
+      ? new Message('inmv', chunk)
+      : new Message('mvb', chunk)
     message.metadata.ack = true
 
     return delta.write(message)
@@ -44,6 +64,42 @@ export const movementQueueSequencer = new SequenceSenderPlugin({
   ) => {
     return message.payload.movements
   },
+  incomingCreditMessageTransform: (
+    deviceManager: DeviceManager,
+    message: Message,
+  ) => {
+    return message.payload.movement_credit
+  },
+  incomingAcknowledgementMessageTransform: (
+    deviceManager: DeviceManager,
+    message: Message,
+  ) => {
+    const {
+      motion_synced,
+      motion_accepted,
+      motion_seen,
+      motion_received,
+    } = message.payload
+
+    return {
+      accepted: motion_accepted,
+      seen: motion_seen,
+      received: motion_received,
+      lost: compactMotionCodec.lostSync(motion_synced, motion_seen),
+    }
+  },
+  resendCallback: (deviceManager: DeviceManager) => {
+    // The hardware lost its place in the move stream, start it again
+    compactMotionCodec.reset()
+  },
+  queueDepthRequester: async (deviceManager: DeviceManager) => {
+    const delta = getDelta(deviceManager)
+
+    const request = new Message('queue', null)
+    request.metadata.query = true
+
+    return delta.write(request)
+  },
   queueDepthChangeCallback: (deviceManager: DeviceManager, depth: number) => {
     const delta = getDelta(deviceManager)
 
@@ -54,16 +110,20 @@ export const movementQueueSequencer = new SequenceSenderPlugin({
 })
 
 export const lightQueueSequencer = new SequenceSenderPlugin({
-  maxQueueDepth: 125,
   name: 'li',
+  chunkBatcher: chunks => {
+    const count = Math.max(1, fadeBatchCodec.countFades(chunks))
+
+    return { count, chunk: chunks.slice(0, count) }
+  },
   deviceManagerChunkWriter: async (
     deviceManager: DeviceManager,
-    chunk: any,
+    chunks: any,
   ) => {
-    // chunk is a light move
+    // chunks is an array of light moves
     const delta = getDelta(deviceManager)
 
-    const message = new Message('inlt', chunk)
+    const message = new Message('ltb', chunks)
     message.metadata.ack = true
 
     return delta.write(message)
@@ -88,6 +148,20 @@ export const lightQueueSequencer = new SequenceSenderPlugin({
   ) => {
     return message.payload.lighting
   },
+  incomingCreditMessageTransform: (
+    deviceManager: DeviceManager,
+    message: Message,
+  ) => {
+    return message.payload.lighting_credit
+  },
+  queueDepthRequester: async (deviceManager: DeviceManager) => {
+    const delta = getDelta(deviceManager)
+
+    const request = new Message('queue', null)
+    request.metadata.query = true
+
+    return delta.write(request)
+  },
   queueDepthChangeCallback: (deviceManager: DeviceManager, depth: number) => {
     const delta = getDelta(deviceManager)
 
@@ -0,0 +1,223 @@
+import 'mocha'
+
+import * as chai from 'chai'
+
+import { SequenceSenderPlugin } from '../src/transport-manager/config/sequence-sender'
+
+const assert = chai.assert
+
+// Same as the firmware's MOVEMENT_CREDIT_WINDOW
+const CREDIT_WINDOW = 120
+const MOVES_PER_BATCH = 4
+
+type Packet = {
+  id: number
+  reset: boolean
+  items: Array<number>
+}
+
+/**
+ * The hardware's side of the move stream, as user_interface.c and
+ * movement_codec.c keep it. Packets that arrive are counted whether or not
+ * their moves can be used, packets lost on the way aren't.
+ */
+class FakeHardware {
+  received = 0
+  depth = 0
+  synced = false
+  expected = 0
+  accepted = 0
+  seen = 0
+  queued: Array<number> = []
+
+  receive(packet: Packet) {
+    const behind = (this.expected - packet.id) & 0xff
+    const duplicate =
+      !packet.reset && this.synced && behind > 0 && behind < 0x80
+
+    if (duplicate) {
+      return
+    }
+
+    this.received = (this.received + packet.items.length) & 0xffff
+    this.seen = packet.id
+
+    if (packet.reset) {
+      this.synced = true
+    } else if (packet.id !== this.expected) {
+      this.synced = false
+    }
+
+    if (this.synced) {
+      this.expected = (packet.id % 255) + 1
+      this.accepted = packet.id
+      this.depth += packet.items.length
+      this.queued.push(...packet.items)
+    }
+  }
+
+  runMove() {
+    this.depth = Math.max(0, this.depth - 1)
+  }
+
+  report() {
+    return {
+      movements: this.depth,
+      movement_credit:
+        (this.received + CREDIT_WINDOW - Math.min(this.depth, CREDIT_WINDOW)) &
+        0xffff,
+      motion_received: this.received,
+      motion_synced: this.synced,
+      motion_accepted: this.accepted,
+      motion_seen: this.seen,
+    }
+  }
+}
+
+/**
+ * A move sender the way sequence-senders.tsx sets it up, with the codec's
+ * sequence numbers and resets reduced to what the credit depends on.
+ */
+function createSender(link: Array<Packet>) {
+  let sequence = 0
+  let needsReset = true
+  let unseenReset: number | null = null
+
+  const sender = new SequenceSenderPlugin({
+    name: 'test',
+    chunkBatcher: chunks => {
+      const count = Math.min(MOVES_PER_BATCH, chunks.length)
+
+      sequence = (sequence % 255) + 1
+
+      const reset = needsReset
+      if (reset) {
+        needsReset = false
+        unseenReset = sequence
+      }
+
+      return {
+        count,
+        chunk: { id: sequence, reset, items: chunks.slice(0, count) },
+        id: sequence,
+      }
+    },
+    deviceManagerChunkWriter: async (deviceManager: any, chunk: Packet) => {
+      link.push(chunk)
+    },
+    incomingQueueDepthMessageFilter: () => true,
+    incomingQueueDepthMessageTransform: (deviceManager, message) =>
+      message.payload.movements,
+    incomingCreditMessageTransform: (deviceManager, message) =>
+      message.payload.movement_credit,
+    incomingAcknowledgementMessageTransform: (deviceManager, message) => {
+      const { payload } = message
+
+      // Reports from before the last reset reached the hardware are out of date
+      if (unseenReset !== null) {
+        const behind = (unseenReset - payload.motion_seen) & 0xff
+
+        if (behind > 0 && behind < 0x80) {
+          return {
+            accepted: payload.motion_accepted,
+            seen: payload.motion_seen,
+            received: payload.motion_received,
+            lost: false,
+          }
+        }
+
+        unseenReset = null
+      }
+
+      return {
+        accepted: payload.motion_accepted,
+        seen: payload.motion_seen,
+        received: payload.motion_received,
+        lost: !payload.motion_synced && !needsReset,
+      }
+    },
+    resendCallback: () => {
+      needsReset = true
+    },
+    queueDepthChangeCallback: () => {},
+  })
+
+  return sender
+}
+
+/**
+ * Stream moves through a link which loses some packets, with the hardware
+ * running a move every few steps and reporting its queue after each one.
+ */
+function stream(numMoves: number, isLost: (packetIndex: number) => boolean) {
+  const link: Array<Packet> = []
+  const hardware = new FakeHardware()
+  const sender = createSender(link)
+
+  const report = () =>
+    sender.onMessage(null as any, { payload: hardware.report() } as any)
+
+  // Queued up front, so batches are full and fewer than half the sequence
+  // numbers are in flight at once
+  for (let i = 0; i < numMoves; i++) {
+    sender.queueItem(i)
+  }
+
+  sender.setPaused(false)
+  report()
+
+  let packetIndex = 0
+
+  for (let step = 0; step < numMoves * 20; step++) {
+    const packet = link.shift()
+
+    if (packet && !isLost(packetIndex++)) {
+      hardware.receive(packet)
+    }
+
+    if (step % 3 === 0) {
+      hardware.runMove()
+    }
+
+    report()
+
+    if (hardware.queued.length === numMoves && hardware.depth === 0) {
+      break
+    }
+  }
+
+  // Let the last of the moves run, and the final report go out
+  while (hardware.depth > 0) {
+    hardware.runMove()
+  }
+  report()
+
+  return { sender, hardware }
+}
+
+describe('Sequence sender credit', () => {
+  it('streams every move once, in order, over a clean link', () => {
+    const { sender, hardware } = stream(1000, () => false)
+
+    assert.deepEqual(hardware.queued, [...Array(1000).keys()])
+    assert.equal(sender.sent, hardware.received)
+  })
+
+  it('gets the whole window back after packets are lost', () => {
+    // Enough losses to use up the window several times over if they were kept.
+    // A lost packet is only noticed when a later one arrives, so the tail of
+    // the stream gets through.
+    const { sender, hardware } = stream(
+      2000,
+      index => index < 400 && index % 7 === 3,
+    )
+
+    assert.deepEqual(hardware.queued, [...Array(2000).keys()])
+    assert.equal(sender.sent, hardware.received)
+    assert.equal(
+      (sender.credit - sender.sent) & 0xffff,
+      CREDIT_WINDOW,
+      'credit the hardware granted, less what the host thinks is in flight',
+    )
+  })
+})